@@ -0,0 +1,431 @@
+#include "art.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Adaptivt radixträd (ART) över 32-bitars nycklar, en byte per nivå med mest signifikanta först
+// så att trädordning blir nyckelordning. Noderna finns i fyra storlekar (4, 16, 48, 256 barn)
+// och byts mot nästa storlek när de blir fulla - glesa nivåer tar lite minne, täta blir direktindexerade.
+// Gemensamma bytes lagras som prefix i noden (path compression) och en ensam nyckel under en
+// gren lagras direkt som löv (lazy expansion), så trädet blir sällan fyra nivåer djupt.
+// Alla noder och löv allokeras ur minnespoolen. Ingen intern låsning.
+
+#define ART_KEY_BYTES 4
+#define ART_ALIGN 8
+
+typedef enum { ART_NODE4, ART_NODE16, ART_NODE48, ART_NODE256 } ArtType;
+
+typedef struct {
+    uint8_t type;
+    uint8_t prefix_len;             // Antal komprimerade bytes före nodens egen byte
+    uint8_t prefix[ART_KEY_BYTES - 1];
+    uint16_t count;                 // Antal barn (256 ryms inte i en byte)
+} ArtNode;
+
+typedef struct {
+    ArtNode header;
+    uint8_t keys[4];                // Sorterade
+    void* children[4];
+} ArtNode4;
+
+typedef struct {
+    ArtNode header;
+    uint8_t keys[16];               // Sorterade, söks med SSE2
+    void* children[16];
+} ArtNode16;
+
+typedef struct {
+    ArtNode header;
+    uint8_t index[256];             // 0 = inget barn, annars plats + 1 i children
+    void* children[48];
+} ArtNode48;
+
+typedef struct {
+    ArtNode header;
+    void* children[256];
+} ArtNode256;
+
+typedef struct {
+    uint32_t key;
+    uint32_t value;
+} ArtLeaf;
+
+struct ArtTree {
+    void* root;
+    size_t size;
+};
+
+// Löv märks med lägsta biten i pekaren - noder och löv allokeras därför alignade
+#define ART_IS_LEAF(p) (((uintptr_t)(p)) & 1)
+#define ART_LEAF(p) ((ArtLeaf*)((uintptr_t)(p) & ~(uintptr_t)1))
+#define ART_TAG_LEAF(p) ((void*)((uintptr_t)(p) | 1))
+
+static inline uint8_t art_byte(uint32_t key, unsigned depth) {
+    return (uint8_t)(key >> (8 * (ART_KEY_BYTES - 1 - depth)));
+}
+
+static ArtNode* art_alloc_node(ArtType type) {
+    static const size_t sizes[] = {sizeof(ArtNode4), sizeof(ArtNode16), sizeof(ArtNode48), sizeof(ArtNode256)};
+    ArtNode* node = (ArtNode*)mem_alloc_aligned(sizes[type], ART_ALIGN);
+    if (!node) {
+        fprintf(stderr, "Error: Could not allocate ART node from memory pool\n");
+        return NULL;
+    }
+    memset(node, 0, sizes[type]);
+    node->type = type;
+    return node;
+}
+
+static void* art_alloc_leaf(uint32_t key, uint32_t value) {
+    ArtLeaf* leaf = (ArtLeaf*)mem_alloc_aligned(sizeof(ArtLeaf), ART_ALIGN);
+    if (!leaf) {
+        fprintf(stderr, "Error: Could not allocate ART leaf from memory pool\n");
+        return NULL;
+    }
+    leaf->key = key;
+    leaf->value = value;
+    return ART_TAG_LEAF(leaf);
+}
+
+// Position för byte i en Node16, eller -1
+static inline int art_find16(ArtNode16* node, uint8_t byte) {
+#ifdef __SSE2__
+    __m128i keys = _mm_loadu_si128((const __m128i*)node->keys);
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8((char)byte)));
+    mask &= (1u << node->header.count) - 1; // Bara använda platser
+    return mask ? __builtin_ctz(mask) : -1;
+#else
+    for (int i = 0; i < node->header.count; i++)
+        if (node->keys[i] == byte) return i;
+    return -1;
+#endif
+}
+
+// Pekare till barnpekaren för byte, NULL om barnet saknas
+static void** art_find_child(ArtNode* node, uint8_t byte) {
+    switch (node->type) {
+    case ART_NODE4: {
+        ArtNode4* n = (ArtNode4*)node;
+        for (int i = 0; i < node->count; i++)
+            if (n->keys[i] == byte) return &n->children[i];
+        return NULL;
+    }
+    case ART_NODE16: {
+        ArtNode16* n = (ArtNode16*)node;
+        int i = art_find16(n, byte);
+        return i >= 0 ? &n->children[i] : NULL;
+    }
+    case ART_NODE48: {
+        ArtNode48* n = (ArtNode48*)node;
+        return n->index[byte] ? &n->children[n->index[byte] - 1] : NULL;
+    }
+    default: {
+        ArtNode256* n = (ArtNode256*)node;
+        return n->children[byte] ? &n->children[byte] : NULL;
+    }
+    }
+}
+
+// Sorterad insättning i Node4/Node16 - nycklar och barn har samma layout i båda
+static void art_insert_sorted(uint8_t* keys, void** children, uint16_t count, uint8_t byte, void* child) {
+    int pos = 0;
+    while (pos < count && keys[pos] < byte) pos++;
+    memmove(keys + pos + 1, keys + pos, count - pos);
+    memmove(children + pos + 1, children + pos, (count - pos) * sizeof(void*));
+    keys[pos] = byte;
+    children[pos] = child;
+}
+
+// Byter noden mot nästa storlek med samma barn och prefix
+static ArtNode* art_grow(ArtNode* node) {
+    ArtNode* bigger = art_alloc_node((ArtType)(node->type + 1));
+    if (!bigger) return NULL;
+    bigger->prefix_len = node->prefix_len;
+    memcpy(bigger->prefix, node->prefix, sizeof(node->prefix));
+    bigger->count = node->count;
+
+    switch (node->type) {
+    case ART_NODE4: {
+        ArtNode4* from = (ArtNode4*)node;
+        ArtNode16* to = (ArtNode16*)bigger;
+        memcpy(to->keys, from->keys, node->count);
+        memcpy(to->children, from->children, node->count * sizeof(void*));
+        break;
+    }
+    case ART_NODE16: {
+        ArtNode16* from = (ArtNode16*)node;
+        ArtNode48* to = (ArtNode48*)bigger;
+        for (int i = 0; i < node->count; i++) {
+            to->index[from->keys[i]] = (uint8_t)(i + 1);
+            to->children[i] = from->children[i];
+        }
+        break;
+    }
+    default: {
+        ArtNode48* from = (ArtNode48*)node;
+        ArtNode256* to = (ArtNode256*)bigger;
+        for (int b = 0; b < 256; b++)
+            if (from->index[b]) to->children[b] = from->children[from->index[b] - 1];
+        break;
+    }
+    }
+    mem_free(node);
+    return bigger;
+}
+
+// Lägger till ett barn, växer noden vid behov och uppdaterar *ref
+static int art_add_child(void** ref, uint8_t byte, void* child) {
+    ArtNode* node = (ArtNode*)*ref;
+    static const uint16_t limits[] = {4, 16, 48, 256};
+    if (node->count == limits[node->type]) {
+        ArtNode* bigger = art_grow(node);
+        if (!bigger) return -1;
+        *ref = node = bigger;
+    }
+
+    switch (node->type) {
+    case ART_NODE4:
+        art_insert_sorted(((ArtNode4*)node)->keys, ((ArtNode4*)node)->children, node->count, byte, child);
+        break;
+    case ART_NODE16:
+        art_insert_sorted(((ArtNode16*)node)->keys, ((ArtNode16*)node)->children, node->count, byte, child);
+        break;
+    case ART_NODE48: {
+        ArtNode48* n = (ArtNode48*)node;
+        n->children[node->count] = child; // Barn tas aldrig bort, så platserna fylls i ordning
+        n->index[byte] = (uint8_t)(node->count + 1);
+        break;
+    }
+    default:
+        ((ArtNode256*)node)->children[byte] = child;
+        break;
+    }
+    node->count++;
+    return 0;
+}
+
+ArtTree* art_create(void) {
+    ArtTree* tree = (ArtTree*)malloc(sizeof(ArtTree));
+    if (!tree) {
+        fprintf(stderr, "Error: Memory allocation failed in art_create.\n");
+        return NULL;
+    }
+    tree->root = NULL;
+    tree->size = 0;
+    return tree;
+}
+
+// Lägger in eller uppdaterar nyckeln, returnerar 0 eller -1 om poolen är full
+int art_insert(ArtTree* tree, uint32_t key, uint32_t value) {
+    void** ref = &tree->root;
+    unsigned depth = 0;
+
+    for (;;) {
+        void* current = *ref;
+
+        // Fall 1: Tom plats - lägg lövet direkt här
+        if (!current) {
+            void* leaf = art_alloc_leaf(key, value);
+            if (!leaf) return -1;
+            *ref = leaf;
+            tree->size++;
+            return 0;
+        }
+
+        // Fall 2: Löv - uppdatera, eller ersätt med en Node4 som skiljer de två nycklarna
+        if (ART_IS_LEAF(current)) {
+            ArtLeaf* existing = ART_LEAF(current);
+            if (existing->key == key) {
+                existing->value = value;
+                return 0;
+            }
+            unsigned common = 0;
+            while (art_byte(existing->key, depth + common) == art_byte(key, depth + common)) common++;
+
+            ArtNode* node = art_alloc_node(ART_NODE4);
+            void* leaf = node ? art_alloc_leaf(key, value) : NULL;
+            if (!leaf) {
+                if (node) mem_free(node);
+                return -1;
+            }
+            node->prefix_len = (uint8_t)common;
+            for (unsigned i = 0; i < common; i++) node->prefix[i] = art_byte(key, depth + i);
+            void* as_node = node;
+            art_add_child(&as_node, art_byte(existing->key, depth + common), current);
+            art_add_child(&as_node, art_byte(key, depth + common), leaf);
+            *ref = node;
+            tree->size++;
+            return 0;
+        }
+
+        // Fall 3: Prefixet skiljer sig - dela med en ny Node4 ovanför
+        ArtNode* node = (ArtNode*)current;
+        unsigned mismatch = 0;
+        while (mismatch < node->prefix_len && node->prefix[mismatch] == art_byte(key, depth + mismatch)) mismatch++;
+        if (mismatch < node->prefix_len) {
+            ArtNode* parent = art_alloc_node(ART_NODE4);
+            void* leaf = parent ? art_alloc_leaf(key, value) : NULL;
+            if (!leaf) {
+                if (parent) mem_free(parent);
+                return -1;
+            }
+            parent->prefix_len = (uint8_t)mismatch;
+            memcpy(parent->prefix, node->prefix, mismatch);
+            uint8_t node_byte = node->prefix[mismatch];
+            node->prefix_len -= mismatch + 1;
+            memmove(node->prefix, node->prefix + mismatch + 1, node->prefix_len);
+
+            void* as_node = parent;
+            art_add_child(&as_node, node_byte, node);
+            art_add_child(&as_node, art_byte(key, depth + mismatch), leaf);
+            *ref = parent;
+            tree->size++;
+            return 0;
+        }
+        depth += node->prefix_len;
+
+        // Fall 4: Gå vidare till barnet, eller lägg till ett nytt löv som barn
+        uint8_t byte = art_byte(key, depth);
+        void** child = art_find_child(node, byte);
+        if (child) {
+            ref = child;
+            depth++;
+            continue;
+        }
+        void* leaf = art_alloc_leaf(key, value);
+        if (!leaf) return -1;
+        if (art_add_child(ref, byte, leaf) != 0) {
+            mem_free(ART_LEAF(leaf));
+            return -1;
+        }
+        tree->size++;
+        return 0;
+    }
+}
+
+// Returnerar 1 och värdet om nyckeln finns, annars 0
+int art_get(ArtTree* tree, uint32_t key, uint32_t* value) {
+    void* current = tree->root;
+    unsigned depth = 0;
+    while (current && !ART_IS_LEAF(current)) {
+        ArtNode* node = (ArtNode*)current;
+        // Prefixet behöver inte jämföras på vägen ner - lövet har hela nyckeln
+        depth += node->prefix_len;
+        void** child = art_find_child(node, art_byte(key, depth));
+        current = child ? *child : NULL;
+        depth++;
+    }
+    if (!current || ART_LEAF(current)->key != key) return 0;
+    if (value) *value = ART_LEAF(current)->value;
+    return 1;
+}
+
+typedef struct {
+    uint32_t low;
+    uint32_t high;
+    art_visit_fn visit;
+    void* ctx;
+    size_t visited;
+    int stopped;
+} ArtRange;
+
+// Besöker delträdet i nyckelordning. path håller bytes ovanför depth.
+// Delträd vars möjliga nyckelintervall ligger utanför [low, high] hoppas över
+static void art_range_rec(void* current, unsigned depth, uint32_t path, ArtRange* range) {
+    if (range->stopped) return;
+    if (ART_IS_LEAF(current)) {
+        ArtLeaf* leaf = ART_LEAF(current);
+        if (leaf->key < range->low || leaf->key > range->high) return;
+        range->visited++;
+        if (range->visit && range->visit(leaf->key, leaf->value, range->ctx) != 0) range->stopped = 1;
+        return;
+    }
+
+    ArtNode* node = (ArtNode*)current;
+    for (unsigned i = 0; i < node->prefix_len; i++)
+        path |= (uint32_t)node->prefix[i] << (8 * (ART_KEY_BYTES - 1 - depth - i));
+    depth += node->prefix_len;
+
+    // Alla nycklar under noden delar de depth första bytes i path
+    uint32_t free_bits = depth ? 0xffffffffu >> (8 * depth) : 0xffffffffu;
+    if ((path | free_bits) < range->low || path > range->high) return;
+
+    unsigned shift = 8 * (ART_KEY_BYTES - 1 - depth);
+    switch (node->type) {
+    case ART_NODE4:
+    case ART_NODE16: {
+        uint8_t* keys = node->type == ART_NODE4 ? ((ArtNode4*)node)->keys : ((ArtNode16*)node)->keys;
+        void** children = node->type == ART_NODE4 ? ((ArtNode4*)node)->children : ((ArtNode16*)node)->children;
+        for (int i = 0; i < node->count; i++)
+            art_range_rec(children[i], depth + 1, path | (uint32_t)keys[i] << shift, range);
+        break;
+    }
+    case ART_NODE48: {
+        ArtNode48* n = (ArtNode48*)node;
+        for (int b = 0; b < 256; b++)
+            if (n->index[b]) art_range_rec(n->children[n->index[b] - 1], depth + 1, path | (uint32_t)b << shift, range);
+        break;
+    }
+    default: {
+        ArtNode256* n = (ArtNode256*)node;
+        for (int b = 0; b < 256; b++)
+            if (n->children[b]) art_range_rec(n->children[b], depth + 1, path | (uint32_t)b << shift, range);
+        break;
+    }
+    }
+}
+
+// Besöker alla par med low <= key <= high i ordning
+// visit kan avbryta genom att returnera något annat än 0, returnerar antal besökta par
+size_t art_range(ArtTree* tree, uint32_t low, uint32_t high, art_visit_fn visit, void* ctx) {
+    ArtRange range = {.low = low, .high = high, .visit = visit, .ctx = ctx, .visited = 0, .stopped = 0};
+    if (tree->root && low <= high) art_range_rec(tree->root, 0, 0, &range);
+    return range.visited;
+}
+
+// Besöker alla nycklar vars prefix_bits högsta bitar är lika med prefix
+size_t art_prefix(ArtTree* tree, uint32_t prefix, unsigned prefix_bits, art_visit_fn visit, void* ctx) {
+    if (prefix_bits > 32) prefix_bits = 32;
+    uint32_t free_bits = prefix_bits ? (prefix_bits == 32 ? 0 : 0xffffffffu >> prefix_bits) : 0xffffffffu;
+    return art_range(tree, prefix & ~free_bits, prefix | free_bits, visit, ctx);
+}
+
+size_t art_size(ArtTree* tree) {
+    return tree->size;
+}
+
+static void art_free_rec(void* current) {
+    if (ART_IS_LEAF(current)) {
+        mem_free(ART_LEAF(current));
+        return;
+    }
+    ArtNode* node = (ArtNode*)current;
+    switch (node->type) {
+    case ART_NODE4:
+        for (int i = 0; i < node->count; i++) art_free_rec(((ArtNode4*)node)->children[i]);
+        break;
+    case ART_NODE16:
+        for (int i = 0; i < node->count; i++) art_free_rec(((ArtNode16*)node)->children[i]);
+        break;
+    case ART_NODE48:
+        for (int i = 0; i < node->count; i++) art_free_rec(((ArtNode48*)node)->children[i]);
+        break;
+    default:
+        for (int b = 0; b < 256; b++)
+            if (((ArtNode256*)node)->children[b]) art_free_rec(((ArtNode256*)node)->children[b]);
+        break;
+    }
+    mem_free(node);
+}
+
+// Lämnar tillbaka alla noder och löv till minnespoolen
+void art_destroy(ArtTree* tree) {
+    if (!tree) return;
+    if (tree->root) art_free_rec(tree->root);
+    free(tree);
+}
@@ -0,0 +1,25 @@
+#ifndef ART_H
+#define ART_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct ArtTree ArtTree;
+
+typedef int (*art_visit_fn)(uint32_t key, uint32_t value, void* ctx);
+
+ArtTree* art_create(void);
+
+int art_insert(ArtTree* tree, uint32_t key, uint32_t value);
+
+int art_get(ArtTree* tree, uint32_t key, uint32_t* value);
+
+size_t art_range(ArtTree* tree, uint32_t low, uint32_t high, art_visit_fn visit, void* ctx);
+
+size_t art_prefix(ArtTree* tree, uint32_t prefix, unsigned prefix_bits, art_visit_fn visit, void* ctx);
+
+size_t art_size(ArtTree* tree);
+
+void art_destroy(ArtTree* tree);
+
+#endif
@@ -0,0 +1,362 @@
+#include "async_exec.h"
+#include "spsc_ring.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+// Asynkron front för listan och minnespoolen: varje inskickande tråd har en egen SPSC-ring
+// till en dedikerad exekutortråd, så inskickning är låsfri och blockerar aldrig på list_mutex.
+// Exekutorn tömmer ringarna i batchar, kör på varandra följande listoperationer med ett enda
+// list_apply_batch_owned och meddelar resultatet via callback (körs i exekutortråden) och/eller
+// en future som kan pollas.
+// Bara exekutorn ändrar listan den äger - övriga trådar ska gå via list_submit, så exekutorn
+// behöver inte list_mutex
+// När en inskickande tråd avslutas lämnas dess ringar tillbaka och återanvänds av nya trådar
+
+#define ASYNC_MAX_SUBMITTERS 256 // Samtidigt levande inskickande trådar per exekutor
+#define ASYNC_BATCH 64
+#define ASYNC_LOCAL_SLOTS 8 // Exekutorer en tråd kan skicka till samtidigt
+#define ASYNC_SPIN_ROUNDS 256
+
+typedef enum { ASYNC_LIST, ASYNC_ALLOC, ASYNC_FREE } AsyncKind;
+
+// ACTIVE: en levande tråd skickar via ringen, ABANDONED: tråden har avslutats och exekutorn
+// tömmer det som är kvar, FREE: tom och ledig att ta över
+typedef enum { ASYNC_RING_ACTIVE, ASYNC_RING_ABANDONED, ASYNC_RING_FREE } AsyncRingState;
+
+typedef struct {
+    AsyncKind kind;
+    ListOp op;
+    size_t size;
+    void* ptr;
+    async_callback callback;
+    void* ctx;
+    AsyncFuture* future;
+} AsyncRequest;
+
+struct AsyncExecutor {
+    Node** head;
+    size_t queue_capacity;
+    unsigned long long id;          // Unikt per exekutor, återanvänds aldrig även om adressen gör det
+    struct AsyncExecutor* next;     // I listan över levande exekutorer
+    SpscRing* rings[ASYNC_MAX_SUBMITTERS];
+    atomic_int ring_state[ASYNC_MAX_SUBMITTERS];
+    atomic_size_t num_rings;        // Publiceras med release efter att ringen lagts in
+    pthread_mutex_t register_lock;  // Tas en gång per tråd vid registrering
+    atomic_int shutdown;
+    atomic_int sleeping;            // 1 när exekutorn funnit alla ringar tomma och ska sova
+    pthread_mutex_t wake_lock;
+    pthread_cond_t wake_cond;
+    pthread_t thread;
+};
+
+typedef struct {
+    unsigned long long id; // 0 = ledig plats
+    SpscRing* ring;
+    int index;             // Ringens plats i exekutorns rings
+} AsyncLocal;
+
+static _Thread_local AsyncLocal async_local[ASYNC_LOCAL_SLOTS];
+
+// Levande exekutorer - trådarnas platser pekar ut exekutorn via id, så en avslutande tråd
+// eller en registrering kan se om exekutorn bakom en plats fortfarande finns
+static pthread_mutex_t executors_lock = PTHREAD_MUTEX_INITIALIZER;
+static AsyncExecutor* executors = NULL;
+static unsigned long long next_executor_id = 1;
+
+static pthread_key_t async_key;
+static pthread_once_t async_key_once = PTHREAD_ONCE_INIT;
+
+// Levande exekutor med id eller NULL, executors_lock måste vara tagen
+static AsyncExecutor* async_find(unsigned long long id) {
+    for (AsyncExecutor* executor = executors; executor; executor = executor->next)
+        if (executor->id == id) return executor;
+    return NULL;
+}
+
+// Väcker exekutorn om den sover
+static void async_wake(AsyncExecutor* executor) {
+    atomic_thread_fence(memory_order_seq_cst); // Ordnar inskickningen före läsningen av sleeping
+    if (!atomic_load_explicit(&executor->sleeping, memory_order_relaxed)) return;
+    pthread_mutex_lock(&executor->wake_lock);
+    atomic_store_explicit(&executor->sleeping, 0, memory_order_relaxed);
+    pthread_cond_signal(&executor->wake_cond);
+    pthread_mutex_unlock(&executor->wake_lock);
+}
+
+// Destruktor för async_key: lämnar tillbaka den avslutande trådens ringar
+static void async_release(void* arg) {
+    AsyncLocal* local = (AsyncLocal*)arg;
+    pthread_mutex_lock(&executors_lock);
+    for (int i = 0; i < ASYNC_LOCAL_SLOTS; i++) {
+        if (!local[i].id) continue;
+        AsyncExecutor* executor = async_find(local[i].id);
+        if (executor) {
+            // Release så att exekutorn och nästa tråd på ringen ser allt tråden skickat
+            atomic_store_explicit(&executor->ring_state[local[i].index], ASYNC_RING_ABANDONED, memory_order_release);
+            async_wake(executor);
+        }
+        local[i].id = 0;
+    }
+    pthread_mutex_unlock(&executors_lock);
+}
+
+static void async_key_create(void) {
+    pthread_key_create(&async_key, async_release);
+}
+
+// Tar en ledig eller övergiven och tömd ring, annars skapas en ny. register_lock måste vara tagen
+// Returnerar ringens plats eller -1
+static int async_take_ring(AsyncExecutor* executor) {
+    size_t count = atomic_load_explicit(&executor->num_rings, memory_order_relaxed);
+    for (size_t r = 0; r < count; r++) {
+        int state = atomic_load_explicit(&executor->ring_state[r], memory_order_acquire);
+        if (state == ASYNC_RING_ACTIVE || (state == ASYNC_RING_ABANDONED && spsc_size(executor->rings[r])))
+            continue;
+        // CAS eftersom exekutorn samtidigt kan gå från ABANDONED till FREE
+        if (atomic_compare_exchange_strong_explicit(&executor->ring_state[r], &state, ASYNC_RING_ACTIVE,
+                                                    memory_order_acquire, memory_order_relaxed))
+            return (int)r;
+        if (state == ASYNC_RING_FREE &&
+            atomic_compare_exchange_strong_explicit(&executor->ring_state[r], &state, ASYNC_RING_ACTIVE,
+                                                    memory_order_acquire, memory_order_relaxed))
+            return (int)r;
+    }
+    if (count == ASYNC_MAX_SUBMITTERS) return -1;
+    SpscRing* ring = spsc_create(executor->queue_capacity, sizeof(AsyncRequest));
+    if (!ring) return -1;
+    executor->rings[count] = ring;
+    atomic_store_explicit(&executor->ring_state[count], ASYNC_RING_ACTIVE, memory_order_relaxed);
+    atomic_store_explicit(&executor->num_rings, count + 1, memory_order_release);
+    return (int)count;
+}
+
+// Trådens ring till exekutorn, skapas eller återanvänds vid första inskickningen
+static SpscRing* async_ring(AsyncExecutor* executor) {
+    for (int i = 0; i < ASYNC_LOCAL_SLOTS; i++)
+        if (async_local[i].id == executor->id) return async_local[i].ring;
+
+    pthread_once(&async_key_once, async_key_create);
+    pthread_mutex_lock(&executors_lock);
+    // Platser för exekutorer som förstörts frigörs här, deras id finns inte längre
+    int free_slot = -1;
+    for (int i = 0; i < ASYNC_LOCAL_SLOTS; i++) {
+        if (async_local[i].id && !async_find(async_local[i].id)) async_local[i].id = 0;
+        if (!async_local[i].id && free_slot < 0) free_slot = i;
+    }
+    SpscRing* ring = NULL;
+    if (free_slot < 0) {
+        fprintf(stderr, "Error: Thread submits to more than %d executors\n", ASYNC_LOCAL_SLOTS);
+    } else {
+        pthread_mutex_lock(&executor->register_lock);
+        int index = async_take_ring(executor);
+        pthread_mutex_unlock(&executor->register_lock);
+        if (index >= 0) {
+            ring = executor->rings[index];
+            async_local[free_slot] = (AsyncLocal){.id = executor->id, .ring = ring, .index = index};
+            pthread_setspecific(async_key, async_local);
+        } else {
+            fprintf(stderr, "Error: Could not register submitting thread with executor\n");
+        }
+    }
+    pthread_mutex_unlock(&executors_lock);
+    return ring;
+}
+
+static void async_complete(AsyncRequest* request, int result, void* ptr) {
+    AsyncFuture* future = request->future;
+    if (future) {
+        future->result = result;
+        future->ptr = ptr;
+        atomic_store_explicit(&future->done, 1, memory_order_release);
+    }
+    if (request->callback) {
+        // Utan future får callbacken en tillfällig med resultatet
+        AsyncFuture local = {.result = result, .ptr = ptr};
+        atomic_init(&local.done, 1);
+        request->callback(future ? future : &local, request->ctx);
+    }
+}
+
+// Kör en batch i ordning - på varandra följande listoperationer går i ett list_apply_batch_owned
+static void async_apply(AsyncExecutor* executor, AsyncRequest* requests, size_t count) {
+    ListOp ops[ASYNC_BATCH];
+    int results[ASYNC_BATCH];
+    size_t i = 0;
+    while (i < count) {
+        if (requests[i].kind == ASYNC_LIST) {
+            size_t run = 0;
+            while (i + run < count && requests[i + run].kind == ASYNC_LIST) {
+                ops[run] = requests[i + run].op;
+                run++;
+            }
+            list_apply_batch_owned(executor->head, ops, run, results);
+            for (size_t j = 0; j < run; j++) async_complete(&requests[i + j], results[j], NULL);
+            i += run;
+        } else if (requests[i].kind == ASYNC_ALLOC) {
+            void* ptr = mem_alloc(requests[i].size);
+            async_complete(&requests[i], ptr ? 0 : -1, ptr);
+            i++;
+        } else {
+            mem_free(requests[i].ptr);
+            async_complete(&requests[i], 0, NULL);
+            i++;
+        }
+    }
+}
+
+// Ett varv över alla ringar, returnerar antal utförda förfrågningar
+static size_t async_drain(AsyncExecutor* executor) {
+    AsyncRequest batch[ASYNC_BATCH];
+    size_t total = 0;
+    size_t rings = atomic_load_explicit(&executor->num_rings, memory_order_acquire);
+    for (size_t r = 0; r < rings; r++) {
+        int state = atomic_load_explicit(&executor->ring_state[r], memory_order_acquire);
+        if (state == ASYNC_RING_FREE) continue;
+        size_t count = spsc_pop(executor->rings[r], batch, ASYNC_BATCH);
+        if (count) async_apply(executor, batch, count);
+        total += count;
+        // En övergiven ring som tömts blir ledig, release så att nästa producent ser head
+        if (state == ASYNC_RING_ABANDONED && !spsc_size(executor->rings[r]))
+            atomic_compare_exchange_strong_explicit(&executor->ring_state[r], &state, ASYNC_RING_FREE,
+                                                    memory_order_release, memory_order_relaxed);
+    }
+    return total;
+}
+
+// Sover tills en inskickare väcker exekutorn eller den stängs av
+// sleeping sätts före en sista genomsökning, så en förfrågan som läggs i en tom ring
+// efteråt ser flaggan i async_wake och väcker
+static void async_sleep(AsyncExecutor* executor) {
+    atomic_store_explicit(&executor->sleeping, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!async_drain(executor)) {
+        pthread_mutex_lock(&executor->wake_lock);
+        while (atomic_load_explicit(&executor->sleeping, memory_order_relaxed) &&
+               !atomic_load_explicit(&executor->shutdown, memory_order_acquire))
+            pthread_cond_wait(&executor->wake_cond, &executor->wake_lock);
+        pthread_mutex_unlock(&executor->wake_lock);
+    }
+    atomic_store_explicit(&executor->sleeping, 0, memory_order_relaxed);
+}
+
+static void* async_main(void* arg) {
+    AsyncExecutor* executor = (AsyncExecutor*)arg;
+    int idle = 0;
+    while (!atomic_load_explicit(&executor->shutdown, memory_order_acquire)) {
+        if (async_drain(executor)) {
+            idle = 0;
+        } else if (++idle < ASYNC_SPIN_ROUNDS) {
+            sched_yield();
+        } else {
+            async_sleep(executor);
+            idle = 0;
+        }
+    }
+    while (async_drain(executor)) /* Töm det som skickats före avstängning */ ;
+    return NULL;
+}
+
+// Startar en exekutortråd som äger listan head
+// queue_capacity är storleken på varje inskickande tråds ring
+AsyncExecutor* async_create(Node** head, size_t queue_capacity) {
+    AsyncExecutor* executor = (AsyncExecutor*)malloc(sizeof(AsyncExecutor));
+    if (!executor) {
+        fprintf(stderr, "Error: Memory allocation failed in async_create.\n");
+        return NULL;
+    }
+    executor->head = head;
+    executor->queue_capacity = queue_capacity ? queue_capacity : ASYNC_BATCH;
+    atomic_init(&executor->num_rings, 0);
+    atomic_init(&executor->shutdown, 0);
+    atomic_init(&executor->sleeping, 0);
+    pthread_mutex_init(&executor->register_lock, NULL);
+    pthread_mutex_init(&executor->wake_lock, NULL);
+    pthread_cond_init(&executor->wake_cond, NULL);
+    if (pthread_create(&executor->thread, NULL, async_main, executor)) {
+        perror("Failed to create executor thread");
+        pthread_cond_destroy(&executor->wake_cond);
+        pthread_mutex_destroy(&executor->wake_lock);
+        pthread_mutex_destroy(&executor->register_lock);
+        free(executor);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&executors_lock);
+    executor->id = next_executor_id++;
+    executor->next = executors;
+    executors = executor;
+    pthread_mutex_unlock(&executors_lock);
+    return executor;
+}
+
+// Utför allt som redan skickats in och stoppar exekutorn
+// Inga trådar får skicka in samtidigt med eller efter anropet
+void async_destroy(AsyncExecutor* executor) {
+    if (!executor) return;
+
+    // Efter avlänkningen rör avslutande trådar inte längre exekutorns ringar
+    pthread_mutex_lock(&executors_lock);
+    AsyncExecutor** link = &executors;
+    while (*link != executor) link = &(*link)->next;
+    *link = executor->next;
+    pthread_mutex_unlock(&executors_lock);
+
+    pthread_mutex_lock(&executor->wake_lock);
+    atomic_store_explicit(&executor->shutdown, 1, memory_order_release);
+    pthread_cond_signal(&executor->wake_cond);
+    pthread_mutex_unlock(&executor->wake_lock);
+    pthread_join(executor->thread, NULL);
+
+    size_t rings = atomic_load(&executor->num_rings);
+    for (size_t r = 0; r < rings; r++) spsc_destroy(executor->rings[r]);
+    pthread_cond_destroy(&executor->wake_cond);
+    pthread_mutex_destroy(&executor->wake_lock);
+    pthread_mutex_destroy(&executor->register_lock);
+
+    // Trådens egen plats frigörs direkt, andra trådars nästa gång de registrerar sig
+    for (int i = 0; i < ASYNC_LOCAL_SLOTS; i++)
+        if (async_local[i].id == executor->id) async_local[i].id = 0;
+    free(executor);
+}
+
+// Lägger förfrågan i trådens ring utan att blockera
+// Returnerar 0, eller -1 om ringen är full (försök igen senare) eller inte kunde skapas
+static int async_submit(AsyncExecutor* executor, AsyncRequest* request) {
+    SpscRing* ring = async_ring(executor);
+    if (!ring) return -1;
+    if (request->future) {
+        atomic_store_explicit(&request->future->done, 0, memory_order_relaxed);
+        request->future->ptr = NULL;
+    }
+    if (spsc_push(ring, request, 1) != 1) return -1;
+    async_wake(executor); // Väcker bara om exekutorn funnit alla ringar tomma och somnat
+    return 0;
+}
+
+int list_submit(AsyncExecutor* executor, ListOp op, async_callback callback, void* ctx, AsyncFuture* future) {
+    AsyncRequest request = {.kind = ASYNC_LIST, .op = op, .callback = callback, .ctx = ctx, .future = future};
+    return async_submit(executor, &request);
+}
+
+int mem_submit_alloc(AsyncExecutor* executor, size_t size, async_callback callback, void* ctx, AsyncFuture* future) {
+    AsyncRequest request = {.kind = ASYNC_ALLOC, .size = size, .callback = callback, .ctx = ctx, .future = future};
+    return async_submit(executor, &request);
+}
+
+int mem_submit_free(AsyncExecutor* executor, void* ptr, async_callback callback, void* ctx, AsyncFuture* future) {
+    AsyncRequest request = {.kind = ASYNC_FREE, .ptr = ptr, .callback = callback, .ctx = ctx, .future = future};
+    return async_submit(executor, &request);
+}
+
+// Returnerar 1 om resultatet är klart annars 0
+int async_poll(AsyncFuture* future) {
+    return atomic_load_explicit(&future->done, memory_order_acquire);
+}
+
+// Väntar aktivt på resultatet - för trådar som får blockera
+void async_wait(AsyncFuture* future) {
+    while (!async_poll(future)) sched_yield();
+}
@@ -0,0 +1,36 @@
+#ifndef ASYNC_EXEC_H
+#define ASYNC_EXEC_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include "linked_list.h"
+
+// En exekutor tar emot från högst 256 samtidigt levande trådar (ASYNC_MAX_SUBMITTERS) och en tråd
+// kan skicka till högst 8 exekutorer samtidigt. En tråds ring lämnas tillbaka när tråden avslutas
+// och platsen när exekutorn förstörs, så gränserna gäller bara samtidigt levande trådar och exekutorer.
+// Utöver gränserna returnerar inskickningen -1
+typedef struct AsyncExecutor AsyncExecutor;
+
+typedef struct AsyncFuture {
+    atomic_int done; // 1 när resultatet är klart
+    int result;      // Som i list_apply_batch, eller 0/-1 för minnesoperationer
+    void* ptr;       // Allokerat block för mem_submit_alloc
+} AsyncFuture;
+
+typedef void (*async_callback)(AsyncFuture* future, void* ctx);
+
+AsyncExecutor* async_create(Node** head, size_t queue_capacity);
+
+void async_destroy(AsyncExecutor* executor);
+
+int list_submit(AsyncExecutor* executor, ListOp op, async_callback callback, void* ctx, AsyncFuture* future);
+
+int mem_submit_alloc(AsyncExecutor* executor, size_t size, async_callback callback, void* ctx, AsyncFuture* future);
+
+int mem_submit_free(AsyncExecutor* executor, void* ptr, async_callback callback, void* ctx, AsyncFuture* future);
+
+int async_poll(AsyncFuture* future);
+
+void async_wait(AsyncFuture* future);
+
+#endif
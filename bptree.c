@@ -0,0 +1,391 @@
+#include "bptree.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// B+-träd med noder på fyra cache-lines (256 bytes) ur minnespoolen
+// Alla värden ligger i löven, som är länkade i nyckelordning - ett intervall läses sekventiellt
+// efter en enda nedstigning istället för att hela listan traverseras
+// Ingen intern låsning - anroparen ansvarar för synkronisering
+
+#define BPT_NODE_SIZE 256
+#define BPT_NODE_ALIGN 64
+#define BPT_LEAF_MAX ((BPT_NODE_SIZE - 16) / (2 * sizeof(uint32_t)))                  // 30 nyckel/värde-par
+#define BPT_INNER_MAX ((BPT_NODE_SIZE - 16) / (sizeof(uint32_t) + sizeof(void*)))     // 20 nycklar, 21 barn
+
+typedef struct {
+    uint16_t is_leaf;
+    uint16_t count; // Antal nycklar i noden
+} BPlusHeader;
+
+typedef struct BPlusLeaf {
+    BPlusHeader header;
+    struct BPlusLeaf* next; // Nästa löv i nyckelordning
+    uint32_t keys[BPT_LEAF_MAX];
+    uint32_t values[BPT_LEAF_MAX];
+} BPlusLeaf;
+
+typedef struct {
+    BPlusHeader header;
+    uint32_t keys[BPT_INNER_MAX];        // keys[i] är minsta nyckeln i children[i + 1]
+    void* children[BPT_INNER_MAX + 1];
+} BPlusInner;
+
+_Static_assert(sizeof(BPlusLeaf) <= BPT_NODE_SIZE, "B+ leaf does not fit in a node");
+_Static_assert(sizeof(BPlusInner) <= BPT_NODE_SIZE, "B+ inner node does not fit in a node");
+
+struct BPlusTree {
+    void* root;    // NULL när trädet är tomt
+    size_t height; // 1 = roten är ett löv
+    size_t size;
+};
+
+static void* bpt_alloc_node(int is_leaf) {
+    BPlusHeader* node = (BPlusHeader*)mem_alloc_aligned(BPT_NODE_SIZE, BPT_NODE_ALIGN);
+    if (!node) {
+        fprintf(stderr, "Error: Could not allocate B+ tree node from memory pool\n");
+        return NULL;
+    }
+    node->is_leaf = (uint16_t)is_leaf;
+    node->count = 0;
+    if (is_leaf) ((BPlusLeaf*)node)->next = NULL;
+    return node;
+}
+
+// Första positionen med keys[i] >= key
+static inline size_t bpt_lower_bound(const uint32_t* keys, size_t count, uint32_t key) {
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (keys[mid] < key) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+// Första positionen med keys[i] > key - barnindex i en inre nod
+static inline size_t bpt_upper_bound(const uint32_t* keys, size_t count, uint32_t key) {
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (keys[mid] <= key) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+static BPlusLeaf* bpt_find_leaf(BPlusTree* tree, uint32_t key) {
+    void* node = tree->root;
+    if (!node) return NULL;
+    while (!((BPlusHeader*)node)->is_leaf) {
+        BPlusInner* inner = (BPlusInner*)node;
+        node = inner->children[bpt_upper_bound(inner->keys, inner->header.count, key)];
+    }
+    return (BPlusLeaf*)node;
+}
+
+BPlusTree* bptree_create(void) {
+    BPlusTree* tree = (BPlusTree*)malloc(sizeof(BPlusTree));
+    if (!tree) {
+        fprintf(stderr, "Error: Memory allocation failed in bptree_create.\n");
+        return NULL;
+    }
+    tree->root = NULL;
+    tree->height = 0;
+    tree->size = 0;
+    return tree;
+}
+
+// Rekursiv insättning
+// Returnerar -1 vid fel, 0 om noden inte delades, 1 om den delades (ny högernod i *split_node)
+static int bpt_insert_rec(BPlusTree* tree, void* node, uint32_t key, uint32_t value,
+                          uint32_t* split_key, void** split_node) {
+    if (((BPlusHeader*)node)->is_leaf) {
+        BPlusLeaf* leaf = (BPlusLeaf*)node;
+        size_t count = leaf->header.count;
+        size_t pos = bpt_lower_bound(leaf->keys, count, key);
+
+        if (pos < count && leaf->keys[pos] == key) {
+            leaf->values[pos] = value; // Befintlig nyckel - uppdatera
+            return 0;
+        }
+
+        if (count < BPT_LEAF_MAX) {
+            memmove(&leaf->keys[pos + 1], &leaf->keys[pos], (count - pos) * sizeof(uint32_t));
+            memmove(&leaf->values[pos + 1], &leaf->values[pos], (count - pos) * sizeof(uint32_t));
+            leaf->keys[pos] = key;
+            leaf->values[pos] = value;
+            leaf->header.count++;
+            tree->size++;
+            return 0;
+        }
+
+        // Lövet är fullt - dela det i två halvor
+        BPlusLeaf* right = (BPlusLeaf*)bpt_alloc_node(1);
+        if (!right) return -1;
+
+        uint32_t keys[BPT_LEAF_MAX + 1], values[BPT_LEAF_MAX + 1];
+        memcpy(keys, leaf->keys, pos * sizeof(uint32_t));
+        memcpy(values, leaf->values, pos * sizeof(uint32_t));
+        keys[pos] = key;
+        values[pos] = value;
+        memcpy(&keys[pos + 1], &leaf->keys[pos], (count - pos) * sizeof(uint32_t));
+        memcpy(&values[pos + 1], &leaf->values[pos], (count - pos) * sizeof(uint32_t));
+
+        size_t left_count = (BPT_LEAF_MAX + 1) / 2;
+        size_t right_count = BPT_LEAF_MAX + 1 - left_count;
+        memcpy(leaf->keys, keys, left_count * sizeof(uint32_t));
+        memcpy(leaf->values, values, left_count * sizeof(uint32_t));
+        memcpy(right->keys, &keys[left_count], right_count * sizeof(uint32_t));
+        memcpy(right->values, &values[left_count], right_count * sizeof(uint32_t));
+        leaf->header.count = (uint16_t)left_count;
+        right->header.count = (uint16_t)right_count;
+
+        right->next = leaf->next;
+        leaf->next = right;
+        tree->size++;
+
+        *split_key = right->keys[0];
+        *split_node = right;
+        return 1;
+    }
+
+    BPlusInner* inner = (BPlusInner*)node;
+    size_t count = inner->header.count;
+    size_t index = bpt_upper_bound(inner->keys, count, key);
+
+    uint32_t child_key;
+    void* child_node;
+    int result = bpt_insert_rec(tree, inner->children[index], key, value, &child_key, &child_node);
+    if (result <= 0) return result;
+
+    // Barnet delades - lägg in separatorn och den nya högernoden
+    if (count < BPT_INNER_MAX) {
+        memmove(&inner->keys[index + 1], &inner->keys[index], (count - index) * sizeof(uint32_t));
+        memmove(&inner->children[index + 2], &inner->children[index + 1], (count - index) * sizeof(void*));
+        inner->keys[index] = child_key;
+        inner->children[index + 1] = child_node;
+        inner->header.count++;
+        return 0;
+    }
+
+    // Den inre noden är full - dela den, mittersta nyckeln flyttas upp en nivå
+    BPlusInner* right = (BPlusInner*)bpt_alloc_node(0);
+    if (!right) return -1;
+
+    uint32_t keys[BPT_INNER_MAX + 1];
+    void* children[BPT_INNER_MAX + 2];
+    memcpy(keys, inner->keys, index * sizeof(uint32_t));
+    keys[index] = child_key;
+    memcpy(&keys[index + 1], &inner->keys[index], (count - index) * sizeof(uint32_t));
+    memcpy(children, inner->children, (index + 1) * sizeof(void*));
+    children[index + 1] = child_node;
+    memcpy(&children[index + 2], &inner->children[index + 1], (count - index) * sizeof(void*));
+
+    size_t left_count = (BPT_INNER_MAX + 1) / 2;
+    size_t right_count = BPT_INNER_MAX - left_count; // En nyckel flyttas upp
+    memcpy(inner->keys, keys, left_count * sizeof(uint32_t));
+    memcpy(inner->children, children, (left_count + 1) * sizeof(void*));
+    memcpy(right->keys, &keys[left_count + 1], right_count * sizeof(uint32_t));
+    memcpy(right->children, &children[left_count + 1], (right_count + 1) * sizeof(void*));
+    inner->header.count = (uint16_t)left_count;
+    right->header.count = (uint16_t)right_count;
+
+    *split_key = keys[left_count];
+    *split_node = right;
+    return 1;
+}
+
+// Lägger till eller uppdaterar en nyckel, O(log n)
+// Returnerar 0 eller -1 om en nod inte kunde allokeras
+int bptree_insert(BPlusTree* tree, uint32_t key, uint32_t value) {
+    if (!tree->root) {
+        tree->root = bpt_alloc_node(1);
+        if (!tree->root) return -1;
+        tree->height = 1;
+    }
+
+    uint32_t split_key;
+    void* split_node;
+    int result = bpt_insert_rec(tree, tree->root, key, value, &split_key, &split_node);
+    if (result <= 0) return result;
+
+    // Roten delades - trädet växer en nivå uppåt
+    BPlusInner* root = (BPlusInner*)bpt_alloc_node(0);
+    if (!root) return -1;
+    root->header.count = 1;
+    root->keys[0] = split_key;
+    root->children[0] = tree->root;
+    root->children[1] = split_node;
+    tree->root = root;
+    tree->height++;
+    return 0;
+}
+
+// Punktuppslagning, returnerar 1 och skriver värdet om nyckeln finns, annars 0
+int bptree_get(BPlusTree* tree, uint32_t key, uint32_t* value) {
+    BPlusLeaf* leaf = bpt_find_leaf(tree, key);
+    if (!leaf) return 0;
+    size_t pos = bpt_lower_bound(leaf->keys, leaf->header.count, key);
+    if (pos == leaf->header.count || leaf->keys[pos] != key) return 0;
+    if (value) *value = leaf->values[pos];
+    return 1;
+}
+
+// Bygger trädet nedifrån och upp ur strikt stigande nycklar
+// Löven fylls helt och nivåerna ovanför byggs en i taget - O(n) utan några delningar
+// Trädet måste vara tomt, returnerar 0 eller -1 vid fel
+int bptree_bulk_load(BPlusTree* tree, const uint32_t* keys, const uint32_t* values, size_t count) {
+    if (tree->root) {
+        fprintf(stderr, "Error: bptree_bulk_load requires an empty tree\n");
+        return -1;
+    }
+    for (size_t i = 1; i < count; i++) {
+        if (keys[i - 1] >= keys[i]) {
+            fprintf(stderr, "Error: bptree_bulk_load input is not strictly ascending at index %zu\n", i);
+            return -1;
+        }
+    }
+    if (count == 0) return 0;
+
+    // Räkna ut antalet noder på varje nivå och allokera alla i förväg,
+    // så att ett allokeringsfel kan städas upp innan trädet har byggts
+    size_t num_leaves = (count + BPT_LEAF_MAX - 1) / BPT_LEAF_MAX;
+    size_t total_nodes = 0;
+    for (size_t n = num_leaves;; n = (n + BPT_INNER_MAX) / (BPT_INNER_MAX + 1)) {
+        total_nodes += n;
+        if (n == 1) break;
+    }
+
+    void** pool_nodes = (void**)malloc(total_nodes * sizeof(void*));
+    void** nodes = (void**)malloc(num_leaves * sizeof(void*));
+    uint32_t* min_keys = (uint32_t*)malloc(num_leaves * sizeof(uint32_t));
+    if (!pool_nodes || !nodes || !min_keys) {
+        fprintf(stderr, "Error: Memory allocation failed in bptree_bulk_load.\n");
+        free(pool_nodes);
+        free(nodes);
+        free(min_keys);
+        return -1;
+    }
+    for (size_t i = 0; i < total_nodes; i++) {
+        pool_nodes[i] = bpt_alloc_node(i < num_leaves);
+        if (!pool_nodes[i]) {
+            while (i > 0) mem_free(pool_nodes[--i]);
+            free(pool_nodes);
+            free(nodes);
+            free(min_keys);
+            return -1;
+        }
+    }
+    size_t used = 0;
+
+    // Löv: fördela elementen jämnt så att inget löv blir nästan tomt
+    size_t num_nodes = num_leaves;
+    size_t next = 0;
+    BPlusLeaf* prev = NULL;
+    for (size_t i = 0; i < num_nodes; i++) {
+        size_t n = count / num_nodes + (i < count % num_nodes);
+        BPlusLeaf* leaf = (BPlusLeaf*)pool_nodes[used++];
+        memcpy(leaf->keys, &keys[next], n * sizeof(uint32_t));
+        memcpy(leaf->values, &values[next], n * sizeof(uint32_t));
+        leaf->header.count = (uint16_t)n;
+        if (prev) prev->next = leaf;
+        prev = leaf;
+        nodes[i] = leaf;
+        min_keys[i] = keys[next];
+        next += n;
+    }
+    tree->height = 1;
+
+    // Inre nivåer tills en enda rot återstår
+    while (num_nodes > 1) {
+        size_t num_parents = (num_nodes + BPT_INNER_MAX) / (BPT_INNER_MAX + 1);
+        size_t child = 0;
+        for (size_t i = 0; i < num_parents; i++) {
+            size_t n = num_nodes / num_parents + (i < num_nodes % num_parents);
+            BPlusInner* inner = (BPlusInner*)pool_nodes[used++];
+            for (size_t c = 0; c < n; c++) {
+                inner->children[c] = nodes[child + c];
+                if (c > 0) inner->keys[c - 1] = min_keys[child + c];
+            }
+            inner->header.count = (uint16_t)(n - 1);
+            // Föräldrarna skrivs över framifrån - index i <= child så inget läses efter att ha skrivits
+            uint32_t min_key = min_keys[child];
+            nodes[i] = inner;
+            min_keys[i] = min_key;
+            child += n;
+        }
+        num_nodes = num_parents;
+        tree->height++;
+    }
+
+    tree->root = nodes[0];
+    tree->size = count;
+    free(pool_nodes);
+    free(nodes);
+    free(min_keys);
+    return 0;
+}
+
+// Placerar markören på första nyckeln >= key
+void bptree_seek(BPlusTree* tree, uint32_t key, BPlusCursor* cursor) {
+    BPlusLeaf* leaf = bpt_find_leaf(tree, key);
+    size_t index = leaf ? bpt_lower_bound(leaf->keys, leaf->header.count, key) : 0;
+    if (leaf && index == leaf->header.count) {
+        leaf = leaf->next;
+        index = 0;
+    }
+    cursor->leaf = leaf;
+    cursor->index = index;
+}
+
+// Läser nästa par i nyckelordning och flyttar markören, returnerar 0 när iterationen är slut
+int bptree_next(BPlusCursor* cursor, uint32_t* key, uint32_t* value) {
+    BPlusLeaf* leaf = (BPlusLeaf*)cursor->leaf;
+    if (!leaf) return 0;
+
+    if (key) *key = leaf->keys[cursor->index];
+    if (value) *value = leaf->values[cursor->index];
+
+    if (++cursor->index == leaf->header.count) {
+        cursor->leaf = leaf->next;
+        cursor->index = 0;
+    }
+    return 1;
+}
+
+// Besöker alla par med low <= key <= high i ordning
+// visit kan avbryta genom att returnera något annat än 0, returnerar antal besökta par
+size_t bptree_range(BPlusTree* tree, uint32_t low, uint32_t high, bptree_visit_fn visit, void* ctx) {
+    BPlusCursor cursor;
+    uint32_t key, value;
+    size_t visited = 0;
+
+    bptree_seek(tree, low, &cursor);
+    while (bptree_next(&cursor, &key, &value) && key <= high) {
+        visited++;
+        if (visit && visit(key, value, ctx) != 0) break;
+    }
+    return visited;
+}
+
+size_t bptree_size(BPlusTree* tree) {
+    return tree->size;
+}
+
+static void bpt_free_rec(void* node) {
+    if (!((BPlusHeader*)node)->is_leaf) {
+        BPlusInner* inner = (BPlusInner*)node;
+        for (size_t i = 0; i <= inner->header.count; i++)
+            bpt_free_rec(inner->children[i]);
+    }
+    mem_free(node);
+}
+
+// Lämnar tillbaka alla noder till minnespoolen
+void bptree_destroy(BPlusTree* tree) {
+    if (!tree) return;
+    if (tree->root) bpt_free_rec(tree->root);
+    free(tree);
+}
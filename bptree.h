@@ -0,0 +1,34 @@
+#ifndef BPTREE_H
+#define BPTREE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct BPlusTree BPlusTree;
+
+typedef struct BPlusCursor {
+    void* leaf;   // Aktuellt löv, NULL när iterationen är slut
+    size_t index; // Position i lövet
+} BPlusCursor;
+
+typedef int (*bptree_visit_fn)(uint32_t key, uint32_t value, void* ctx);
+
+BPlusTree* bptree_create(void);
+
+int bptree_insert(BPlusTree* tree, uint32_t key, uint32_t value);
+
+int bptree_get(BPlusTree* tree, uint32_t key, uint32_t* value);
+
+int bptree_bulk_load(BPlusTree* tree, const uint32_t* keys, const uint32_t* values, size_t count);
+
+void bptree_seek(BPlusTree* tree, uint32_t key, BPlusCursor* cursor);
+
+int bptree_next(BPlusCursor* cursor, uint32_t* key, uint32_t* value);
+
+size_t bptree_range(BPlusTree* tree, uint32_t low, uint32_t high, bptree_visit_fn visit, void* ctx);
+
+size_t bptree_size(BPlusTree* tree);
+
+void bptree_destroy(BPlusTree* tree);
+
+#endif
@@ -0,0 +1,371 @@
+#include "deque.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// Deque av block (chunks) med fast storlek ur minnespoolen plus en karta med blockpekare
+// Element i sitter i kartans block (head + i) >> shift på plats (head + i) & mask, så
+// push/pop i båda ändar och indexering är O(1). Block allokeras när en ände går in i dem
+// och lämnas tillbaka när de töms. Kartan centreras om eller dubblas när en ände når kanten.
+// Ersätter list_insert (malloc per element och O(n) vandring till svansen) för glidande fönster
+
+#define CACHE_LINE 64
+#define DEQUE_CHUNK_BYTES 4096
+#define DEQUE_MIN_MAP 8
+
+struct Deque {
+    char** map;          // Blockpekare, NULL för block utan element
+    size_t map_capacity;
+    size_t elem_size;
+    unsigned shift;      // log2(element per block)
+    size_t mask;
+    // Globala positioner räknade från kartans början. head skrivs bara av framänden och
+    // tail bara av bakänden (utom vid omcentrering) - atomiska för den samtidiga varianten
+    _Alignas(CACHE_LINE) atomic_size_t head;
+    char* spare_front;   // Senast tömda block i framänden, återanvänds innan nytt allokeras
+    _Alignas(CACHE_LINE) atomic_size_t tail;
+    char* spare_back;
+};
+
+static inline char* deque_slot(Deque* deque, size_t pos) {
+    return deque->map[pos >> deque->shift] + (pos & deque->mask) * deque->elem_size;
+}
+
+static char* deque_take_chunk(Deque* deque, char** spare) {
+    char* chunk = *spare;
+    if (chunk) {
+        *spare = NULL;
+        return chunk;
+    }
+    chunk = (char*)mem_alloc((deque->mask + 1) * deque->elem_size);
+    if (!chunk) fprintf(stderr, "Error: Could not allocate deque chunk from memory pool\n");
+    return chunk;
+}
+
+static void deque_drop_chunk(Deque* deque, size_t index, char** spare) {
+    if (*spare) mem_free(*spare);
+    *spare = deque->map[index];
+    deque->map[index] = NULL;
+}
+
+static int deque_init(Deque* deque, size_t elem_size) {
+    size_t per_chunk = 1;
+    unsigned shift = 0;
+    while (per_chunk * 2 * elem_size <= DEQUE_CHUNK_BYTES) {
+        per_chunk *= 2;
+        shift++;
+    }
+    deque->elem_size = elem_size;
+    deque->shift = shift;
+    deque->mask = per_chunk - 1;
+    deque->spare_front = deque->spare_back = NULL;
+    deque->map_capacity = DEQUE_MIN_MAP;
+    deque->map = (char**)mem_alloc(DEQUE_MIN_MAP * sizeof(char*));
+    if (!deque->map) {
+        fprintf(stderr, "Error: Could not allocate deque map from memory pool\n");
+        return -1;
+    }
+    memset(deque->map, 0, DEQUE_MIN_MAP * sizeof(char*));
+    // Börja mitt i kartan så båda ändar kan växa innan kartan byggs om
+    size_t start = (size_t)(DEQUE_MIN_MAP / 2) << shift;
+    atomic_init(&deque->head, start);
+    atomic_init(&deque->tail, start);
+    return 0;
+}
+
+static void deque_release(Deque* deque) {
+    if (!deque->map) return;
+    for (size_t i = 0; i < deque->map_capacity; i++)
+        if (deque->map[i]) mem_free(deque->map[i]);
+    if (deque->spare_front) mem_free(deque->spare_front);
+    if (deque->spare_back) mem_free(deque->spare_back);
+    mem_free(deque->map);
+}
+
+// Bygger om kartan så att det finns minst ett ledigt block på båda sidor om de använda
+// Centrerar om i samma storlek om högst halva kartan används, annars dubblas den
+// Ändrar både head och tail - den samtidiga varianten måste hålla båda låsen
+static int deque_remap(Deque* deque) {
+    size_t head = atomic_load_explicit(&deque->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&deque->tail, memory_order_relaxed);
+    size_t first = head >> deque->shift;
+    size_t used = ((tail + deque->mask) >> deque->shift) - first;
+    if (used == 0) used = 1;
+
+    size_t capacity = deque->map_capacity;
+    while (used + 2 > capacity / 2) capacity *= 2;
+
+    char** map = (char**)mem_alloc(capacity * sizeof(char*));
+    if (!map) {
+        fprintf(stderr, "Error: Could not grow deque map to %zu chunks\n", capacity);
+        return -1;
+    }
+    memset(map, 0, capacity * sizeof(char*));
+
+    size_t new_first = (capacity - used) / 2;
+    for (size_t i = 0; i < deque->map_capacity; i++) {
+        if (!deque->map[i]) continue;
+        if (i < first || i >= first + used) {
+            // Tomt block utanför de använda (kvar efter att dequen tömts) - lämna tillbaka
+            mem_free(deque->map[i]);
+            continue;
+        }
+        map[i - first + new_first] = deque->map[i];
+    }
+    mem_free(deque->map);
+    deque->map = map;
+    deque->map_capacity = capacity;
+
+    size_t delta = (new_first - first) << deque->shift; // Får slå runt, positionerna räknas modulo
+    atomic_store_explicit(&deque->head, head + delta, memory_order_relaxed);
+    atomic_store_explicit(&deque->tail, tail + delta, memory_order_relaxed);
+    return 0;
+}
+
+// Ändarnas kärnoperationer - förutsätter att anroparen hanterat kartans kanter och samtidighet
+
+static inline int deque_at_back_edge(Deque* deque, size_t tail) {
+    return (tail >> deque->shift) >= deque->map_capacity;
+}
+
+static inline int deque_at_front_edge(size_t head) {
+    return head == 0;
+}
+
+static int deque_push_back_core(Deque* deque, size_t tail, const void* elem) {
+    size_t index = tail >> deque->shift;
+    if (!deque->map[index] && !(deque->map[index] = deque_take_chunk(deque, &deque->spare_back))) return -1;
+    memcpy(deque_slot(deque, tail), elem, deque->elem_size);
+    atomic_store_explicit(&deque->tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+static int deque_push_front_core(Deque* deque, size_t head, const void* elem) {
+    size_t index = (head - 1) >> deque->shift;
+    if (!deque->map[index] && !(deque->map[index] = deque_take_chunk(deque, &deque->spare_front))) return -1;
+    memcpy(deque_slot(deque, head - 1), elem, deque->elem_size);
+    atomic_store_explicit(&deque->head, head - 1, memory_order_release);
+    return 0;
+}
+
+static void deque_pop_back_core(Deque* deque, size_t tail, void* elem) {
+    tail--;
+    if (elem) memcpy(elem, deque_slot(deque, tail), deque->elem_size);
+    atomic_store_explicit(&deque->tail, tail, memory_order_release);
+    // Blocket är tomt när tail hamnar på dess första plats
+    if ((tail & deque->mask) == 0) deque_drop_chunk(deque, tail >> deque->shift, &deque->spare_back);
+}
+
+static void deque_pop_front_core(Deque* deque, size_t head, void* elem) {
+    if (elem) memcpy(elem, deque_slot(deque, head), deque->elem_size);
+    atomic_store_explicit(&deque->head, head + 1, memory_order_release);
+    // Blocket är tomt när head lämnar dess sista plats
+    if (((head + 1) & deque->mask) == 0) deque_drop_chunk(deque, head >> deque->shift, &deque->spare_front);
+}
+
+// ********* Deque utan låsning - anroparen ansvarar för synkronisering *********
+
+// Skapar en tom deque för element på elem_size bytes
+Deque* deque_create(size_t elem_size) {
+    if (elem_size == 0 || elem_size > DEQUE_CHUNK_BYTES) {
+        fprintf(stderr, "Error: Invalid deque element size\n");
+        return NULL;
+    }
+    // Strukturen har cache-line-alignade fält och hämtas därför ur poolen
+    Deque* deque = (Deque*)mem_alloc_aligned(sizeof(Deque), CACHE_LINE);
+    if (!deque) {
+        fprintf(stderr, "Error: Could not allocate deque from memory pool\n");
+        return NULL;
+    }
+    if (deque_init(deque, elem_size) != 0) {
+        mem_free(deque);
+        return NULL;
+    }
+    return deque;
+}
+
+// Returnerar 0 eller -1 om minnespoolen är full
+int deque_push_back(Deque* deque, const void* elem) {
+    if (deque_at_back_edge(deque, atomic_load_explicit(&deque->tail, memory_order_relaxed)) &&
+        deque_remap(deque) != 0)
+        return -1;
+    return deque_push_back_core(deque, atomic_load_explicit(&deque->tail, memory_order_relaxed), elem);
+}
+
+int deque_push_front(Deque* deque, const void* elem) {
+    if (deque_at_front_edge(atomic_load_explicit(&deque->head, memory_order_relaxed)) &&
+        deque_remap(deque) != 0)
+        return -1;
+    return deque_push_front_core(deque, atomic_load_explicit(&deque->head, memory_order_relaxed), elem);
+}
+
+// Kopierar ut och tar bort sista elementet, returnerar -1 om dequen är tom
+int deque_pop_back(Deque* deque, void* elem) {
+    size_t tail = atomic_load_explicit(&deque->tail, memory_order_relaxed);
+    if (tail == atomic_load_explicit(&deque->head, memory_order_relaxed)) return -1;
+    deque_pop_back_core(deque, tail, elem);
+    return 0;
+}
+
+int deque_pop_front(Deque* deque, void* elem) {
+    size_t head = atomic_load_explicit(&deque->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&deque->tail, memory_order_relaxed)) return -1;
+    deque_pop_front_core(deque, head, elem);
+    return 0;
+}
+
+// Pekare till element index räknat från framänden, NULL om utanför
+// Pekaren är giltig tills elementet tas bort
+void* deque_at(Deque* deque, size_t index) {
+    size_t head = atomic_load_explicit(&deque->head, memory_order_relaxed);
+    if (index >= atomic_load_explicit(&deque->tail, memory_order_relaxed) - head) return NULL;
+    return deque_slot(deque, head + index);
+}
+
+size_t deque_size(Deque* deque) {
+    return atomic_load_explicit(&deque->tail, memory_order_relaxed) -
+           atomic_load_explicit(&deque->head, memory_order_relaxed);
+}
+
+void deque_destroy(Deque* deque) {
+    if (!deque) return;
+    deque_release(deque);
+    mem_free(deque);
+}
+
+// ********* Samtidig deque med ett lås per ände *********
+// Framänden tar front_lock och bakänden back_lock, så en producent i ena änden och en
+// konsument i den andra går parallellt. Med minst två element rör ändarna aldrig samma
+// element eller block. Ses högst ett element, eller måste kartan byggas om, tas båda låsen
+// (alltid front före back) och villkoret kontrolleras igen.
+
+struct ConcurrentDeque {
+    _Alignas(CACHE_LINE) pthread_mutex_t front_lock;
+    _Alignas(CACHE_LINE) pthread_mutex_t back_lock;
+    Deque deque;
+};
+
+ConcurrentDeque* cdeque_create(size_t elem_size) {
+    if (elem_size == 0 || elem_size > DEQUE_CHUNK_BYTES) {
+        fprintf(stderr, "Error: Invalid deque element size\n");
+        return NULL;
+    }
+    ConcurrentDeque* cdeque = (ConcurrentDeque*)mem_alloc_aligned(sizeof(ConcurrentDeque), CACHE_LINE);
+    if (!cdeque) {
+        fprintf(stderr, "Error: Could not allocate concurrent deque from memory pool\n");
+        return NULL;
+    }
+    if (deque_init(&cdeque->deque, elem_size) != 0) {
+        mem_free(cdeque);
+        return NULL;
+    }
+    pthread_mutex_init(&cdeque->front_lock, NULL);
+    pthread_mutex_init(&cdeque->back_lock, NULL);
+    return cdeque;
+}
+
+static inline void cdeque_lock_both(ConcurrentDeque* cdeque) {
+    pthread_mutex_lock(&cdeque->front_lock);
+    pthread_mutex_lock(&cdeque->back_lock);
+}
+
+static inline void cdeque_unlock_both(ConcurrentDeque* cdeque) {
+    pthread_mutex_unlock(&cdeque->back_lock);
+    pthread_mutex_unlock(&cdeque->front_lock);
+}
+
+// Antal element sett från ena änden - den andra ändens position läses med acquire
+static inline size_t cdeque_seen_size(Deque* deque) {
+    return atomic_load_explicit(&deque->tail, memory_order_acquire) -
+           atomic_load_explicit(&deque->head, memory_order_acquire);
+}
+
+int cdeque_push_back(ConcurrentDeque* cdeque, const void* elem) {
+    Deque* deque = &cdeque->deque;
+    pthread_mutex_lock(&cdeque->back_lock);
+    size_t tail = atomic_load_explicit(&deque->tail, memory_order_relaxed);
+    if (cdeque_seen_size(deque) >= 2 && !deque_at_back_edge(deque, tail)) {
+        int status = deque_push_back_core(deque, tail, elem);
+        pthread_mutex_unlock(&cdeque->back_lock);
+        return status;
+    }
+    pthread_mutex_unlock(&cdeque->back_lock);
+
+    // Långsam väg - båda låsen
+    cdeque_lock_both(cdeque);
+    int status = 0;
+    if (deque_at_back_edge(deque, atomic_load_explicit(&deque->tail, memory_order_relaxed)))
+        status = deque_remap(deque);
+    if (status == 0)
+        status = deque_push_back_core(deque, atomic_load_explicit(&deque->tail, memory_order_relaxed), elem);
+    cdeque_unlock_both(cdeque);
+    return status;
+}
+
+int cdeque_push_front(ConcurrentDeque* cdeque, const void* elem) {
+    Deque* deque = &cdeque->deque;
+    pthread_mutex_lock(&cdeque->front_lock);
+    size_t head = atomic_load_explicit(&deque->head, memory_order_relaxed);
+    if (cdeque_seen_size(deque) >= 2 && !deque_at_front_edge(head)) {
+        int status = deque_push_front_core(deque, head, elem);
+        pthread_mutex_unlock(&cdeque->front_lock);
+        return status;
+    }
+    pthread_mutex_unlock(&cdeque->front_lock);
+
+    cdeque_lock_both(cdeque);
+    int status = 0;
+    if (deque_at_front_edge(atomic_load_explicit(&deque->head, memory_order_relaxed)))
+        status = deque_remap(deque);
+    if (status == 0)
+        status = deque_push_front_core(deque, atomic_load_explicit(&deque->head, memory_order_relaxed), elem);
+    cdeque_unlock_both(cdeque);
+    return status;
+}
+
+// Returnerar 0 eller -1 om dequen är tom
+int cdeque_pop_back(ConcurrentDeque* cdeque, void* elem) {
+    Deque* deque = &cdeque->deque;
+    pthread_mutex_lock(&cdeque->back_lock);
+    if (cdeque_seen_size(deque) >= 2) {
+        deque_pop_back_core(deque, atomic_load_explicit(&deque->tail, memory_order_relaxed), elem);
+        pthread_mutex_unlock(&cdeque->back_lock);
+        return 0;
+    }
+    pthread_mutex_unlock(&cdeque->back_lock);
+
+    cdeque_lock_both(cdeque);
+    int status = deque_pop_back(deque, elem);
+    cdeque_unlock_both(cdeque);
+    return status;
+}
+
+int cdeque_pop_front(ConcurrentDeque* cdeque, void* elem) {
+    Deque* deque = &cdeque->deque;
+    pthread_mutex_lock(&cdeque->front_lock);
+    if (cdeque_seen_size(deque) >= 2) {
+        deque_pop_front_core(deque, atomic_load_explicit(&deque->head, memory_order_relaxed), elem);
+        pthread_mutex_unlock(&cdeque->front_lock);
+        return 0;
+    }
+    pthread_mutex_unlock(&cdeque->front_lock);
+
+    cdeque_lock_both(cdeque);
+    int status = deque_pop_front(deque, elem);
+    cdeque_unlock_both(cdeque);
+    return status;
+}
+
+size_t cdeque_size(ConcurrentDeque* cdeque) {
+    return cdeque_seen_size(&cdeque->deque);
+}
+
+void cdeque_destroy(ConcurrentDeque* cdeque) {
+    if (!cdeque) return;
+    deque_release(&cdeque->deque);
+    pthread_mutex_destroy(&cdeque->front_lock);
+    pthread_mutex_destroy(&cdeque->back_lock);
+    mem_free(cdeque);
+}
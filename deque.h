@@ -0,0 +1,40 @@
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include <stddef.h>
+
+typedef struct Deque Deque;
+
+typedef struct ConcurrentDeque ConcurrentDeque;
+
+Deque* deque_create(size_t elem_size);
+
+int deque_push_back(Deque* deque, const void* elem);
+
+int deque_push_front(Deque* deque, const void* elem);
+
+int deque_pop_back(Deque* deque, void* elem);
+
+int deque_pop_front(Deque* deque, void* elem);
+
+void* deque_at(Deque* deque, size_t index);
+
+size_t deque_size(Deque* deque);
+
+void deque_destroy(Deque* deque);
+
+ConcurrentDeque* cdeque_create(size_t elem_size);
+
+int cdeque_push_back(ConcurrentDeque* deque, const void* elem);
+
+int cdeque_push_front(ConcurrentDeque* deque, const void* elem);
+
+int cdeque_pop_back(ConcurrentDeque* deque, void* elem);
+
+int cdeque_pop_front(ConcurrentDeque* deque, void* elem);
+
+size_t cdeque_size(ConcurrentDeque* deque);
+
+void cdeque_destroy(ConcurrentDeque* deque);
+
+#endif
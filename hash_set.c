@@ -0,0 +1,206 @@
+#include "hash_set.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Samtidig hashmängd med låsstripning: mängden delas i segment, vart och ett en egen
+// öppet adresserad tabell med eget läs/skrivlås. Segmentet väljs av hashens höga bitar
+// och sloten av de låga, så trådar som arbetar på olika nycklar hamnar oftast i olika segment.
+// contains tar bara läslåset och går parallellt med andra läsare i samma segment.
+// Varje segment växer för sig under sitt eget skrivlås - resten av mängden påverkas inte.
+// Borttagning flyttar tillbaka efterföljande poster (backward shift) så inga gravstenar behövs
+
+#define CACHE_LINE 64
+#define HS_MIN_CAPACITY 16
+#define HS_FULL (1ULL << 32) // Slotmarkering - 0 betyder tom, annars HS_FULL | nyckel
+
+typedef struct {
+    _Alignas(CACHE_LINE) pthread_rwlock_t lock;
+    uint64_t* slots; // Linjär sondering i minnespoolen
+    size_t capacity; // Tvåpotens
+    size_t size;
+} HashSegment;
+
+struct HashSet {
+    HashSegment* segments;
+    size_t num_segments; // Tvåpotens
+    unsigned segment_shift;
+};
+
+// murmur3 fmix64
+static inline uint64_t hs_hash(uint32_t key) {
+    uint64_t h = key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline HashSegment* hs_segment(HashSet* set, uint64_t hash) {
+    return &set->segments[set->segment_shift < 64 ? hash >> set->segment_shift : 0];
+}
+
+// Max lastfaktor 3/4
+static inline int hs_needs_grow(HashSegment* segment) {
+    return (segment->size + 1) * 4 > segment->capacity * 3;
+}
+
+// Returnerar slotindex för nyckeln eller den tomma slot där sökningen slutade
+static size_t hs_find(HashSegment* segment, uint32_t key, uint64_t hash) {
+    size_t mask = segment->capacity - 1;
+    size_t i = hash & mask;
+    while (segment->slots[i] && segment->slots[i] != (HS_FULL | key))
+        i = (i + 1) & mask;
+    return i;
+}
+
+static int hs_alloc_slots(HashSegment* segment, size_t capacity) {
+    uint64_t* slots = (uint64_t*)mem_alloc(capacity * sizeof(uint64_t));
+    if (!slots) {
+        fprintf(stderr, "Error: Could not allocate hash set segment of %zu slots\n", capacity);
+        return -1;
+    }
+    memset(slots, 0, capacity * sizeof(uint64_t));
+
+    uint64_t* old_slots = segment->slots;
+    size_t old_capacity = segment->capacity;
+    segment->slots = slots;
+    segment->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (!old_slots[i]) continue;
+        uint32_t key = (uint32_t)old_slots[i];
+        slots[hs_find(segment, key, hs_hash(key))] = old_slots[i];
+    }
+    if (old_slots) mem_free(old_slots);
+    return 0;
+}
+
+// Skapar num_segments segment (avrundas uppåt till en tvåpotens) med plats för
+// capacity nycklar totalt innan något segment behöver växa
+HashSet* hash_set_create(size_t num_segments, size_t capacity) {
+    size_t segments = 1;
+    unsigned bits = 0;
+    while (segments < num_segments) {
+        segments *= 2;
+        bits++;
+    }
+
+    HashSet* set = (HashSet*)malloc(sizeof(HashSet));
+    if (!set) {
+        fprintf(stderr, "Error: Memory allocation failed in hash_set_create.\n");
+        return NULL;
+    }
+    set->segments = (HashSegment*)mem_alloc_aligned(segments * sizeof(HashSegment), CACHE_LINE);
+    if (!set->segments) {
+        fprintf(stderr, "Error: Could not allocate %zu segments from memory pool\n", segments);
+        free(set);
+        return NULL;
+    }
+    set->num_segments = segments;
+    set->segment_shift = 64 - bits; // 64 för ett segment - hanteras i hs_segment
+
+    size_t per_segment = HS_MIN_CAPACITY;
+    while (per_segment * 3 / 4 < capacity / segments) per_segment *= 2;
+
+    for (size_t s = 0; s < segments; s++) {
+        HashSegment* segment = &set->segments[s];
+        pthread_rwlock_init(&segment->lock, NULL);
+        segment->slots = NULL;
+        segment->capacity = 0;
+        segment->size = 0;
+        if (hs_alloc_slots(segment, per_segment) != 0) {
+            set->num_segments = s + 1;
+            hash_set_destroy(set);
+            return NULL;
+        }
+    }
+    return set;
+}
+
+// Lägger till nyckeln
+// Returnerar 1 om den lades till, 0 om den redan fanns, -1 om segmentet inte kunde växa
+int hash_set_insert(HashSet* set, uint32_t key) {
+    uint64_t hash = hs_hash(key);
+    HashSegment* segment = hs_segment(set, hash);
+    pthread_rwlock_wrlock(&segment->lock);
+
+    size_t i = hs_find(segment, key, hash);
+    if (segment->slots[i]) {
+        pthread_rwlock_unlock(&segment->lock);
+        return 0;
+    }
+
+    if (hs_needs_grow(segment)) {
+        if (hs_alloc_slots(segment, segment->capacity * 2) != 0) {
+            pthread_rwlock_unlock(&segment->lock);
+            return -1;
+        }
+        i = hs_find(segment, key, hash);
+    }
+    segment->slots[i] = HS_FULL | key;
+    segment->size++;
+
+    pthread_rwlock_unlock(&segment->lock);
+    return 1;
+}
+
+// Returnerar 1 om nyckeln finns annars 0
+int hash_set_contains(HashSet* set, uint32_t key) {
+    uint64_t hash = hs_hash(key);
+    HashSegment* segment = hs_segment(set, hash);
+    pthread_rwlock_rdlock(&segment->lock);
+    int found = segment->slots[hs_find(segment, key, hash)] != 0;
+    pthread_rwlock_unlock(&segment->lock);
+    return found;
+}
+
+// Tar bort nyckeln, returnerar 1 om den fanns annars 0
+int hash_set_remove(HashSet* set, uint32_t key) {
+    uint64_t hash = hs_hash(key);
+    HashSegment* segment = hs_segment(set, hash);
+    pthread_rwlock_wrlock(&segment->lock);
+
+    size_t mask = segment->capacity - 1;
+    size_t i = hs_find(segment, key, hash);
+    int found = segment->slots[i] != 0;
+    if (found) {
+        // Backward shift: flytta upp poster vars hemslot inte ligger mellan hålet och deras position
+        for (size_t j = (i + 1) & mask; segment->slots[j]; j = (j + 1) & mask) {
+            size_t home = hs_hash((uint32_t)segment->slots[j]) & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                segment->slots[i] = segment->slots[j];
+                i = j;
+            }
+        }
+        segment->slots[i] = 0;
+        segment->size--;
+    }
+
+    pthread_rwlock_unlock(&segment->lock);
+    return found;
+}
+
+// Summerar alla segment - ögonblicksbild utan att låsa allt samtidigt
+size_t hash_set_size(HashSet* set) {
+    size_t size = 0;
+    for (size_t s = 0; s < set->num_segments; s++) {
+        pthread_rwlock_rdlock(&set->segments[s].lock);
+        size += set->segments[s].size;
+        pthread_rwlock_unlock(&set->segments[s].lock);
+    }
+    return size;
+}
+
+void hash_set_destroy(HashSet* set) {
+    if (!set) return;
+    for (size_t s = 0; s < set->num_segments; s++) {
+        pthread_rwlock_destroy(&set->segments[s].lock);
+        if (set->segments[s].slots) mem_free(set->segments[s].slots);
+    }
+    mem_free(set->segments);
+    free(set);
+}
@@ -0,0 +1,21 @@
+#ifndef HASH_SET_H
+#define HASH_SET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct HashSet HashSet;
+
+HashSet* hash_set_create(size_t num_segments, size_t capacity);
+
+int hash_set_insert(HashSet* set, uint32_t key);
+
+int hash_set_contains(HashSet* set, uint32_t key);
+
+int hash_set_remove(HashSet* set, uint32_t key);
+
+size_t hash_set_size(HashSet* set);
+
+void hash_set_destroy(HashSet* set);
+
+#endif
@@ -0,0 +1,279 @@
+#include "hash_table.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Swiss-table: öppen adressering med en kontrollbyte per slot
+// Kontrollbytes söks 16 åt gången (en grupp) med SSE2, nycklar jämförs bara vid träff på 7-bitars hash
+// Ingen intern låsning - anroparen ansvarar för synkronisering (till skillnad från list_mutex)
+
+#define HT_GROUP_WIDTH 16
+#define HT_CTRL_EMPTY ((int8_t)-128) // Slot har aldrig använts
+#define HT_CTRL_DELETED ((int8_t)-2) // Gravsten efter borttagning
+// Fulla slots har 0..127 (de 7 lägsta bitarna av hashen)
+
+typedef struct {
+    uint32_t key;
+    uint32_t value;
+} HashSlot;
+
+struct HashTable {
+    int8_t* ctrl;       // Kontrollbytes, capacity + HT_GROUP_WIDTH (speglade) - början av poolblocket
+    HashSlot* slots;    // Slots ligger direkt efter kontrollbytes i samma poolblock
+    size_t capacity;    // Alltid en tvåpotens >= HT_GROUP_WIDTH
+    size_t size;        // Antal fulla slots
+    size_t growth_left; // Antal EMPTY-slots som får fyllas innan omhashning
+};
+
+// murmur3 fmix64 - sprider nyckelns bitar över hela hashen
+static inline uint64_t ht_hash(uint32_t key) {
+    uint64_t h = key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline size_t ht_h1(uint64_t hash) { return (size_t)(hash >> 7); }
+static inline int8_t ht_h2(uint64_t hash) { return (int8_t)(hash & 0x7f); }
+
+// Max lastfaktor 7/8
+static inline size_t ht_max_load(size_t capacity) { return capacity - capacity / 8; }
+
+static inline size_t ht_alloc_size(size_t capacity) {
+    return capacity + HT_GROUP_WIDTH + capacity * sizeof(HashSlot);
+}
+
+// Bitmask med en bit per byte i gruppen som är lika med h2
+static inline uint32_t ht_match(const int8_t* group, int8_t h2) {
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < HT_GROUP_WIDTH; i++)
+        if (group[i] == h2) mask |= 1u << i;
+    return mask;
+#endif
+}
+
+static inline uint32_t ht_match_empty(const int8_t* group) {
+    return ht_match(group, HT_CTRL_EMPTY);
+}
+
+// EMPTY och DELETED är negativa, fulla slots är >= 0, så teckenbiten räcker
+static inline uint32_t ht_match_empty_or_deleted(const int8_t* group) {
+#ifdef __SSE2__
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < HT_GROUP_WIDTH; i++)
+        if (group[i] < 0) mask |= 1u << i;
+    return mask;
+#endif
+}
+
+// Sätter en kontrollbyte och håller speglingen efter slutet av arrayen uppdaterad
+// så att en grupp kan läsas från vilken position som helst utan wrap-around
+static inline void ht_set_ctrl(HashTable* table, size_t i, int8_t h) {
+    table->ctrl[i] = h;
+    if (i < HT_GROUP_WIDTH - 1) table->ctrl[table->capacity + i] = h;
+}
+
+static void ht_mirror_ctrl(HashTable* table) {
+    memcpy(table->ctrl + table->capacity, table->ctrl, HT_GROUP_WIDTH - 1);
+    table->ctrl[table->capacity + HT_GROUP_WIDTH - 1] = HT_CTRL_EMPTY;
+}
+
+// Triangulär sondering i steg om en grupp - besöker alla grupper när capacity är en tvåpotens
+static size_t ht_find_first_non_full(HashTable* table, uint64_t hash) {
+    size_t mask = table->capacity - 1;
+    size_t pos = ht_h1(hash) & mask;
+    size_t step = 0;
+    for (;;) {
+        uint32_t m = ht_match_empty_or_deleted(table->ctrl + pos);
+        if (m) return (pos + __builtin_ctz(m)) & mask;
+        step += HT_GROUP_WIDTH;
+        pos = (pos + step) & mask;
+    }
+}
+
+// Returnerar slotindex för nyckeln eller capacity om den saknas
+static size_t ht_find(HashTable* table, uint32_t key, uint64_t hash) {
+    size_t mask = table->capacity - 1;
+    size_t pos = ht_h1(hash) & mask;
+    size_t step = 0;
+    int8_t h2 = ht_h2(hash);
+    for (;;) {
+        const int8_t* group = table->ctrl + pos;
+        uint32_t m = ht_match(group, h2);
+        while (m) {
+            size_t i = (pos + __builtin_ctz(m)) & mask;
+            if (table->slots[i].key == key) return i;
+            m &= m - 1;
+        }
+        // En EMPTY i gruppen betyder att sonderingssekvensen tar slut här
+        if (ht_match_empty(group)) return table->capacity;
+        step += HT_GROUP_WIDTH;
+        pos = (pos + step) & mask;
+    }
+}
+
+// Omhashning på plats: alla element som ska flyttas är markerade DELETED, övriga slots EMPTY
+// Varje element hamnar antingen kvar (samma sonderingsgrupp), flyttas till en EMPTY slot
+// eller byter plats med ett annat element som ännu inte är omhashat
+static void ht_rehash_in_place(HashTable* table) {
+    size_t mask = table->capacity - 1;
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->ctrl[i] != HT_CTRL_DELETED) continue;
+        for (;;) {
+            uint64_t hash = ht_hash(table->slots[i].key);
+            size_t target = ht_find_first_non_full(table, hash);
+            size_t probe_start = ht_h1(hash) & mask;
+
+            if (((target - probe_start) & mask) / HT_GROUP_WIDTH == ((i - probe_start) & mask) / HT_GROUP_WIDTH) {
+                ht_set_ctrl(table, i, ht_h2(hash)); // Redan i rätt grupp
+                break;
+            }
+            if (table->ctrl[target] == HT_CTRL_EMPTY) {
+                table->slots[target] = table->slots[i];
+                ht_set_ctrl(table, target, ht_h2(hash));
+                ht_set_ctrl(table, i, HT_CTRL_EMPTY);
+                break;
+            }
+            // target väntar själv på omhashning - byt och fortsätt med det utbytta elementet
+            HashSlot tmp = table->slots[target];
+            table->slots[target] = table->slots[i];
+            table->slots[i] = tmp;
+            ht_set_ctrl(table, target, ht_h2(hash));
+        }
+    }
+    table->growth_left = ht_max_load(table->capacity) - table->size;
+}
+
+// Gör plats för fler element
+// Består tabellen mest av gravstenar omhashas den på plats, annars dubblas den med mem_resize
+// mem_resize kan växa blocket på plats när grannblocket är ledigt, annars flyttas innehållet
+static int ht_grow(HashTable* table) {
+    size_t old_cap = table->capacity;
+
+    if (table->size <= old_cap * 7 / 16) {
+        // FULL -> DELETED (ska omhashas), DELETED -> EMPTY (gravstenar försvinner)
+        for (size_t i = 0; i < old_cap; i++)
+            table->ctrl[i] = table->ctrl[i] >= 0 ? HT_CTRL_DELETED : HT_CTRL_EMPTY;
+        ht_mirror_ctrl(table);
+        ht_rehash_in_place(table);
+        return 0;
+    }
+
+    size_t new_cap = old_cap * 2;
+    char* block = (char*)mem_resize(table->ctrl, ht_alloc_size(new_cap));
+    if (!block) {
+        fprintf(stderr, "Error: Could not grow hash table to %zu slots\n", new_cap);
+        return -1; // Gamla blocket är orört vid fel
+    }
+
+    // Slots flyttas upp förbi den större kontrollarrayen (överlappar, därav memmove)
+    memmove(block + new_cap + HT_GROUP_WIDTH, block + old_cap + HT_GROUP_WIDTH, old_cap * sizeof(HashSlot));
+
+    table->ctrl = (int8_t*)block;
+    table->slots = (HashSlot*)(block + new_cap + HT_GROUP_WIDTH);
+    table->capacity = new_cap;
+
+    for (size_t i = 0; i < old_cap; i++)
+        table->ctrl[i] = table->ctrl[i] >= 0 ? HT_CTRL_DELETED : HT_CTRL_EMPTY;
+    memset(table->ctrl + old_cap, (uint8_t)HT_CTRL_EMPTY, new_cap - old_cap);
+    ht_mirror_ctrl(table);
+    ht_rehash_in_place(table);
+    return 0;
+}
+
+// Skapar en tabell med plats för minst capacity element utan omhashning
+// Kontrollbytes och slots allokeras som ett enda block ur minnespoolen
+HashTable* hash_table_create(size_t capacity) {
+    size_t cap = HT_GROUP_WIDTH;
+    while (ht_max_load(cap) < capacity) cap *= 2;
+
+    HashTable* table = (HashTable*)malloc(sizeof(HashTable));
+    if (!table) {
+        fprintf(stderr, "Error: Memory allocation failed in hash_table_create.\n");
+        return NULL;
+    }
+
+    char* block = (char*)mem_alloc(ht_alloc_size(cap));
+    if (!block) {
+        fprintf(stderr, "Error: Could not allocate %zu slots from memory pool\n", cap);
+        free(table);
+        return NULL;
+    }
+
+    table->ctrl = (int8_t*)block;
+    table->slots = (HashSlot*)(block + cap + HT_GROUP_WIDTH);
+    table->capacity = cap;
+    table->size = 0;
+    table->growth_left = ht_max_load(cap);
+    memset(table->ctrl, (uint8_t)HT_CTRL_EMPTY, cap + HT_GROUP_WIDTH);
+    return table;
+}
+
+// Lägger till eller uppdaterar en nyckel
+// Returnerar 0 vid lyckad insättning, -1 om tabellen inte kunde växa
+int hash_table_insert(HashTable* table, uint32_t key, uint32_t value) {
+    uint64_t hash = ht_hash(key);
+
+    size_t i = ht_find(table, key, hash);
+    if (i != table->capacity) {
+        table->slots[i].value = value; // Befintlig nyckel - uppdatera värdet
+        return 0;
+    }
+
+    size_t target = ht_find_first_non_full(table, hash);
+    // En gravsten kan återanvändas utan att lastfaktorn ökar
+    if (table->growth_left == 0 && table->ctrl[target] != HT_CTRL_DELETED) {
+        if (ht_grow(table) != 0) return -1;
+        target = ht_find_first_non_full(table, hash);
+    }
+
+    if (table->ctrl[target] == HT_CTRL_EMPTY) table->growth_left--;
+    table->slots[target].key = key;
+    table->slots[target].value = value;
+    ht_set_ctrl(table, target, ht_h2(hash));
+    table->size++;
+    return 0;
+}
+
+// Slår upp en nyckel, returnerar 1 och skriver värdet om den finns, annars 0
+int hash_table_get(HashTable* table, uint32_t key, uint32_t* value) {
+    size_t i = ht_find(table, key, ht_hash(key));
+    if (i == table->capacity) return 0;
+    if (value) *value = table->slots[i].value;
+    return 1;
+}
+
+// Tar bort en nyckel, returnerar 1 om den fanns, annars 0
+// Slotten blir en gravsten så att andra nycklars sonderingssekvenser inte bryts
+int hash_table_remove(HashTable* table, uint32_t key) {
+    size_t i = ht_find(table, key, ht_hash(key));
+    if (i == table->capacity) return 0;
+    ht_set_ctrl(table, i, HT_CTRL_DELETED);
+    table->size--;
+    return 1;
+}
+
+size_t hash_table_size(HashTable* table) {
+    return table->size;
+}
+
+// Lämnar tillbaka tabellens block till minnespoolen
+void hash_table_destroy(HashTable* table) {
+    if (!table) return;
+    mem_free(table->ctrl);
+    free(table);
+}
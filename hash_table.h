@@ -0,0 +1,21 @@
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct HashTable HashTable;
+
+HashTable* hash_table_create(size_t capacity);
+
+int hash_table_insert(HashTable* table, uint32_t key, uint32_t value);
+
+int hash_table_get(HashTable* table, uint32_t key, uint32_t* value);
+
+int hash_table_remove(HashTable* table, uint32_t key);
+
+size_t hash_table_size(HashTable* table);
+
+void hash_table_destroy(HashTable* table);
+
+#endif
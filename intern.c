@@ -0,0 +1,167 @@
+#include "intern.h"
+#include "vec.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Internering av strängar: varje unik sträng lagras en gång i en växande byte-arena
+// och får ett stabilt 32-bitars ID (0, 1, 2, ...). Jämförelser blir heltalsjämförelser.
+// Arena, metadata och hashindex ligger i minnespoolen - ingen allokering per sträng.
+// Ingen intern låsning - anroparen ansvarar för synkronisering
+
+#define INTERN_MIN_INDEX 16
+
+typedef struct {
+    uint32_t offset; // Position i arenan
+    uint32_t length; // Längd utan avslutande NUL
+    uint32_t hash;
+} InternEntry;
+
+struct StringPool {
+    Vec arena;        // Bytes, varje sträng avslutas med NUL så att intern_get kan ge en C-sträng
+    Vec entries;      // InternEntry per ID
+    uint32_t* index;  // Öppen adressering med linjär sondering, 0 = tom annars ID + 1
+    size_t index_capacity;
+};
+
+// FNV-1a
+static uint32_t intern_hash(const char* str, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int intern_alloc_index(StringPool* pool, size_t capacity) {
+    uint32_t* index = (uint32_t*)mem_alloc(capacity * sizeof(uint32_t));
+    if (!index) {
+        fprintf(stderr, "Error: Could not allocate intern index of %zu slots\n", capacity);
+        return -1;
+    }
+    memset(index, 0, capacity * sizeof(uint32_t));
+
+    // Lägg tillbaka alla befintliga ID:n - hashen är sparad så strängarna behöver inte läsas
+    size_t mask = capacity - 1;
+    for (size_t id = 0; id < pool->entries.len; id++) {
+        size_t pos = VEC_AT(&pool->entries, InternEntry, id).hash & mask;
+        while (index[pos]) pos = (pos + 1) & mask;
+        index[pos] = (uint32_t)id + 1;
+    }
+
+    if (pool->index) mem_free(pool->index);
+    pool->index = index;
+    pool->index_capacity = capacity;
+    return 0;
+}
+
+// Skapar en tom strängpool med plats för capacity strängar innan indexet växer
+StringPool* intern_create(size_t capacity) {
+    StringPool* pool = (StringPool*)calloc(1, sizeof(StringPool)); // Nollad så att intern_destroy fungerar vid fel
+    if (!pool) {
+        fprintf(stderr, "Error: Memory allocation failed in intern_create.\n");
+        return NULL;
+    }
+
+    size_t index_capacity = INTERN_MIN_INDEX;
+    while (index_capacity / 2 < capacity) index_capacity *= 2; // Max lastfaktor 1/2
+
+    if (vec_init(&pool->arena, 1, capacity * 8) != 0 ||
+        vec_init(&pool->entries, sizeof(InternEntry), capacity) != 0 ||
+        intern_alloc_index(pool, index_capacity) != 0) {
+        intern_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+// Letar upp slotten för strängen i indexet
+// Returnerar slotindex - antingen strängens slot eller den tomma slot där den skulle läggas in
+static size_t intern_probe(StringPool* pool, const char* str, size_t len, uint32_t hash) {
+    size_t mask = pool->index_capacity - 1;
+    size_t pos = hash & mask;
+    while (pool->index[pos]) {
+        InternEntry* entry = &VEC_AT(&pool->entries, InternEntry, pool->index[pos] - 1);
+        // Hash och längd först - memcmp bara vid trolig träff
+        if (entry->hash == hash && entry->length == len &&
+            memcmp((char*)pool->arena.data + entry->offset, str, len) == 0)
+            return pos;
+        pos = (pos + 1) & mask;
+    }
+    return pos;
+}
+
+// Returnerar ID för strängen om den redan är internerad, annars INTERN_INVALID_ID
+uint32_t intern_find(StringPool* pool, const char* str, size_t len) {
+    size_t pos = intern_probe(pool, str, len, intern_hash(str, len));
+    return pool->index[pos] ? pool->index[pos] - 1 : INTERN_INVALID_ID;
+}
+
+// Internerar len bytes (får innehålla NUL) och returnerar strängens ID
+// Samma innehåll ger alltid samma ID, returnerar INTERN_INVALID_ID om poolen inte kunde växa
+uint32_t intern_string_n(StringPool* pool, const char* str, size_t len) {
+    uint32_t hash = intern_hash(str, len);
+    size_t pos = intern_probe(pool, str, len, hash);
+    if (pool->index[pos]) return pool->index[pos] - 1;
+
+    if (pool->entries.len + 1 >= INTERN_INVALID_ID || pool->arena.len + len + 1 > UINT32_MAX) {
+        fprintf(stderr, "Error: String pool is full\n");
+        return INTERN_INVALID_ID;
+    }
+
+    // Indexet växer innan lastfaktorn passerar 1/2
+    if ((pool->entries.len + 1) * 2 > pool->index_capacity) {
+        if (intern_alloc_index(pool, pool->index_capacity * 2) != 0) return INTERN_INVALID_ID;
+        pos = intern_probe(pool, str, len, hash);
+    }
+
+    // Strängen läggs till sist i arenan - befintliga offset påverkas inte om arenan flyttas
+    // str kan peka in i arenan själv (från intern_get), så offset räknas ut innan arenan växer
+    size_t source = (size_t)-1;
+    if (pool->arena.data && str >= (char*)pool->arena.data && str < (char*)pool->arena.data + pool->arena.len)
+        source = str - (char*)pool->arena.data;
+    if (vec_reserve(&pool->arena, pool->arena.len + len + 1) != 0) return INTERN_INVALID_ID;
+    if (source != (size_t)-1) str = (char*)pool->arena.data + source;
+
+    InternEntry entry = {.offset = (uint32_t)pool->arena.len, .length = (uint32_t)len, .hash = hash};
+    if (vec_push(&pool->entries, &entry) != 0) return INTERN_INVALID_ID;
+
+    memcpy((char*)pool->arena.data + pool->arena.len, str, len);
+    ((char*)pool->arena.data)[pool->arena.len + len] = '\0';
+    pool->arena.len += len + 1;
+
+    uint32_t id = (uint32_t)pool->entries.len - 1;
+    pool->index[pos] = id + 1;
+    return id;
+}
+
+uint32_t intern_string(StringPool* pool, const char* str) {
+    return intern_string_n(pool, str, strlen(str));
+}
+
+// Returnerar den internerade strängen eller NULL för okänt ID
+// Pekaren är giltig tills nästa sträng interneras (arenan kan flyttas när den växer)
+const char* intern_get(StringPool* pool, uint32_t id) {
+    if (id >= pool->entries.len) return NULL;
+    return (char*)pool->arena.data + VEC_AT(&pool->entries, InternEntry, id).offset;
+}
+
+size_t intern_length(StringPool* pool, uint32_t id) {
+    if (id >= pool->entries.len) return 0;
+    return VEC_AT(&pool->entries, InternEntry, id).length;
+}
+
+size_t intern_count(StringPool* pool) {
+    return pool->entries.len;
+}
+
+// Lämnar tillbaka arena, metadata och index till minnespoolen
+void intern_destroy(StringPool* pool) {
+    if (!pool) return;
+    vec_destroy(&pool->arena);
+    vec_destroy(&pool->entries);
+    if (pool->index) mem_free(pool->index);
+    free(pool);
+}
@@ -0,0 +1,27 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define INTERN_INVALID_ID UINT32_MAX
+
+typedef struct StringPool StringPool;
+
+StringPool* intern_create(size_t capacity);
+
+uint32_t intern_string(StringPool* pool, const char* str);
+
+uint32_t intern_string_n(StringPool* pool, const char* str, size_t len);
+
+uint32_t intern_find(StringPool* pool, const char* str, size_t len);
+
+const char* intern_get(StringPool* pool, uint32_t id);
+
+size_t intern_length(StringPool* pool, uint32_t id);
+
+size_t intern_count(StringPool* pool);
+
+void intern_destroy(StringPool* pool);
+
+#endif
@@ -2,6 +2,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // coarse-grained locking
 // 1 mutex för alla minnesoperationer
@@ -283,3 +289,245 @@ void list_cleanup(Node** head) {
     
     pthread_mutex_unlock(&list_mutex); // Kritisk sektion slut - cleanup klar
 }
+
+
+// ********* Mängdoperationer mellan listor *********
+// Resultatet är en ny lista med unika värden i stigande ordning, frigörs med list_cleanup
+// result skrivs över och får inte vara någon av indatalistorna
+// Tidigare krävde snittet n anrop till list_search, alltså O(n²)
+// Båda listorna sorterade: merge-join i en passering, O(n + m)
+// Annars: varje lista blir en bitmängd med 65536 bitar (en per möjligt uint16_t-värde)
+// som kombineras ord för ord med SIMD, O(n + m + 1024)
+// Låset tas en gång för hela operationen så att båda listorna läses konsekvent
+
+#define LIST_SET_WORDS (65536 / 64)
+
+typedef enum { LIST_SET_INTERSECT, LIST_SET_UNION, LIST_SET_DIFFERENCE } ListSetOp;
+
+static int list_is_sorted(Node* head) {
+    for (; head && head->next; head = head->next)
+        if (head->data > head->next->data) return 0;
+    return 1;
+}
+
+// Lägger till en nod sist i resultatet via en svanspekare, hoppar över dubbletter
+// Resultatet byggs i stigande ordning så en dubblett är alltid lika med sista noden
+static int list_append_unique(Node*** tail, Node** last, uint16_t data) {
+    if (*last && (*last)->data == data) return 0;
+    Node* new_node = (Node*)malloc(sizeof(Node));
+    if (!new_node) {
+        fprintf(stderr, "Error: Memory allocation failed in list set operation.\n");
+        return -1;
+    }
+    new_node->data = data;
+    new_node->next = NULL;
+    **tail = new_node;
+    *tail = &new_node->next;
+    *last = new_node;
+    return 0;
+}
+
+static int list_merge_join(Node* a, Node* b, ListSetOp op, Node** result) {
+    Node** tail = result;
+    Node* last = NULL;
+    while (a || b) {
+        if (!b || (a && a->data < b->data)) {
+            // Värdet finns bara i a
+            if (op != LIST_SET_INTERSECT && list_append_unique(&tail, &last, a->data) != 0) return -1;
+            a = a->next;
+        } else if (!a || b->data < a->data) {
+            // Värdet finns bara i b
+            if (op == LIST_SET_UNION && list_append_unique(&tail, &last, b->data) != 0) return -1;
+            b = b->next;
+        } else {
+            // Värdet finns i båda - hoppa över alla förekomster så att dubbletter i a inte räknas som bara i a
+            uint16_t value = a->data;
+            if (op != LIST_SET_DIFFERENCE && list_append_unique(&tail, &last, value) != 0) return -1;
+            while (a && a->data == value) a = a->next;
+            while (b && b->data == value) b = b->next;
+        }
+        if (!a && op != LIST_SET_UNION) break; // Inget mer kan hamna i resultatet
+        if (!b && op == LIST_SET_INTERSECT) break;
+    }
+    return 0;
+}
+
+static void list_fill_bitset(Node* head, uint64_t* bits) {
+    for (; head; head = head->next)
+        bits[head->data >> 6] |= 1ULL << (head->data & 63);
+}
+
+// Kombinerar bitmängderna, resultatet skrivs till a
+#if defined(__x86_64__) || defined(__i386__)
+// AVX2 finns inte i CFLAGS, funktionen kompileras separat och väljs vid körning
+__attribute__((target("avx2")))
+static void list_combine_avx2(uint64_t* a, const uint64_t* b, ListSetOp op) {
+    for (size_t i = 0; i < LIST_SET_WORDS; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i r = op == LIST_SET_INTERSECT ? _mm256_and_si256(x, y)
+                  : op == LIST_SET_UNION     ? _mm256_or_si256(x, y)
+                                             : _mm256_andnot_si256(y, x);
+        _mm256_storeu_si256((__m256i*)(a + i), r);
+    }
+}
+#endif
+
+static void list_combine(uint64_t* a, const uint64_t* b, ListSetOp op) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        list_combine_avx2(a, b, op);
+        return;
+    }
+#endif
+#ifdef __SSE2__
+    for (size_t i = 0; i < LIST_SET_WORDS; i += 2) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i r = op == LIST_SET_INTERSECT ? _mm_and_si128(x, y)
+                  : op == LIST_SET_UNION     ? _mm_or_si128(x, y)
+                                             : _mm_andnot_si128(y, x);
+        _mm_storeu_si128((__m128i*)(a + i), r);
+    }
+#else
+    // Skalär reserv
+    for (size_t i = 0; i < LIST_SET_WORDS; i++)
+        a[i] = op == LIST_SET_INTERSECT ? a[i] & b[i] : op == LIST_SET_UNION ? a[i] | b[i] : a[i] & ~b[i];
+#endif
+}
+
+static int list_bitset_op(Node* a, Node* b, ListSetOp op, Node** result) {
+    uint64_t* bits = (uint64_t*)calloc(2 * LIST_SET_WORDS, sizeof(uint64_t));
+    if (!bits) {
+        fprintf(stderr, "Error: Memory allocation failed in list set operation.\n");
+        return -1;
+    }
+    list_fill_bitset(a, bits);
+    list_fill_bitset(b, bits + LIST_SET_WORDS);
+    list_combine(bits, bits + LIST_SET_WORDS, op);
+
+    // Satta bitar i stigande ordning ger en sorterad lista utan dubbletter
+    Node** tail = result;
+    Node* last = NULL;
+    int status = 0;
+    for (size_t i = 0; i < LIST_SET_WORDS && status == 0; i++) {
+        for (uint64_t word = bits[i]; word && status == 0; word &= word - 1)
+            status = list_append_unique(&tail, &last, (uint16_t)(i * 64 + __builtin_ctzll(word)));
+    }
+    free(bits);
+    return status;
+}
+
+static void list_set_operation(Node** head_a, Node** head_b, Node** result, ListSetOp op) {
+    pthread_mutex_lock(&list_mutex); // Kritisk sektion börjar - båda listorna läses under samma lås
+
+    *result = NULL;
+    int status = list_is_sorted(*head_a) && list_is_sorted(*head_b)
+                     ? list_merge_join(*head_a, *head_b, op, result)
+                     : list_bitset_op(*head_a, *head_b, op, result);
+
+    // Vid fel frigörs det som hunnit byggas så att anroparen får en tom lista
+    if (status != 0) {
+        while (*result) {
+            Node* current = *result;
+            *result = current->next;
+            free(current);
+        }
+    }
+
+    pthread_mutex_unlock(&list_mutex); // Kritisk sektion slut
+}
+
+// Värden som finns i båda listorna
+void list_intersect(Node** head_a, Node** head_b, Node** result) {
+    list_set_operation(head_a, head_b, result, LIST_SET_INTERSECT);
+}
+
+// Värden som finns i minst en av listorna
+void list_union(Node** head_a, Node** head_b, Node** result) {
+    list_set_operation(head_a, head_b, result, LIST_SET_UNION);
+}
+
+// Värden som finns i a men inte i b
+void list_difference(Node** head_a, Node** head_b, Node** result) {
+    list_set_operation(head_a, head_b, result, LIST_SET_DIFFERENCE);
+}
+
+// Utför en sekvens operationer i ordning
+// Svanspekaren och längden räknas ut en gång och hålls uppdaterade, så en batch med
+// insättningar kostar en traversering totalt istället för en per list_insert
+// results[i] (om inte NULL): insert 0 eller -1 vid minnesfel, delete/search 1 om värdet fanns
+// annars 0, count antal noder
+static void list_apply_ops(Node** head, const ListOp* ops, size_t count, int* results) {
+    Node* tail = NULL; // Sista noden, NULL tills den behövs
+    int length = -1;   // Antal noder, -1 tills det behövs
+
+    for (size_t i = 0; i < count; i++) {
+        int result = 0;
+        switch (ops[i].type) {
+        case LIST_OP_INSERT: {
+            Node* new_node = (Node*)malloc(sizeof(Node));
+            if (!new_node) {
+                fprintf(stderr, "Error: Memory allocation failed in list_apply_batch.\n");
+                result = -1;
+                break;
+            }
+            new_node->data = ops[i].data;
+            new_node->next = NULL;
+            if (!tail && *head)
+                for (tail = *head; tail->next; tail = tail->next) /* Går till slutet en gång */ ;
+            if (tail) tail->next = new_node;
+            else *head = new_node;
+            tail = new_node;
+            if (length >= 0) length++;
+            break;
+        }
+        case LIST_OP_DELETE: {
+            Node* prev = NULL;
+            Node* current = *head;
+            while (current && current->data != ops[i].data) {
+                prev = current;
+                current = current->next;
+            }
+            if (current) {
+                if (prev) prev->next = current->next;
+                else *head = current->next;
+                if (current == tail) tail = prev;
+                free(current);
+                if (length >= 0) length--;
+                result = 1;
+            }
+            break;
+        }
+        case LIST_OP_SEARCH:
+            for (Node* current = *head; current; current = current->next) {
+                if (current->data == ops[i].data) {
+                    result = 1;
+                    break;
+                }
+            }
+            break;
+        case LIST_OP_COUNT:
+            if (length < 0) {
+                length = 0;
+                for (Node* current = *head; current; current = current->next) length++;
+            }
+            result = length;
+            break;
+        }
+        if (results) results[i] = result;
+    }
+}
+
+// Som list_apply_ops under ett enda låstagande
+void list_apply_batch(Node** head, const ListOp* ops, size_t count, int* results) {
+    pthread_mutex_lock(&list_mutex); // Kritisk sektion börjar - hela batchen är atomisk
+    list_apply_ops(head, ops, count, results);
+    pthread_mutex_unlock(&list_mutex); // Kritisk sektion slut
+}
+
+// Som list_apply_batch utan list_mutex, för en lista som bara anroparen når
+// (t.ex. listan en exekutortråd äger ensam)
+void list_apply_batch_owned(Node** head, const ListOp* ops, size_t count, int* results) {
+    list_apply_ops(head, ops, count, results);
+}
@@ -11,6 +11,13 @@ typedef struct Node {
 } Node;
 
 
+typedef enum { LIST_OP_INSERT, LIST_OP_DELETE, LIST_OP_SEARCH, LIST_OP_COUNT } ListOpType;
+
+typedef struct ListOp {
+    ListOpType type;
+    uint16_t data;
+} ListOp;
+
 extern pthread_mutex_t list_mutex;
 
 void list_init(Node** head, size_t size);
@@ -33,4 +40,14 @@ int list_count_nodes(Node** head);
 
 void list_cleanup(Node** head);
 
+void list_intersect(Node** head_a, Node** head_b, Node** result);
+
+void list_union(Node** head_a, Node** head_b, Node** result);
+
+void list_difference(Node** head_a, Node** head_b, Node** result);
+
+void list_apply_batch(Node** head, const ListOp* ops, size_t count, int* results);
+
+void list_apply_batch_owned(Node** head, const ListOp* ops, size_t count, int* results);
+
 #endif
@@ -0,0 +1,211 @@
+#include "lru_cache.h"
+#include "hash_table.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+// LRU-cache: dubbellänkad lista i användningsordning plus hashindex från nyckel till post
+// get, put och utkastning är O(1) - ersätter list_delete + list_insert som kostade två O(n)-traverseringar
+// Posterna ligger i en fast slab per shard i minnespoolen, länkade med index istället för pekare,
+// så ingen allokering sker per element. Lediga poster bildar en fri-lista genom next.
+// Cachen delas i shards efter nyckelns hash, varje shard har eget lås och egen LRU-ordning
+// F: trådar på olika shards blockerar inte varandra, N: utkastningen är bara LRU inom varje shard
+
+#define CACHE_LINE 64
+#define LRU_NIL UINT32_MAX
+
+typedef struct {
+    uint32_t key;
+    uint32_t value;
+    uint32_t prev; // Mot nyare poster
+    uint32_t next; // Mot äldre poster, eller nästa lediga post
+} LRUEntry;
+
+typedef struct {
+    _Alignas(CACHE_LINE) pthread_mutex_t lock;
+    LRUEntry* entries; // Slab med capacity poster i minnespoolen
+    HashTable* index;  // Nyckel -> postindex
+    uint32_t head;     // Senast använd
+    uint32_t tail;     // Minst nyligen använd - kastas ut först
+    uint32_t free;     // Fri-lista
+    size_t size;
+    size_t capacity;
+} LRUShard;
+
+struct LRUCache {
+    LRUShard* shards;
+    size_t num_shards;
+};
+
+// Fibonacci-hashning - annan spridning än hashtabellens fmix64 så shard och slot blir oberoende
+static inline LRUShard* lru_shard(LRUCache* cache, uint32_t key) {
+    return &cache->shards[((uint64_t)(key * 2654435769u) * cache->num_shards) >> 32];
+}
+
+static inline void lru_unlink(LRUShard* shard, uint32_t i) {
+    LRUEntry* entry = &shard->entries[i];
+    if (entry->prev != LRU_NIL) shard->entries[entry->prev].next = entry->next;
+    else shard->head = entry->next;
+    if (entry->next != LRU_NIL) shard->entries[entry->next].prev = entry->prev;
+    else shard->tail = entry->prev;
+}
+
+static inline void lru_push_front(LRUShard* shard, uint32_t i) {
+    LRUEntry* entry = &shard->entries[i];
+    entry->prev = LRU_NIL;
+    entry->next = shard->head;
+    if (shard->head != LRU_NIL) shard->entries[shard->head].prev = i;
+    else shard->tail = i;
+    shard->head = i;
+}
+
+// Skapar en cache för capacity element fördelade på num_shards shards
+// En shard ger exakt LRU-ordning, fler shards ger parallellism
+LRUCache* lru_create(size_t capacity, size_t num_shards) {
+    if (num_shards == 0) num_shards = 1;
+    if (capacity < num_shards) capacity = num_shards;
+
+    LRUCache* cache = (LRUCache*)malloc(sizeof(LRUCache));
+    if (!cache) {
+        fprintf(stderr, "Error: Memory allocation failed in lru_create.\n");
+        return NULL;
+    }
+
+    cache->shards = (LRUShard*)mem_alloc_aligned(num_shards * sizeof(LRUShard), CACHE_LINE);
+    if (!cache->shards) {
+        fprintf(stderr, "Error: Could not allocate %zu shards from memory pool\n", num_shards);
+        free(cache);
+        return NULL;
+    }
+    cache->num_shards = num_shards;
+
+    for (size_t s = 0; s < num_shards; s++) {
+        LRUShard* shard = &cache->shards[s];
+        pthread_mutex_init(&shard->lock, NULL);
+        // Resten av kapaciteten sprids på de första shardsen
+        shard->capacity = capacity / num_shards + (s < capacity % num_shards);
+        shard->head = shard->tail = LRU_NIL;
+        shard->size = 0;
+        shard->entries = (LRUEntry*)mem_alloc(shard->capacity * sizeof(LRUEntry));
+        shard->index = shard->entries ? hash_table_create(shard->capacity) : NULL;
+        if (!shard->index) {
+            fprintf(stderr, "Error: Could not allocate LRU shard storage from memory pool\n");
+            cache->num_shards = s + 1;
+            lru_destroy(cache);
+            return NULL;
+        }
+        // Alla poster börjar i fri-listan
+        for (size_t i = 0; i < shard->capacity; i++)
+            shard->entries[i].next = i + 1 < shard->capacity ? (uint32_t)(i + 1) : LRU_NIL;
+        shard->free = 0;
+    }
+    return cache;
+}
+
+// Returnerar 1 och värdet om nyckeln finns (posten blir senast använd), annars 0
+int lru_get(LRUCache* cache, uint32_t key, uint32_t* value) {
+    LRUShard* shard = lru_shard(cache, key);
+    pthread_mutex_lock(&shard->lock);
+
+    uint32_t i;
+    int found = hash_table_get(shard->index, key, &i);
+    if (found) {
+        if (shard->head != i) {
+            lru_unlink(shard, i);
+            lru_push_front(shard, i);
+        }
+        if (value) *value = shard->entries[i].value;
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+    return found;
+}
+
+// Lägger in eller uppdaterar nyckeln som senast använd
+// Är sharden full kastas den minst nyligen använda posten ut och återanvänds
+// Returnerar 0 eller -1 om indexet inte kunde växa
+int lru_put(LRUCache* cache, uint32_t key, uint32_t value) {
+    LRUShard* shard = lru_shard(cache, key);
+    pthread_mutex_lock(&shard->lock);
+
+    uint32_t i;
+    if (hash_table_get(shard->index, key, &i)) {
+        // Fall 1: Nyckeln finns - uppdatera och flytta först
+        shard->entries[i].value = value;
+        if (shard->head != i) {
+            lru_unlink(shard, i);
+            lru_push_front(shard, i);
+        }
+        pthread_mutex_unlock(&shard->lock);
+        return 0;
+    }
+
+    if (shard->free != LRU_NIL) {
+        // Fall 2: Ledig post i slaben
+        i = shard->free;
+        shard->free = shard->entries[i].next;
+        shard->size++;
+    } else {
+        // Fall 3: Full - kasta ut svansen och återanvänd posten
+        i = shard->tail;
+        lru_unlink(shard, i);
+        hash_table_remove(shard->index, shard->entries[i].key);
+    }
+
+    if (hash_table_insert(shard->index, key, i) != 0) {
+        shard->entries[i].next = shard->free;
+        shard->free = i;
+        shard->size--;
+        pthread_mutex_unlock(&shard->lock);
+        return -1;
+    }
+    shard->entries[i].key = key;
+    shard->entries[i].value = value;
+    lru_push_front(shard, i);
+
+    pthread_mutex_unlock(&shard->lock);
+    return 0;
+}
+
+// Tar bort nyckeln, returnerar 1 om den fanns annars 0
+int lru_remove(LRUCache* cache, uint32_t key) {
+    LRUShard* shard = lru_shard(cache, key);
+    pthread_mutex_lock(&shard->lock);
+
+    uint32_t i;
+    int found = hash_table_get(shard->index, key, &i);
+    if (found) {
+        hash_table_remove(shard->index, key);
+        lru_unlink(shard, i);
+        shard->entries[i].next = shard->free;
+        shard->free = i;
+        shard->size--;
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+    return found;
+}
+
+// Summerar alla shards - ögonblicksbild utan att låsa allt samtidigt
+size_t lru_size(LRUCache* cache) {
+    size_t size = 0;
+    for (size_t s = 0; s < cache->num_shards; s++) {
+        pthread_mutex_lock(&cache->shards[s].lock);
+        size += cache->shards[s].size;
+        pthread_mutex_unlock(&cache->shards[s].lock);
+    }
+    return size;
+}
+
+void lru_destroy(LRUCache* cache) {
+    if (!cache) return;
+    for (size_t s = 0; s < cache->num_shards; s++) {
+        LRUShard* shard = &cache->shards[s];
+        pthread_mutex_destroy(&shard->lock);
+        if (shard->index) hash_table_destroy(shard->index);
+        if (shard->entries) mem_free(shard->entries);
+    }
+    mem_free(cache->shards);
+    free(cache);
+}
@@ -0,0 +1,21 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct LRUCache LRUCache;
+
+LRUCache* lru_create(size_t capacity, size_t num_shards);
+
+int lru_get(LRUCache* cache, uint32_t key, uint32_t* value);
+
+int lru_put(LRUCache* cache, uint32_t key, uint32_t value);
+
+int lru_remove(LRUCache* cache, uint32_t key);
+
+size_t lru_size(LRUCache* cache);
+
+void lru_destroy(LRUCache* cache);
+
+#endif
@@ -2,33 +2,573 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
-// coarse-grained locking
-// 1 mutex för alla minnesoperationer
-// bara en tråd i taget kan modifiera minnesstrukturen
+// Låsning per adressintervall
+// Poolen delas i num_ranges intervall med eget lås, egen blocklista och eget frilistindex
+// Med ett intervall (standard) är det samma coarse-grained låsning som tidigare: 1 mutex för alla minnesoperationer
+
+#define CACHE_LINE 64
+#define MEM_MIN_RANGE_SIZE (64 * 1024) // Mindre intervall än så ger mest spillutrymme vid gränserna
+#define MEM_PAGE_SHIFT 16
+#define MEM_PAGE_SIZE ((size_t)1 << MEM_PAGE_SHIFT) // Sidstorlek i sidindelat läge
+#define MEM_SMALL_MAX 1024                          // Största allokering som tas från en sida
+#define MEM_SIZE_CLASSES 20
+#define MEM_PAGE_SLOTS (MEM_PAGE_SIZE / 16) // Flest block en sida kan ha, i minsta storleksklassen
+#define MEM_SLAB_BLOCKS 256                         // MemBlock-noder per slab
+#define MEM_PREFAULT_CHUNK (1024 * 1024)            // Minsta del av poolen per tråd vid prefault
+#define MEM_SAMPLE_IDLE 4096                        // Avstånd mellan kontroller av sample_rate när samplingen är av
+#define MEM_MAP_SHIFT 12
+#define MEM_MAP_PAGE ((size_t)1 << MEM_MAP_SHIFT)   // Sidstorlek i sidkartan, intervallgränserna ligger på sådana sidgränser
+#define MEM_MAP_LEAF_BITS 9
+#define MEM_MAP_LEAF ((size_t)1 << MEM_MAP_LEAF_BITS) // Sidor per löv i sidkartan
 
 typedef struct MemBlock {
     size_t offset;         // Offset i minnespoolen där detta block börjar
     size_t size;           // Storleken
     int is_free;           // 1 = ledigt, 0 = allokerat
+    size_t span;           // > 0: första delen av en allokering som fortsätter i nästa intervall, span = total storlek
+    int tag;               // Tagg från mem_alloc_tagged för allokerade block, 0 = otaggad
+    int sample_bucket;     // Histogramhink för en samplad allokering
+    uint64_t sampled_at;   // Tidpunkt (ns) då allokeringen samplades, 0 = inte samplad
     struct MemBlock* next; // Pekare till nästa block i listan
+    struct MemBlock* prev; // Föregående block, NULL för det första - coalescing bakåt utan listgenomgång
 } MemBlock;
 
+// Blocknoder allokeras i slabbar i stället för en malloc per nod
+typedef struct MemBlockSlab {
+    struct MemBlockSlab* next;
+    MemBlock blocks[MEM_SLAB_BLOCKS];
+} MemBlockSlab;
+
+// Ett adressintervall [start, end) av poolen. Block korsar aldrig en intervallgräns -
+// en allokering som är större än det lediga utrymmet i ett intervall läggs som flera block (se mem_alloc_spanning)
+typedef struct {
+    _Alignas(CACHE_LINE) pthread_mutex_t lock; // Egen cache-line så att intervallens lås inte delar rad
+    size_t start;
+    size_t end;
+    MemBlock* block_list; // Länkad lista över intervallets block, sorterad på offset
+    size_t block_count;   // Antal noder i block_list
+    MemBlock* spare_blocks; // Lediga noder från slabbarna, länkade via next
+    MemBlockSlab* slabs;
+    int map_broken;       // Ett löv i sidkartan kunde inte allokeras - sökningar går genom block_list
+
+    // Sidbitmapp när MemOptions.page_bitmap är satt: en bit per sida (MEM_MAP_PAGE) som ligger helt i ett ledigt block,
+    // och en sammanfattningsbit per ord i page_bits som inte är noll. NULL = av
+    uint64_t* page_bits;
+    uint64_t* page_summary;
+    size_t page_words;
+
+    // Sidoindex över de lediga blocken i structure-of-arrays-form, sorterat på offset (samma ordning som block_list)
+    // First-fit blir en linjär skanning över free_sizes i stället för pekarjakt genom block_list
+    // F: sammanhängande minne, 4-8 storlekar per SIMD-jämförelse, N: insättning/borttagning flyttar elementen efter
+    // Kapaciteten hålls >= block_count så att en insättning aldrig kan misslyckas mitt i en operation
+    size_t* free_offsets;
+    size_t* free_sizes;
+    MemBlock** free_blocks;
+    size_t free_count;
+    size_t free_capacity;
+    size_t free_bytes;   // Summan av free_sizes
+    size_t largest_free; // Största värdet i free_sizes, räknas om vid publicering om largest_dirty
+    int largest_dirty;
+
+    // Sammanfattning för mem_stats, publiceras med ett seqlock efter varje ändring under intervallets lås
+    // Udda sekvensnummer = skrivning pågår, läsaren försöker igen om numret ändrats under läsningen
+    // F: övervakning och admission control läser utan att ta något lås, N: läsaren kan behöva snurra vid skrivning
+    atomic_uint stats_sequence;
+    atomic_size_t stats_free_bytes;
+    atomic_size_t stats_free_blocks;
+    atomic_size_t stats_largest_free;
+} MemRange;
+
 // Globala variabler för minneshantering
-static char* memory_pool = NULL;    // Pekare till den allokerade minnespoolen
-static size_t pool_size = 0;        // Total storlek på minnespoolen
-static MemBlock* block_list = NULL; // Länkad lista över alla minnesblock
+static char* memory_pool = NULL; // Pekare till den allokerade minnespoolen
+static size_t pool_size = 0;     // Total storlek på minnespoolen
+static MemRange* ranges = NULL;
+static int num_ranges = 0;
+static size_t range_size = 0;    // Storlek på varje intervall, det sista tar även resten
 
-// coarse-grained locking
-// En mutex skyddar hela minneshanteraren för enkelhetens skull
-// F: Enkel att implementera och garanterar fullständig trådsäkerhet, N: bottleneck vid hög samtidighet då bara 1 operation kan göras åt gången
+// Serialiserar mem_init och mem_deinit
+// Vanliga operationer tar bara sitt intervalls lås, operationer som spänner över flera intervall tar alla i stigande ordning
+// F: operationer i olika intervall går parallellt, N: allokeringar större än ett intervall måste låsa hela poolen
 static pthread_mutex_t memory_lock = PTHREAD_MUTEX_INITIALIZER;
 
+// Varje tråd får ett föredraget intervall (round-robin) och letar där först
+static atomic_uint next_thread_range = 0;
+static _Thread_local int thread_range = -1;
+
+static int preferred_range(void) {
+    if (thread_range < 0) thread_range = atomic_fetch_add(&next_thread_range, 1) & INT_MAX;
+    return thread_range % num_ranges;
+}
+
+// Intervallet som äger offset
+static MemRange* range_of(size_t offset) {
+    size_t index = offset / range_size;
+    return &ranges[index < (size_t)num_ranges ? index : (size_t)num_ranges - 1];
+}
+
+// Ser till att indexet rymmer needed lediga block, anropas innan en ny MemBlock skapas
+static int free_index_reserve(MemRange* range, size_t needed) {
+    if (needed <= range->free_capacity) return 0;
+    size_t capacity = range->free_capacity ? range->free_capacity * 2 : 64;
+    while (capacity < needed) capacity *= 2;
+
+    size_t* offsets = (size_t*)realloc(range->free_offsets, capacity * sizeof(size_t));
+    if (!offsets) return -1;
+    range->free_offsets = offsets;
+    size_t* sizes = (size_t*)realloc(range->free_sizes, capacity * sizeof(size_t));
+    if (!sizes) return -1;
+    range->free_sizes = sizes;
+    MemBlock** blocks = (MemBlock**)realloc(range->free_blocks, capacity * sizeof(MemBlock*));
+    if (!blocks) return -1;
+    range->free_blocks = blocks;
+
+    range->free_capacity = capacity;
+    return 0;
+}
+
+// Lägger till en slab med MEM_SLAB_BLOCKS noder i intervallets reserv
+static int block_slab_add(MemRange* range) {
+    MemBlockSlab* slab = (MemBlockSlab*)malloc(sizeof(MemBlockSlab));
+    if (!slab) return -1;
+    slab->next = range->slabs;
+    range->slabs = slab;
+    for (int i = MEM_SLAB_BLOCKS - 1; i >= 0; i--) {
+        slab->blocks[i].next = range->spare_blocks;
+        range->spare_blocks = &slab->blocks[i];
+    }
+    return 0;
+}
+
+// Ny blocknod, NULL om ingen slab kunde allokeras
+static MemBlock* block_new(MemRange* range) {
+    if (!range->spare_blocks && block_slab_add(range) != 0) return NULL;
+    MemBlock* block = range->spare_blocks;
+    range->spare_blocks = block->next;
+    return block;
+}
+
+static void block_delete(MemRange* range, MemBlock* block) {
+    block->next = range->spare_blocks;
+    range->spare_blocks = block;
+}
+
+// Binärsökning: position för första lediga block med offset >= offset
+static size_t free_index_find(MemRange* range, size_t offset) {
+    size_t low = 0, high = range->free_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (range->free_offsets[mid] < offset) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+// Alla ändringar av free_sizes går genom set/insert/remove, som därför håller free_bytes och largest_free aktuella
+static void free_index_set(MemRange* range, size_t pos, MemBlock* block) {
+    range->free_bytes += block->size - range->free_sizes[pos];
+    if (block->size < range->free_sizes[pos] && range->free_sizes[pos] == range->largest_free) range->largest_dirty = 1;
+    if (block->size > range->largest_free) range->largest_free = block->size;
+    range->free_offsets[pos] = block->offset;
+    range->free_sizes[pos] = block->size;
+    range->free_blocks[pos] = block;
+}
+
+static void free_index_insert(MemRange* range, size_t pos, MemBlock* block) {
+    size_t tail = range->free_count - pos;
+    memmove(range->free_offsets + pos + 1, range->free_offsets + pos, tail * sizeof(size_t));
+    memmove(range->free_sizes + pos + 1, range->free_sizes + pos, tail * sizeof(size_t));
+    memmove(range->free_blocks + pos + 1, range->free_blocks + pos, tail * sizeof(MemBlock*));
+    range->free_count++;
+    range->free_sizes[pos] = 0;
+    free_index_set(range, pos, block);
+}
+
+static void free_index_remove(MemRange* range, size_t pos) {
+    range->free_bytes -= range->free_sizes[pos];
+    if (range->free_sizes[pos] == range->largest_free) range->largest_dirty = 1;
+    size_t tail = range->free_count - pos - 1;
+    memmove(range->free_offsets + pos, range->free_offsets + pos + 1, tail * sizeof(size_t));
+    memmove(range->free_sizes + pos, range->free_sizes + pos + 1, tail * sizeof(size_t));
+    memmove(range->free_blocks + pos, range->free_blocks + pos + 1, tail * sizeof(MemBlock*));
+    range->free_count--;
+}
+
+// First-fit över indexet: första position från start vars storlek >= size, free_count om ingen finns
+// size måste vara 1..pool_size så att jämförelsen med tecken fungerar
+#if defined(__x86_64__) || defined(__i386__)
+// AVX2 finns inte i CFLAGS, funktionen kompileras separat och väljs vid körning
+// SSE2 saknar 64-bitars jämförelse så det finns ingen SSE2-variant
+__attribute__((target("avx2")))
+static size_t free_index_scan_avx2(const size_t* sizes, size_t count, size_t start, size_t size) {
+    size_t i = start;
+    __m256i limit = _mm256_set1_epi64x((long long)(size - 1));
+    // 8 storlekar per varv, två jämförelser om 4
+    for (; i + 8 <= count; i += 8) {
+        __m256i a = _mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i*)(sizes + i)), limit);
+        __m256i b = _mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i*)(sizes + i + 4)), limit);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(a)) | (_mm256_movemask_pd(_mm256_castsi256_pd(b)) << 4);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    for (; i < count; i++)
+        if (sizes[i] >= size) return i;
+    return count;
+}
+#endif
+
+static size_t free_index_first_fit(MemRange* range, size_t start, size_t size) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2"))
+        return free_index_scan_avx2(range->free_sizes, range->free_count, start, size);
+#endif
+    // Skalär reserv
+    for (size_t i = start; i < range->free_count; i++)
+        if (range->free_sizes[i] >= size) return i;
+    return range->free_count;
+}
+
+// Publicerar intervallets sammanfattning för mem_stats, anropas med intervallets lås taget efter varje ändring
+static void range_publish(MemRange* range) {
+    if (range->largest_dirty) {
+        range->largest_free = 0;
+        for (size_t i = 0; i < range->free_count; i++)
+            if (range->free_sizes[i] > range->largest_free) range->largest_free = range->free_sizes[i];
+        range->largest_dirty = 0;
+    }
+
+    unsigned sequence = atomic_load_explicit(&range->stats_sequence, memory_order_relaxed);
+    atomic_store_explicit(&range->stats_sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // Udda nummer syns innan fälten ändras
+    atomic_store_explicit(&range->stats_free_bytes, range->free_bytes, memory_order_relaxed);
+    atomic_store_explicit(&range->stats_free_blocks, range->free_count, memory_order_relaxed);
+    atomic_store_explicit(&range->stats_largest_free, range->largest_free, memory_order_relaxed);
+    atomic_store_explicit(&range->stats_sequence, sequence + 2, memory_order_release);
+}
+
+// Läser en konsistent ögonblicksbild av allokatorns tillstånd utan att ta något lås
+// Varje intervall läses konsistent för sig, summan över flera intervall är inte en enda atomär bild
+void mem_stats(MemStats* stats) {
+    size_t total_free = 0;
+    stats->free_blocks = 0;
+    stats->largest_free = 0;
+    for (int i = 0; i < num_ranges; i++) {
+        MemRange* range = &ranges[i];
+        unsigned begin, end;
+        size_t free_bytes, free_blocks, largest_free;
+        do {
+            begin = atomic_load_explicit(&range->stats_sequence, memory_order_acquire);
+            free_bytes = atomic_load_explicit(&range->stats_free_bytes, memory_order_relaxed);
+            free_blocks = atomic_load_explicit(&range->stats_free_blocks, memory_order_relaxed);
+            largest_free = atomic_load_explicit(&range->stats_largest_free, memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire); // Fälten läses innan sekvensnumret kontrolleras igen
+            end = atomic_load_explicit(&range->stats_sequence, memory_order_relaxed);
+        } while ((begin & 1) || begin != end);
+
+        total_free += free_bytes;
+        stats->free_blocks += free_blocks;
+        if (largest_free > stats->largest_free) stats->largest_free = largest_free;
+    }
+    stats->bytes_used = pool_size - total_free;
+}
+
+// ********* Sidindelat läge (MemOptions.paged) *********
+// Små allokeringar (<= MEM_SMALL_MAX) tas från sidor på MEM_PAGE_SIZE bytes där varje sida bara har en storleksklass.
+// Varje tråd har en egen heap med sidor per klass. Varje sida har tre frilistor:
+//   free        - allokeringslistan, rörs bara av ägaren
+//   local_free  - ägarens egna frigöringar, byts in först när free tar slut (fördröjd frigöring)
+//   thread_free - andra trådars frigöringar, lock-free push, samlas in av ägaren
+// Snabbvägen är att ta första blocket i free - inga lås och inga skrivningar till delat tillstånd.
+// Nya block i en sida delas ut med en bump-pekare så att allokeringar inom sidan blir sekventiella.
+// Sidornas metadata ligger utanför poolen, sidtabellen ger sidan för en pekare i O(1).
+// F: nästan all trafik rör bara en sidas metadata, N: minne binds per tråd och klass, en halvtom sida kan inte lånas ut
+
+typedef struct MemFreeBlock {
+    struct MemFreeBlock* next;
+} MemFreeBlock;
+
+struct MemHeap;
+
+typedef struct MemPage {
+    _Atomic(struct MemHeap*) heap;     // Ägande heap, NULL när sidan är övergiven
+    char* start;
+    size_t block_size;
+    size_t capacity;                   // Antal block som får plats i sidan
+    size_t reserved;                   // Antal block som bump-pekaren delat ut hittills
+    size_t used;                       // Allokerade block, räknas ner för thread_free först vid insamling
+    MemFreeBlock* free;
+    MemFreeBlock* local_free;
+    _Atomic(MemFreeBlock*) thread_free;
+    atomic_ullong live[MEM_PAGE_SLOTS / 64]; // En bit per utdelat block som inte frigjorts, för mem_size
+    int size_class;
+    struct MemPage* next;              // Nästa sida i heapens lista för samma klass
+} MemPage;
+
+typedef struct MemHeap {
+    MemPage* pages[MEM_SIZE_CLASSES];  // Första sidan i listan är den aktuella
+    // Taggräknare, skrivs bara av ägartråden och summeras först när mem_tag_stats anropas
+    // En frigöring räknas av i den frigörande trådens heap, summan över alla heapar stämmer ändå
+    atomic_llong tag_bytes[MEM_MAX_TAGS];
+    atomic_llong tag_count[MEM_MAX_TAGS];
+    struct MemHeap* next;              // Alla heapar, för mem_deinit
+} MemHeap;
+
+// Storleksklasser: steg om 16 upp till 128, sedan 4 klasser per fördubbling upp till 1024
+static const size_t class_sizes[MEM_SIZE_CLASSES] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+static int size_class(size_t size) {
+    if (size <= 128) return (int)((size + 15) / 16) - 1;
+    int bits = 63 - __builtin_clzl(size - 1); // size - 1 ligger i [2^bits, 2^(bits+1))
+    return 8 + (bits - 7) * 4 + (int)((size - 1) >> (bits - 2)) - 4;
+}
+
+static int paged_mode = 0;
+static MemHeap* heap_list = NULL;               // Skyddas av memory_lock
+static MemPage* abandoned_pages[MEM_SIZE_CLASSES]; // Sidor från avslutade trådar, skyddas av memory_lock
+static long long retired_tag_bytes[MEM_MAX_TAGS];  // Taggräknare från avslutade trådar, skyddas av memory_lock
+static long long retired_tag_count[MEM_MAX_TAGS];
+
+// Generationen räknas upp vid varje mem_init så att trådlokala heapar från en tidigare pool inte används
+static atomic_uint pool_generation = 0;
+static _Thread_local MemHeap* local_heap = NULL;
+static _Thread_local unsigned local_generation = 0;
+static pthread_key_t heap_key;
+static pthread_once_t heap_key_once = PTHREAD_ONCE_INIT;
+
+// Samplat storlekshistogram
+typedef struct {
+    atomic_size_t allocs;
+    atomic_size_t frees;
+    atomic_size_t bytes;
+    atomic_ullong lifetime_ns;
+} MemSampleBucket;
+
+static int sample_rate = 0;                     // Sätts i mem_init, 0 = ingen sampling
+static MemSampleBucket sample_buckets[MEM_HISTOGRAM_BUCKETS];
+static _Thread_local int sample_countdown = 0;  // Allokeringar kvar till nästa sampel
+
+// Sidkarta: radixträd i två nivåer från poolsida (MEM_MAP_PAGE) till metadata
+// Roten har en pekare per MEM_MAP_LEAF sidor, ett löv allokeras först när ett block börjar i dess område.
+// blocks[] pekar på det första blocket som börjar i sidan, så blocket för en pekare hittas direkt eller efter
+// några steg i listan i stället för med en genomgång av hela block_list. pages[] är sidindelade lägets sidtabell.
+// Intervallgränserna ligger på sidgränser, så en post i blocks[] ändras bara under ett intervalls lås.
+// pages[] läses utan lås av mem_free från godtycklig tråd, så posterna skrivs med release och läses med acquire
+// F: O(1) fram till sidan och främmande pekare avvisas direkt, N: ett löv på drygt 4 KiB per använda 2 MiB
+typedef struct {
+    MemBlock* blocks[MEM_MAP_LEAF];
+    _Atomic(MemPage*) pages[MEM_MAP_LEAF >> (MEM_PAGE_SHIFT - MEM_MAP_SHIFT)];
+} MemMapLeaf;
+
+static _Atomic(MemMapLeaf*)* page_map = NULL;
+static size_t page_map_leaves = 0;
+
+// Lövet för poolsidan page, skapas om create är satt. NULL om det saknas eller inte kunde allokeras
+static MemMapLeaf* map_leaf(size_t page, int create) {
+    _Atomic(MemMapLeaf*)* slot = &page_map[page >> MEM_MAP_LEAF_BITS];
+    MemMapLeaf* leaf = atomic_load_explicit(slot, memory_order_acquire);
+    if (leaf || !create) return leaf;
+    leaf = (MemMapLeaf*)calloc(1, sizeof(MemMapLeaf));
+    if (!leaf) return NULL;
+    // Ett löv delas av flera intervall - det som installeras först gäller
+    MemMapLeaf* expected = NULL;
+    if (!atomic_compare_exchange_strong_explicit(slot, &expected, leaf, memory_order_acq_rel, memory_order_acquire)) {
+        free(leaf);
+        leaf = expected;
+    }
+    return leaf;
+}
+
+// Anropas när blocket har länkats in eller fått ny offset: blocket blir sidans post om det är först i sidan
+static void map_add(MemRange* range, MemBlock* block) {
+    size_t page = block->offset >> MEM_MAP_SHIFT;
+    if (block->prev && block->prev->offset >> MEM_MAP_SHIFT == page) return;
+    MemMapLeaf* leaf = map_leaf(page, 1);
+    if (leaf) leaf->blocks[page & (MEM_MAP_LEAF - 1)] = block;
+    else range->map_broken = 1;
+}
+
+// Anropas innan blocket länkas ur eller byter offset: nästa block i samma sida tar över posten
+static void map_remove(MemBlock* block) {
+    size_t page = block->offset >> MEM_MAP_SHIFT;
+    MemMapLeaf* leaf = map_leaf(page, 0);
+    if (!leaf || leaf->blocks[page & (MEM_MAP_LEAF - 1)] != block) return;
+    leaf->blocks[page & (MEM_MAP_LEAF - 1)] = block->next && block->next->offset >> MEM_MAP_SHIFT == page ? block->next : NULL;
+}
+
+// Registrerar småobjektsidan som börjar på offset, NULL tar bort den
+static int map_set_page(size_t offset, MemPage* page) {
+    MemMapLeaf* leaf = map_leaf(offset >> MEM_MAP_SHIFT, page != NULL);
+    if (!leaf) return page ? -1 : 0;
+    size_t index = (offset >> MEM_PAGE_SHIFT) & ((MEM_MAP_LEAF >> (MEM_PAGE_SHIFT - MEM_MAP_SHIFT)) - 1);
+    atomic_store_explicit(&leaf->pages[index], page, memory_order_release); // Sidans fält syns före posten
+    return 0;
+}
+
+// ********* Sidbitmapp *********
+// Allokeringar på minst en sida avrundas till hela sidor och placeras på en sidgräns. En körning av k lediga sidor
+// hittas med ctz över sammanfattningsorden (hoppar över ord utan lediga sidor) och bitoperationer i lövorden,
+// i stället för en skanning över de lediga blocken. Bitmappen är ett härlett index: varje ändring av ett ledigt block
+// under intervallets lås sätter eller nollar bitarna för de sidor som berörs.
+// F: lediga sidor samlas i sammanhängande körningar och snabb placering för 4 KiB - 1 MiB, N: upp till en sida spill per allokering
+
+static int page_bitmap_mode = 0;
+
+// Sätter (set = 1) eller nollar bitarna för intervallets sidor [first, last)
+static void page_bits_update(MemRange* range, size_t first, size_t last, int set) {
+    while (first < last) {
+        size_t word = first >> 6;
+        size_t bits = 64 - (first & 63);
+        if (bits > last - first) bits = last - first;
+        uint64_t mask = (bits == 64 ? ~0ull : (1ull << bits) - 1) << (first & 63);
+        if (set) range->page_bits[word] |= mask;
+        else range->page_bits[word] &= ~mask;
+        if (range->page_bits[word]) range->page_summary[word >> 6] |= 1ull << (word & 63);
+        else range->page_summary[word >> 6] &= ~(1ull << (word & 63));
+        first += bits;
+    }
+}
+
+// Sidorna som ligger helt i det lediga blocket blir lediga
+static void page_bits_free(MemRange* range, MemBlock* block) {
+    if (!range->page_bits) return;
+    size_t first = (block->offset - range->start + MEM_MAP_PAGE - 1) >> MEM_MAP_SHIFT;
+    size_t last = (block->offset + block->size - range->start) >> MEM_MAP_SHIFT;
+    if (first < last) page_bits_update(range, first, last, 1);
+}
+
+// Sidorna som [offset, offset + size) berör är inte längre helt lediga
+static void page_bits_use(MemRange* range, size_t offset, size_t size) {
+    if (!range->page_bits) return;
+    size_t first = (offset - range->start) >> MEM_MAP_SHIFT;
+    size_t last = (offset + size - range->start + MEM_MAP_PAGE - 1) >> MEM_MAP_SHIFT;
+    page_bits_update(range, first, last, 0);
+}
+
+// Första körningen av count lediga sidor, returnerar sidans nummer i intervallet eller SIZE_MAX
+static size_t page_bits_find(MemRange* range, size_t count) {
+    size_t run = 0, run_start = 0, prev_word = SIZE_MAX;
+    for (size_t s = 0; s < (range->page_words + 63) / 64; s++) {
+        uint64_t summary = range->page_summary[s];
+        while (summary) {
+            size_t word = s * 64 + __builtin_ctzll(summary);
+            summary &= summary - 1;
+            uint64_t bits = range->page_bits[word];
+            if (word != prev_word + 1) run = 0; // Ett ord utan lediga sidor emellan bryter körningen
+            prev_word = word;
+
+            // En körning från föregående ord fortsätter med ordets lägsta bitar
+            if (run > 0) {
+                size_t ones = ~bits ? (size_t)__builtin_ctzll(~bits) : 64;
+                if (run + ones >= count) return run_start;
+                if (ones == 64) {
+                    run += 64;
+                    continue;
+                }
+                run = 0;
+            }
+
+            // Körning helt inom ordet: efter stegen är bit i satt om bitarna i .. i + count - 1 är satta
+            if (count <= 64) {
+                uint64_t m = bits;
+                size_t len = 1;
+                while (len < count && m) {
+                    size_t shift = len < count - len ? len : count - len;
+                    m &= m >> shift;
+                    len += shift;
+                }
+                if (m) return word * 64 + __builtin_ctzll(m);
+            }
+
+            // Satta bitar i toppen av ordet kan starta en körning som fortsätter i nästa ord
+            size_t top = ~bits ? (size_t)__builtin_clzll(~bits) : 64;
+            if (top > 0) {
+                run = top;
+                run_start = word * 64 + 64 - top;
+            }
+        }
+    }
+    return SIZE_MAX;
+}
+
+// Sätter upp ett intervall som ett enda ledigt block
+static int range_init(MemRange* range, size_t start, size_t end) {
+    memset(range, 0, sizeof(MemRange));
+    pthread_mutex_init(&range->lock, NULL);
+    range->start = start;
+    range->end = end;
+
+    range->block_list = block_new(range);
+    if (!range->block_list || free_index_reserve(range, 1) != 0) return -1;
+
+    // Initialiserar det första blocket som ledigt och täcker hela intervallet
+    range->block_list->offset = start;
+    range->block_list->size = end - start;
+    range->block_list->is_free = 1;
+    range->block_list->span = 0;
+    range->block_list->next = NULL;
+    range->block_list->prev = NULL;
+    range->block_count = 1;
+    map_add(range, range->block_list);
+    if (page_bitmap_mode) {
+        range->page_words = (((end - start) >> MEM_MAP_SHIFT) + 63) / 64;
+        range->page_bits = (uint64_t*)calloc(range->page_words, sizeof(uint64_t));
+        range->page_summary = (uint64_t*)calloc((range->page_words + 63) / 64, sizeof(uint64_t));
+        if (!range->page_bits || !range->page_summary) return -1;
+        page_bits_free(range, range->block_list);
+    }
+    free_index_insert(range, 0, range->block_list);
+    range_publish(range);
+    return 0;
+}
+
+static void range_destroy(MemRange* range) {
+    // Frigör alla blocknoder - de ligger i slabbarna
+    while (range->slabs) {
+        MemBlockSlab* slab = range->slabs;
+        range->slabs = slab->next;
+        free(slab);
+    }
+
+    // Frigör sidoindexet över lediga block
+    free(range->free_offsets);
+    free(range->free_sizes);
+    free(range->free_blocks);
+    free(range->page_bits);
+    free(range->page_summary);
+    pthread_mutex_destroy(&range->lock);
+}
+
+static void mem_warm_up(void);
+
 void mem_init(size_t size) {
+    mem_init_opts(size, NULL);
+}
+
+void mem_init_opts(size_t size, const MemOptions* options) {
     pthread_mutex_lock(&memory_lock); // Serialiserar initieringen - endast en tråd kan initiera åt gången
 
-    memory_pool = (char*)malloc(size); // Allokerar en sammanhängande minnespool från systemet
+    // Allokerar en sammanhängande minnespool från systemet
+    // I sidindelat läge alignas poolen på sidstorleken så att sidans index blir offset >> MEM_PAGE_SHIFT,
+    // med sidbitmappen så att sidorna i bitmappen också är sidor i adressrymden
+    int paged = options && options->paged;
+    page_bitmap_mode = options && options->page_bitmap;
+    if (paged || page_bitmap_mode) {
+        if (posix_memalign((void**)&memory_pool, MEM_PAGE_SIZE, size) != 0) memory_pool = NULL;
+    } else {
+        memory_pool = (char*)malloc(size);
+    }
     if (!memory_pool) {
         fprintf(stderr, "Error: Could not allocate memory pool\n");
         pthread_mutex_unlock(&memory_lock);
@@ -36,115 +576,887 @@ void mem_init(size_t size) {
     }
 
     pool_size = size;
-    
-    // Skapar ett enda stort ledigt block som täcker hela poolen
-    block_list = (MemBlock*)malloc(sizeof(MemBlock));
-    if (!block_list) {
+
+    // Bara stora pooler delas - varje intervall blir minst MEM_MIN_RANGE_SIZE
+    num_ranges = options && options->num_ranges > 1 ? options->num_ranges : 1;
+    if ((size_t)num_ranges > size / MEM_MIN_RANGE_SIZE)
+        num_ranges = size / MEM_MIN_RANGE_SIZE > 1 ? (int)(size / MEM_MIN_RANGE_SIZE) : 1;
+    // Med flera intervall hamnar gränserna på sidkartans sidgränser, så att ingen sida delas mellan två lås
+    range_size = num_ranges > 1 ? (size / num_ranges) & ~(MEM_MAP_PAGE - 1) : size;
+
+    ranges = (MemRange*)aligned_alloc(CACHE_LINE, num_ranges * sizeof(MemRange));
+    if (!ranges) {
         fprintf(stderr, "Error: Could not allocate block list\n");
         free(memory_pool);
         pthread_mutex_unlock(&memory_lock); // Viktigt: låser upp även vid fel
         exit(EXIT_FAILURE);
     }
 
-    // Initialiserar det första blocket som ledigt och täcker hela poolen
-    block_list->offset = 0;
-    block_list->size = size;
-    block_list->is_free = 1;
-    block_list->next = NULL;
+    page_map_leaves = (size >> (MEM_MAP_SHIFT + MEM_MAP_LEAF_BITS)) + 1;
+    page_map = (_Atomic(MemMapLeaf*)*)calloc(page_map_leaves, sizeof(*page_map));
+    if (!page_map) {
+        fprintf(stderr, "Error: Could not allocate page map\n");
+        pthread_mutex_unlock(&memory_lock);
+        exit(EXIT_FAILURE);
+    }
+
+    // Varje intervall börjar som ett enda stort ledigt block, det sista tar resten av poolen
+    for (int i = 0; i < num_ranges; i++) {
+        size_t start = (size_t)i * range_size;
+        size_t end = i == num_ranges - 1 ? size : start + range_size;
+        if (range_init(&ranges[i], start, end) != 0) {
+            fprintf(stderr, "Error: Could not allocate block list\n");
+            pthread_mutex_unlock(&memory_lock);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    paged_mode = paged;
+    atomic_fetch_add(&pool_generation, 1); // Heapar från en tidigare pool blir ogiltiga
+
+    // Nytt histogram, anropande tråd läser den nya sample_rate vid nästa allokering
+    sample_rate = options && options->sample_rate > 0 ? options->sample_rate : 0;
+    memset(sample_buckets, 0, sizeof(sample_buckets));
+    sample_countdown = 0;
+
+    if (options && options->prefault) mem_warm_up();
 
     pthread_mutex_unlock(&memory_lock); // Låser upp efter lyckad initiering
 }
 
+// Allokerar de första size bytes av det lediga blocket på position pos i indexet
+// Anropas med intervallets lås taget
+static MemBlock* range_take(MemRange* range, size_t pos, size_t size) {
+    MemBlock* current = range->free_blocks[pos];
+    current->is_free = 0; // Blocket är nu allokerat
+    current->tag = 0;     // Anroparen sätter taggen för taggade allokeringar
+    current->sampled_at = 0;
 
-// Allokeringsprocessen är skyddad genom mutex-låsning
-// First-fit strategi för att leta block
-void* mem_alloc(size_t size) {
-    pthread_mutex_lock(&memory_lock); // Kritisk sektion börjar - skyddar sökning och allokering
+    // Block-splitting: Om blocket är större än behövt, dela upp det
+    MemBlock* new_block = NULL;
+    if (current->size > size && free_index_reserve(range, range->block_count + 1) == 0)
+        new_block = block_new(range);
+    if (new_block) {
+        // Skapa ett nytt ledigt block från återstående utrymme
+        new_block->offset = current->offset + size;
+        new_block->size = current->size - size;
+        new_block->is_free = 1;
+        new_block->span = 0;
+        new_block->next = current->next;
+        new_block->prev = current;
+        if (new_block->next) new_block->next->prev = new_block;
+
+        // Uppdatera det aktuella blocket
+        current->size = size;
+        current->next = new_block;
+        range->block_count++;
+        map_add(range, new_block);
+        free_index_set(range, pos, new_block); // Resten tar blockets plats i indexet
+    } else {
+        // Om ingen nod kunde allokeras används hela blocket (inget splitting)
+        free_index_remove(range, pos);
+    }
+    page_bits_use(range, current->offset, current->size);
+    return current;
+}
+
+// First-fit strategi för att leta block inom ett intervall
+// Sidoindexet har samma ordning som block_list, så det blir samma block som en listgenomgång ger
+static MemBlock* range_alloc(MemRange* range, size_t size) {
+    size_t pos = free_index_first_fit(range, 0, size);
+    return pos < range->free_count ? range_take(range, pos, size) : NULL;
+}
+
+// Allokerar size bytes med början padding bytes in i det lediga blocket på position pos
+// Utfyllnaden före blir ett eget ledigt block, NULL om ingen nod kunde allokeras för det
+static MemBlock* range_take_at(MemRange* range, size_t pos, size_t padding, size_t size) {
+    if (padding > 0) {
+        MemBlock* current = range->free_blocks[pos];
+        MemBlock* aligned_block = NULL;
+        if (free_index_reserve(range, range->block_count + 1) == 0)
+            aligned_block = block_new(range);
+        if (!aligned_block) return NULL;
+        aligned_block->offset = current->offset + padding;
+        aligned_block->size = current->size - padding;
+        aligned_block->is_free = 1;
+        aligned_block->span = 0;
+        aligned_block->next = current->next;
+        aligned_block->prev = current;
+        if (aligned_block->next) aligned_block->next->prev = aligned_block;
+
+        current->size = padding;
+        current->next = aligned_block;
+        range->block_count++;
+        map_add(range, aligned_block);
+        free_index_set(range, pos, current); // Utfyllnaden ligger kvar på samma plats
+        free_index_insert(range, ++pos, aligned_block);
+    }
+
+    // Dela av överskottet efter blocket precis som i range_alloc
+    return range_take(range, pos, size);
+}
+
+// Som range_alloc men utfyllnaden före den alignade adressen blir ett eget ledigt block
+static MemBlock* range_alloc_aligned(MemRange* range, size_t size, size_t alignment) {
+    // Indexet skannar fram kandidater som rymmer size, utfyllnaden kontrolleras per kandidat
+    size_t pos = free_index_first_fit(range, 0, size);
+    while (pos < range->free_count) {
+        MemBlock* current = range->free_blocks[pos];
+        size_t address = (size_t)(memory_pool + current->offset);
+        size_t padding = ((address + alignment - 1) & ~(alignment - 1)) - address;
+        if (current->size >= size + padding) return range_take_at(range, pos, padding, size);
+        pos = free_index_first_fit(range, pos + 1, size);
+    }
+    return NULL;
+}
+
+// Allokerar pages hela sidor från sidbitmappen, NULL om intervallet saknar en sådan körning
+static MemBlock* range_alloc_pages(MemRange* range, size_t pages) {
+    size_t page = page_bits_find(range, pages);
+    if (page == SIZE_MAX) return NULL;
+    size_t offset = range->start + (page << MEM_MAP_SHIFT);
+    size_t size = pages << MEM_MAP_SHIFT;
+
+    // Det lediga block som täcker sidan börjar antingen på sidan eller är närmaste lediga block före
+    size_t pos = free_index_find(range, offset);
+    if (pos == range->free_count || range->free_offsets[pos] != offset) {
+        if (pos == 0) return NULL; // Bitmappen och indexet är oense - inget ledigt block före sidan
+        pos--;
+    }
+    // Två angränsande lediga block som inte slagits ihop kan ge en körning som inget enskilt block täcker
+    if (range->free_offsets[pos] + range->free_sizes[pos] < offset + size) return NULL;
+    return range_take_at(range, pos, offset - range->free_offsets[pos], size);
+}
+
+// Låser alla intervall i stigande ordning - samma ordning överallt så att två sådana operationer inte kan låsa fast varandra
+static void lock_all_ranges(void) {
+    for (int i = 0; i < num_ranges; i++)
+        pthread_mutex_lock(&ranges[i].lock);
+}
+
+static void unlock_all_ranges(void) {
+    for (int i = num_ranges - 1; i >= 0; i--) {
+        range_publish(&ranges[i]);
+        pthread_mutex_unlock(&ranges[i].lock);
+    }
+}
+
+// ********* Samplat storlekshistogram *********
+// Var sample_rate:e allokering per tråd samplas: storleken räknas in i histogrammet och blocket får en tidsstämpel,
+// så att frigöringen av just det blocket kan räknas in med sin livslängd. Snabbvägen kostar bara en nedräkning
+// av en trådlokal räknare. Hinkarna uppdateras med atomära additioner och läses utan lås.
+// F: billig nog att alltid vara på, N: trådar som levde före mem_init kan ta MEM_SAMPLE_IDLE allokeringar på sig
+// att se en ny sample_rate
+
+static uint64_t sample_clock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec + 1; // Aldrig 0
+}
+
+static int sample_bucket_of(size_t size) {
+    int bucket = size <= 1 ? 0 : 64 - __builtin_clzl(size - 1);
+    return bucket < MEM_HISTOGRAM_BUCKETS ? bucket : MEM_HISTOGRAM_BUCKETS - 1;
+}
+
+// Nedräkningen har nått noll: startar om den och returnerar tidsstämpeln om allokeringen ska samplas, annars 0
+static uint64_t sample_begin(size_t size) {
+    int rate = sample_rate;
+    sample_countdown = rate > 0 ? rate : MEM_SAMPLE_IDLE;
+    return rate > 0 && size > 0 ? sample_clock() : 0;
+}
+
+static void sample_alloc(size_t size) {
+    MemSampleBucket* bucket = &sample_buckets[sample_bucket_of(size)];
+    atomic_fetch_add_explicit(&bucket->allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bucket->bytes, size, memory_order_relaxed);
+}
+
+static void sample_free(int bucket, uint64_t sampled_at) {
+    uint64_t now = sample_clock();
+    atomic_fetch_add_explicit(&sample_buckets[bucket].frees, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sample_buckets[bucket].lifetime_ns, now > sampled_at ? now - sampled_at : 0, memory_order_relaxed);
+}
+
+// Kopierar histogrammet, hinkarna läses var för sig så summorna kan vara ur fas med varandra under pågående trafik
+void mem_size_histogram(MemHistogram* histogram) {
+    histogram->sample_rate = sample_rate;
+    for (int i = 0; i < MEM_HISTOGRAM_BUCKETS; i++) {
+        histogram->buckets[i].allocs = atomic_load_explicit(&sample_buckets[i].allocs, memory_order_relaxed);
+        histogram->buckets[i].frees = atomic_load_explicit(&sample_buckets[i].frees, memory_order_relaxed);
+        histogram->buckets[i].bytes = atomic_load_explicit(&sample_buckets[i].bytes, memory_order_relaxed);
+        histogram->buckets[i].lifetime_ns = atomic_load_explicit(&sample_buckets[i].lifetime_ns, memory_order_relaxed);
+    }
+}
+
+static void tag_account(int tag, long long bytes, long long count);
+
+// Långsam väg när inget intervall hade plats: låser hela poolen
+// Först en vanlig first-fit över alla intervall (snabbvägen kan ha hoppat över intervall på inaktuell statistik),
+// sedan en sammanhängande körning över intervallgränser: ledigt slut på intervall r, helt lediga intervall,
+// ledig början på intervallet efter. Körningen allokeras som ett block per intervall där det första bär span.
+static void* mem_alloc_spanning(size_t size, int tag, uint64_t sampled_at) {
+    lock_all_ranges();
+
+    for (int r = 0; r < num_ranges; r++) {
+        MemBlock* block = range_alloc(&ranges[r], size);
+        if (block) {
+            block->tag = tag;
+            block->sampled_at = sampled_at;
+            block->sample_bucket = sample_bucket_of(size);
+            size_t allocated = block->size;
+            unlock_all_ranges();
+            tag_account(tag, (long long)allocated, 1);
+            return memory_pool + block->offset;
+        }
+    }
+
+    for (int r = 0; r < num_ranges - 1; r++) {
+        MemRange* range = &ranges[r];
+        if (range->free_count == 0) continue;
+        MemBlock* tail = range->free_blocks[range->free_count - 1];
+        if (tail->offset + tail->size != range->end) continue;
+
+        // Räkna ihop lediga bytes framåt tills det räcker eller körningen bryts
+        size_t total = tail->size;
+        int last = r;
+        while (total < size && last + 1 < num_ranges) {
+            MemRange* next = &ranges[last + 1];
+            if (next->free_count == 0 || next->free_offsets[0] != next->start) break;
+            total += next->free_sizes[0];
+            last++;
+            if (next->free_sizes[0] != next->end - next->start) break; // Intervallet är inte helt ledigt
+        }
+        if (total < size) continue;
+
+        // Allokera körningen, sista intervallet får bara det som återstår
+        size_t offset = tail->offset;
+        size_t remaining = size;
+        for (int q = r; q <= last; q++) {
+            size_t pos = q == r ? ranges[q].free_count - 1 : 0;
+            size_t part = ranges[q].free_sizes[pos] < remaining ? ranges[q].free_sizes[pos] : remaining;
+            range_take(&ranges[q], pos, part);
+            remaining -= part;
+        }
+        tail->span = size;
+        tail->tag = tag;
+        tail->sampled_at = sampled_at;
+        tail->sample_bucket = sample_bucket_of(size);
+
+        unlock_all_ranges();
+        tag_account(tag, (long long)size, 1);
+        return memory_pool + offset;
+    }
+
+    unlock_all_ranges();
+    return NULL;
+}
+
+static void* page_alloc_small(size_t size);
+
+// Allokeringsprocessen är skyddad genom intervallets lås
+// Det föredragna intervallet provas först, sedan stjäls utrymme från de andra i tur och ordning
+// Taggen sparas i blocket så att mem_free kan räkna av rätt tagg, tagg 0 ger en vanlig otaggad allokering
+void* mem_alloc_tagged(size_t size, int tag) {
+    if (tag < 0 || tag >= MEM_MAX_TAGS) {
+        fprintf(stderr, "Error: Tag %d is out of range\n", tag);
+        return NULL;
+    }
+
+    // Samplingens enda kostnad på snabbvägen
+    uint64_t sampled_at = --sample_countdown <= 0 ? sample_begin(size) : 0;
+
+    // Sidindelat läge: små block från trådens egna sidor, även noll bytes får ett eget block så att mem_free fungerar
+    // Sidornas block har ingen egen metadata, så taggade och samplade allokeringar tas alltid som vanliga block
+    if (paged_mode && size <= MEM_SMALL_MAX && tag == 0 && !sampled_at) {
+        void* result = page_alloc_small(size ? size : 1);
+        if (result) return result;
+        if (size == 0) return NULL;
+        // Ingen sida kunde skaffas - försök med ett vanligt block
+    }
 
     // Gränskontroll: Hantera noll-storlek
     if (size == 0) {
-        pthread_mutex_unlock(&memory_lock);
         return memory_pool; // Returnerar sentinelpekare för noll-storlek (använd/frigör ej)
     }
+    if (size > pool_size) return NULL;
 
-    // First-fit sökning: Hitta första lediga blocket som är tillräckligt stort
-    MemBlock* current = block_list;
-    while (current) {
-        if (current->is_free && current->size >= size) {
-            current->is_free = 0; // Blocket är nu allokerat
-            
-            // Block-splitting: Om blocket är större än behövt, dela upp det
-            if (current->size > size) {
-                MemBlock* new_block = (MemBlock*)malloc(sizeof(MemBlock));
-                if (new_block) {
-                    // Skapa ett nytt ledigt block från återstående utrymme
-                    new_block->offset = current->offset + size;
-                    new_block->size = current->size - size;
-                    new_block->is_free = 1;
-                    new_block->next = current->next;
-                    
-                    // Uppdatera det aktuella blocket
-                    current->size = size;
-                    current->next = new_block;
-                }
-                // Om malloc misslyckas används hela blocket (inget splitting)
-            }
-            
+    // Med sidbitmappen tas allokeringar på minst en sida som hela sidor, annars first-fit i samma intervall
+    size_t pages = page_bitmap_mode && size >= MEM_MAP_PAGE ? (size + MEM_MAP_PAGE - 1) >> MEM_MAP_SHIFT : 0;
+
+    int first = preferred_range();
+    for (int i = 0; i < num_ranges; i++) {
+        MemRange* range = &ranges[(first + i) % num_ranges];
+        // Intervall som enligt den publicerade statistiken saknar plats hoppas över utan att låsas
+        if (num_ranges > 1 && atomic_load_explicit(&range->stats_largest_free, memory_order_relaxed) < size) continue;
+
+        pthread_mutex_lock(&range->lock); // Kritisk sektion börjar - skyddar sökning och allokering
+        MemBlock* block = pages ? range_alloc_pages(range, pages) : NULL;
+        if (!block) block = range_alloc(range, size);
+        if (block) {
             // Beräkna pekare till det allokerade området
-            void* result = memory_pool + current->offset;
-            pthread_mutex_unlock(&memory_lock); // Kritisk sektion slut - allokering lyckades
+            void* result = memory_pool + block->offset;
+            block->tag = tag;
+            block->sampled_at = sampled_at;
+            block->sample_bucket = sample_bucket_of(size);
+            size_t allocated = block->size;
+            range_publish(range);
+            pthread_mutex_unlock(&range->lock); // Kritisk sektion slut - allokering lyckades
+            if (tag) tag_account(tag, (long long)allocated, 1);
+            if (sampled_at) sample_alloc(size);
             return result;
         }
-        current = current->next;
+        pthread_mutex_unlock(&range->lock);
     }
 
-    // Felhantering: Inget ledigt block med tillräcklig storlek hittades
-    pthread_mutex_unlock(&memory_lock); // Kritisk sektion slut - allokering misslyckades
-    return NULL;
+    // Felhantering: Inget ledigt block med tillräcklig storlek hittades i något enskilt intervall
+    void* result = num_ranges > 1 ? mem_alloc_spanning(size, tag, sampled_at) : NULL;
+    if (result && sampled_at) sample_alloc(size);
+    return result;
+}
+
+void* mem_alloc(size_t size) {
+    return mem_alloc_tagged(size, 0);
+}
+
+// Allokerar ett block vars adress är en multipel av alignment (tvåpotens)
+// Används t.ex. för cache-line-alignade köer där falsk delning måste undvikas
+// First-fit som mem_alloc, men utfyllnaden före den alignade adressen blir ett eget ledigt block
+// så att mem_free fungerar som vanligt på den returnerade pekaren
+// Alignade block läggs aldrig över en intervallgräns
+void* mem_alloc_aligned(size_t size, size_t alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1))) {
+        fprintf(stderr, "Error: Alignment %zu is not a power of two\n", alignment);
+        return NULL;
+    }
+
+    if (size == 0) {
+        return memory_pool; // Samma sentinel som mem_alloc
+    }
+    if (size > pool_size) return NULL;
+
+    int first = preferred_range();
+    for (int i = 0; i < num_ranges; i++) {
+        MemRange* range = &ranges[(first + i) % num_ranges];
+        pthread_mutex_lock(&range->lock); // Kritisk sektion börjar - skyddar sökning och allokering
+        MemBlock* block = range_alloc_aligned(range, size, alignment);
+        if (block) {
+            void* result = memory_pool + block->offset;
+            range_publish(range);
+            pthread_mutex_unlock(&range->lock); // Kritisk sektion slut - allokering lyckades
+            return result;
+        }
+        pthread_mutex_unlock(&range->lock);
+    }
+
+    return NULL; // Allokering misslyckades
+}
+
+// Letar upp blocket som börjar på offset via sidkartan, NULL om inget block börjar där
+// Bara block som börjar i samma sida före offset behöver stegas förbi
+static MemBlock* range_find(MemRange* range, size_t offset) {
+    MemBlock* current;
+    if (range->map_broken) {
+        current = range->block_list; // Sidkartan är ofullständig för intervallet - sök i hela listan
+    } else {
+        size_t page = offset >> MEM_MAP_SHIFT;
+        MemMapLeaf* leaf = map_leaf(page, 0);
+        current = leaf ? leaf->blocks[page & (MEM_MAP_LEAF - 1)] : NULL;
+    }
+    while (current && current->offset < offset) current = current->next;
+    return current && current->offset == offset ? current : NULL;
+}
+
+// Frigör blocket och slår ihop det med lediga grannar i samma intervall
+// Anropas med intervallets lås taget
+static void range_free_block(MemRange* range, MemBlock* current) {
+    if (current->is_free) return; // Redan ledigt - får inte hamna två gånger i indexet
+    MemBlock* prev = current->prev;
+
+    current->is_free = 1; // Blocket är nu ledigt
+    current->span = 0;
+
+    // Närmaste lediga block efter detta ligger på pos i indexet, det närmaste före på pos - 1
+    size_t pos = free_index_find(range, current->offset);
+    int indexed = 0;
+
+    // Coalescing framåt: Slå samman med nästa block om möjligt
+    // Detta förhindrar fragmentering genom att kombinera närliggande lediga block
+    if (current->next && current->next->is_free &&
+        current->offset + current->size == current->next->offset) {
+        MemBlock* next_block = current->next;
+        map_remove(next_block);
+        current->size += next_block->size;
+        current->next = next_block->next;
+        if (current->next) current->next->prev = current;
+        block_delete(range, next_block); // Ta bort den överflödiga blocknoden
+        range->block_count--;
+        free_index_set(range, pos, current); // Blocket tar över grannens plats i indexet
+        indexed = 1;
+    }
+
+    // Coalescing bakåt: Slå samman med föregående block om möjligt
+    if (prev && prev->is_free &&
+        prev->offset + prev->size == current->offset) {
+        map_remove(current);
+        prev->size += current->size;
+        prev->next = current->next;
+        if (prev->next) prev->next->prev = prev;
+        block_delete(range, current); // Ta bort den överflödiga blocknoden
+        range->block_count--;
+        if (indexed) free_index_remove(range, pos);
+        free_index_set(range, pos - 1, prev);
+        page_bits_free(range, prev);
+        return;
+    }
+
+    if (!indexed) free_index_insert(range, pos, current);
+    page_bits_free(range, current);
+}
+
+// Frigör en allokering som spänner över flera intervall, ett block per intervall
+// Lediga grannar slås ihop inom varje intervall men aldrig över gränsen
+static void mem_free_spanning(size_t offset) {
+    lock_all_ranges();
+
+    MemBlock* head = range_find(range_of(offset), offset);
+    int tag = 0, bucket = 0;
+    size_t freed = 0;
+    uint64_t sampled_at = 0;
+    // Blocket kan ha frigjorts av en annan tråd mellan upplåsning och låsning av alla intervall
+    if (head && !head->is_free && head->span) {
+        tag = head->tag;
+        freed = head->span;
+        sampled_at = head->sampled_at;
+        bucket = head->sample_bucket;
+        size_t end = offset + head->span;
+        while (offset < end) {
+            MemRange* range = range_of(offset);
+            MemBlock* block = range_find(range, offset);
+            if (!block) break;
+            offset += block->size;
+            range_free_block(range, block);
+        }
+    }
+
+    unlock_all_ranges();
+    if (tag) tag_account(tag, -(long long)freed, -1);
+    if (sampled_at) sample_free(bucket, sampled_at);
+}
+
+// Lämnar tillbaka sidans område till intervallen
+static void page_release(MemPage* page) {
+    map_set_page(page->start - memory_pool, NULL);
+    mem_free(page->start); // Sidkartan är nollad så mem_free tar vanliga vägen
+    free(page);
+}
+
+// Ny tom sida för klassen c, tas ur intervallen med mem_alloc_aligned
+static MemPage* page_new(int c) {
+    char* start = mem_alloc_aligned(MEM_PAGE_SIZE, MEM_PAGE_SIZE);
+    if (!start) return NULL;
+    MemPage* page = (MemPage*)calloc(1, sizeof(MemPage));
+    if (!page || map_set_page(start - memory_pool, page) != 0) {
+        free(page);
+        mem_free(start);
+        return NULL;
+    }
+    page->start = start;
+    page->block_size = class_sizes[c];
+    page->capacity = MEM_PAGE_SIZE / class_sizes[c];
+    page->size_class = c;
+    return page;
+}
+
+// Flyttar local_free och thread_free till free, anropas bara av ägaren
+static void page_collect(MemPage* page) {
+    MemFreeBlock* remote = atomic_exchange_explicit(&page->thread_free, NULL, memory_order_acquire);
+    while (remote) {
+        MemFreeBlock* next = remote->next;
+        remote->next = page->free;
+        page->free = remote;
+        page->used--;
+        remote = next;
+    }
+    if (!page->free) {
+        page->free = page->local_free;
+        page->local_free = NULL;
+    }
+}
+
+// Sätter eller nollar blockets bit i live, från ägaren vid allokering och från den frigörande tråden
+static void page_mark(MemPage* page, void* ptr, int live) {
+    size_t slot = ((char*)ptr - page->start) / page->block_size;
+    unsigned long long bit = 1ULL << (slot & 63);
+    if (live) atomic_fetch_or_explicit(&page->live[slot >> 6], bit, memory_order_relaxed);
+    else atomic_fetch_and_explicit(&page->live[slot >> 6], ~bit, memory_order_relaxed);
+}
+
+// Delar ut nästa omgång block med bump-pekaren, i adressordning
+static void page_extend(MemPage* page) {
+    size_t count = page->capacity - page->reserved;
+    if (count > 64) count = 64; // Små steg så att sidan inte rörs mer än nödvändigt
+    MemFreeBlock** tail = &page->free;
+    while (*tail) tail = &(*tail)->next;
+    for (size_t i = 0; i < count; i++) {
+        MemFreeBlock* block = (MemFreeBlock*)(page->start + (page->reserved + i) * page->block_size);
+        *tail = block;
+        tail = &block->next;
+    }
+    *tail = NULL;
+    page->reserved += count;
+}
+
+// Körs när en tråd avslutas: tomma sidor lämnas tillbaka, övriga läggs bland de övergivna för andra heapar att ta över
+// Trådlokala heapar finns i alla lägen eftersom de även bär taggräknarna, utan sidindelning är sidlistorna tomma
+static void heap_abandon(void* value) {
+    (void)value;
+    pthread_mutex_lock(&memory_lock);
+    MemHeap* heap = local_heap;
+    // Bara en heap som fortfarande finns i heap_list för den aktuella poolen lämnas tillbaka
+    MemHeap** link = &heap_list;
+    while (heap && *link && *link != heap) link = &(*link)->next;
+    if (heap && *link == heap && local_generation == atomic_load(&pool_generation)) {
+        for (int c = 0; c < MEM_SIZE_CLASSES; c++) {
+            MemPage* page = heap->pages[c];
+            while (page) {
+                MemPage* next = page->next;
+                page_collect(page);
+                if (page->used == 0) {
+                    page_release(page);
+                } else {
+                    atomic_store_explicit(&page->heap, NULL, memory_order_release);
+                    page->next = abandoned_pages[c];
+                    abandoned_pages[c] = page;
+                }
+                page = next;
+            }
+        }
+        // Taggräknarna lever vidare i summan för avslutade trådar
+        for (int t = 1; t < MEM_MAX_TAGS; t++) {
+            retired_tag_bytes[t] += atomic_load_explicit(&heap->tag_bytes[t], memory_order_relaxed);
+            retired_tag_count[t] += atomic_load_explicit(&heap->tag_count[t], memory_order_relaxed);
+        }
+        *link = heap->next;
+        free(heap);
+    }
+    local_heap = NULL;
+    pthread_mutex_unlock(&memory_lock);
+}
+
+static void heap_key_create(void) {
+    pthread_key_create(&heap_key, heap_abandon);
+}
+
+static MemHeap* heap_get(void) {
+    unsigned generation = atomic_load_explicit(&pool_generation, memory_order_relaxed);
+    if (local_heap && local_generation == generation) return local_heap;
+
+    MemHeap* heap = (MemHeap*)calloc(1, sizeof(MemHeap));
+    if (!heap) return NULL;
+    pthread_once(&heap_key_once, heap_key_create);
+    pthread_mutex_lock(&memory_lock);
+    heap->next = heap_list;
+    heap_list = heap;
+    pthread_mutex_unlock(&memory_lock);
+    pthread_setspecific(heap_key, heap); // Värdet måste vara skilt från NULL för att destruktorn ska köras
+
+    local_heap = heap;
+    local_generation = generation;
+    return heap;
+}
+
+// Långsam väg: samla in frigjorda block, fyll på med bump-pekaren, ta över en övergiven sida eller hämta en ny
+static void* heap_alloc_slow(MemHeap* heap, int c) {
+    MemPage* prev = NULL;
+    MemPage* page = heap->pages[c];
+    while (page) {
+        MemPage* next = page->next;
+        page_collect(page);
+        if (!page->free && page->reserved < page->capacity) page_extend(page);
+
+        if (page->free) {
+            // Sidan blir aktuell
+            if (prev) {
+                prev->next = next;
+                page->next = heap->pages[c];
+                heap->pages[c] = page;
+            }
+            break;
+        }
+        if (page->used == 0 && prev) {
+            // Tom sida som inte är den aktuella lämnas tillbaka till poolen
+            prev->next = next;
+            page_release(page);
+        } else {
+            prev = page;
+        }
+        page = next;
+    }
+
+    // Ingen egen sida har plats: ta över en övergiven sida av samma klass, annars en ny från intervallen
+    while (!page) {
+        pthread_mutex_lock(&memory_lock);
+        MemPage* candidate = abandoned_pages[c];
+        if (candidate) abandoned_pages[c] = candidate->next;
+        pthread_mutex_unlock(&memory_lock);
+
+        if (candidate) {
+            atomic_store_explicit(&candidate->heap, heap, memory_order_release);
+            page_collect(candidate);
+            if (!candidate->free && candidate->reserved < candidate->capacity) page_extend(candidate);
+        } else {
+            candidate = page_new(c);
+            if (!candidate) return NULL;
+            atomic_store_explicit(&candidate->heap, heap, memory_order_relaxed);
+            page_extend(candidate);
+        }
+
+        // Även en full övergiven sida hör nu till heapen, dess block samlas in senare
+        candidate->next = heap->pages[c];
+        heap->pages[c] = candidate;
+        if (candidate->free) page = candidate;
+    }
+
+    MemFreeBlock* block = page->free;
+    page->free = block->next;
+    page->used++;
+    page_mark(page, block, 1);
+    return block;
+}
+
+// Snabbvägen för små allokeringar i sidindelat läge
+static void* page_alloc_small(size_t size) {
+    MemHeap* heap = heap_get();
+    if (!heap) return NULL;
+    int c = size_class(size);
+    MemPage* page = heap->pages[c];
+    if (page && page->free) {
+        MemFreeBlock* block = page->free;
+        page->free = block->next;
+        page->used++;
+        page_mark(page, block, 1);
+        return block;
+    }
+    return heap_alloc_slow(heap, c);
+}
+
+// Ägaren lägger blocket i local_free, andra trådar i thread_free
+static void page_free_small(MemPage* page, void* ptr) {
+    MemFreeBlock* block = (MemFreeBlock*)ptr;
+    page_mark(page, ptr, 0);
+    MemHeap* heap = local_generation == atomic_load_explicit(&pool_generation, memory_order_relaxed) ? local_heap : NULL;
+    if (heap && atomic_load_explicit(&page->heap, memory_order_relaxed) == heap) {
+        block->next = page->local_free;
+        page->local_free = block;
+        page->used--;
+        return;
+    }
+
+    MemFreeBlock* head = atomic_load_explicit(&page->thread_free, memory_order_relaxed);
+    do {
+        block->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&page->thread_free, &head, block,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+// Sidan som ptr ligger i, NULL om ptr inte tillhör en småobjektsida
+static MemPage* page_of(void* ptr) {
+    if (!paged_mode) return NULL;
+    size_t page = ((char*)ptr - memory_pool) >> MEM_MAP_SHIFT;
+    MemMapLeaf* leaf = map_leaf(page, 0);
+    if (!leaf) return NULL;
+    return atomic_load_explicit(&leaf->pages[(page & (MEM_MAP_LEAF - 1)) >> (MEM_PAGE_SHIFT - MEM_MAP_SHIFT)], memory_order_acquire);
+}
+
+// Frigör alla heapar och sidor, anropas från mem_deinit med memory_lock tagen
+static void paged_destroy(void) {
+    memset(retired_tag_bytes, 0, sizeof(retired_tag_bytes));
+    memset(retired_tag_count, 0, sizeof(retired_tag_count));
+    while (heap_list) {
+        MemHeap* heap = heap_list;
+        heap_list = heap->next;
+        for (int c = 0; c < MEM_SIZE_CLASSES; c++)
+            while (heap->pages[c]) {
+                MemPage* page = heap->pages[c];
+                heap->pages[c] = page->next;
+                free(page);
+            }
+        free(heap);
+    }
+    for (int c = 0; c < MEM_SIZE_CLASSES; c++)
+        while (abandoned_pages[c]) {
+            MemPage* page = abandoned_pages[c];
+            abandoned_pages[c] = page->next;
+            free(page);
+        }
+    paged_mode = 0;
+}
+
+// ********* Taggade allokeringar *********
+// Varje tråd räknar sina taggade allokeringar och frigöringar i sin egen heap utan atomära read-modify-write,
+// mem_tag_stats summerar alla heapar och avslutade trådar först när någon frågar
+// F: ingen delad cache-line på allokeringsvägen, N: summan är bara exakt när inga operationer pågår
+
+// Lägger till bytes och count för taggen i anropande tråds räknare
+static void tag_account(int tag, long long bytes, long long count) {
+    if (tag <= 0) return;
+    MemHeap* heap = heap_get();
+    if (!heap) return; // Heapen kunde inte skapas, allokeringen räknas inte
+    atomic_store_explicit(&heap->tag_bytes[tag],
+                          atomic_load_explicit(&heap->tag_bytes[tag], memory_order_relaxed) + bytes, memory_order_relaxed);
+    atomic_store_explicit(&heap->tag_count[tag],
+                          atomic_load_explicit(&heap->tag_count[tag], memory_order_relaxed) + count, memory_order_relaxed);
+}
+
+// Summerar taggens räknare över alla trådar, returnerar 0 eller -1 för en ogiltig tagg
+int mem_tag_stats(int tag, MemTagStats* stats) {
+    if (tag <= 0 || tag >= MEM_MAX_TAGS) return -1;
+    pthread_mutex_lock(&memory_lock); // Håller heap_list stilla, ägarna skriver vidare under tiden
+    stats->bytes = retired_tag_bytes[tag];
+    stats->count = retired_tag_count[tag];
+    for (MemHeap* heap = heap_list; heap; heap = heap->next) {
+        stats->bytes += atomic_load_explicit(&heap->tag_bytes[tag], memory_order_relaxed);
+        stats->count += atomic_load_explicit(&heap->tag_count[tag], memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&memory_lock);
+    return 0;
 }
 
 // Frigör ett tidigare allokerat minnesblock
-// Mutex skyddar både frigöring och sammanslagning (coalescing) av block
-// Detta förhindrar konflikter med samtidiga allokeringar eller andra frigöringar
+// Intervallets lås skyddar både frigöring och sammanslagning (coalescing) av block
+// Detta förhindrar konflikter med samtidiga allokeringar eller andra frigöringar i samma intervall
 void mem_free(void* ptr) {
-    if (!ptr) return;
+    if (!ptr || (char*)ptr < memory_pool || (char*)ptr >= memory_pool + pool_size) return;
 
-    pthread_mutex_lock(&memory_lock); // Kritisk sektion börjar - skyddar frigöring och coalescing
+    MemPage* page = page_of(ptr);
+    if (page) {
+        page_free_small(page, ptr);
+        return;
+    }
 
     // Hitta blocket genom att beräkna offset från poolens start
     size_t offset = (char*)ptr - memory_pool;
-    MemBlock* current = block_list;
-    MemBlock* prev = NULL;
-
-    // Sök efter blocket som matchar denna offset
-    while (current) {
-        if (current->offset == offset) {
-            current->is_free = 1; // Blocket är nu ledigt
-            
-            // Coalescing framåt: Slå samman med nästa block om möjligt
-            // Detta förhindrar fragmentering genom att kombinera närliggande lediga block
-            if (current->next && current->next->is_free && 
-                current->offset + current->size == current->next->offset) {
-                MemBlock* next_block = current->next;
-                current->size += next_block->size;
-                current->next = next_block->next;
-                free(next_block); // Ta bort den överflödiga blocknoden
-            }
-            
-            // Coalescing bakåt: Slå samman med föregående block om möjligt
-            if (prev && prev->is_free && 
-                prev->offset + prev->size == current->offset) {
-                prev->size += current->size;
-                prev->next = current->next;
-                free(current); // Ta bort den överflödiga blocknoden
-            }
-            
-            break; // Block hittat och friggjort
-        }
-        prev = current;
-        current = current->next;
+    MemRange* range = range_of(offset);
+
+    pthread_mutex_lock(&range->lock); // Kritisk sektion börjar - skyddar frigöring och coalescing
+
+    MemBlock* current = range_find(range, offset);
+    if (current && current->span) {
+        // Allokeringen fortsätter i nästa intervall - låses om till alla intervall
+        pthread_mutex_unlock(&range->lock);
+        mem_free_spanning(offset);
+        return;
+    }
+    int tag = 0, bucket = 0;
+    size_t freed = 0;
+    uint64_t sampled_at = 0;
+    if (current && !current->is_free) {
+        tag = current->tag;
+        freed = current->size;
+        sampled_at = current->sampled_at;
+        bucket = current->sample_bucket;
+        range_free_block(range, current);
+    }
+
+    range_publish(range);
+    pthread_mutex_unlock(&range->lock); // Kritisk sektion slut - frigöring och coalescing klart
+    if (tag) tag_account(tag, -(long long)freed, -1);
+    if (sampled_at) sample_free(bucket, sampled_at);
+}
+
+// Storleken på allokeringen som ptr pekar på, 0 för pekare som inte är början på ett allokerat block
+// Block från en sida rapporterar klassens storlek, som kan vara större än den begärda
+size_t mem_size(void* ptr) {
+    if (!ptr || (char*)ptr < memory_pool || (char*)ptr >= memory_pool + pool_size) return 0;
+
+    MemPage* page = page_of(ptr);
+    if (page) {
+        size_t position = (char*)ptr - page->start;
+        size_t slot = position / page->block_size;
+        if (position % page->block_size || slot >= page->capacity) return 0;
+        // Lediga och aldrig utdelade block ger 0 som i blockallokatorn
+        return atomic_load_explicit(&page->live[slot >> 6], memory_order_relaxed) >> (slot & 63) & 1 ? page->block_size : 0;
+    }
+
+    size_t offset = (char*)ptr - memory_pool;
+    MemRange* range = range_of(offset);
+    pthread_mutex_lock(&range->lock);
+    MemBlock* block = range_find(range, offset);
+    size_t size = block && !block->is_free ? (block->span ? block->span : block->size) : 0;
+    pthread_mutex_unlock(&range->lock);
+    return size;
+}
+
+// Kopiering när mem_resize måste flytta ett block
+// Stora block kopieras med non-temporal stores som går förbi cachen, så att flytten inte tränger undan
+// andra trådars arbetsdata. Under tröskeln är memcpy bättre eftersom blocket oftast används direkt efteråt.
+#define MEM_STREAM_THRESHOLD (256 * 1024)
+
+#if defined(__x86_64__) || defined(__i386__)
+// AVX2 finns inte i CFLAGS, funktionen kompileras separat och väljs vid körning
+__attribute__((target("avx2")))
+static void mem_copy_stream_avx2(char* dst, const char* src, size_t n) {
+    // Streaming stores kräver alignad destination, början kopieras vanligt fram till 32-bytesgränsen
+    size_t head = (32 - ((size_t)dst & 31)) & 31;
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    n -= head;
+    for (; n >= 128; n -= 128, dst += 128, src += 128) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)src);
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i*)(src + 64));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(src + 96));
+        _mm256_stream_si256((__m256i*)dst, a);
+        _mm256_stream_si256((__m256i*)(dst + 32), b);
+        _mm256_stream_si256((__m256i*)(dst + 64), c);
+        _mm256_stream_si256((__m256i*)(dst + 96), d);
     }
-    pthread_mutex_unlock(&memory_lock); // Kritisk sektion slut - frigöring och coalescing klart
+    memcpy(dst, src, n);
+    _mm_sfence(); // Streaming stores är svagt ordnade - de måste vara klara innan blocket lämnas ut
+}
+#endif
+
+#ifdef __SSE2__
+static void mem_copy_stream_sse2(char* dst, const char* src, size_t n) {
+    size_t head = (16 - ((size_t)dst & 15)) & 15;
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    n -= head;
+    for (; n >= 64; n -= 64, dst += 64, src += 64) {
+        __m128i a = _mm_loadu_si128((const __m128i*)src);
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(src + 32));
+        __m128i d = _mm_loadu_si128((const __m128i*)(src + 48));
+        _mm_stream_si128((__m128i*)dst, a);
+        _mm_stream_si128((__m128i*)(dst + 16), b);
+        _mm_stream_si128((__m128i*)(dst + 32), c);
+        _mm_stream_si128((__m128i*)(dst + 48), d);
+    }
+    memcpy(dst, src, n);
+    _mm_sfence();
+}
+#endif
+
+static void mem_copy(void* dst, const void* src, size_t n) {
+    if (n < MEM_STREAM_THRESHOLD) {
+        memcpy(dst, src, n);
+        return;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        mem_copy_stream_avx2((char*)dst, (const char*)src, n);
+        return;
+    }
+#endif
+#ifdef __SSE2__
+    mem_copy_stream_sse2((char*)dst, (const char*)src, n);
+#else
+    // Skalär reserv
+    memcpy(dst, src, n);
+#endif
 }
 
 // Ändrar storleken på ett tidigare allokerat block
@@ -160,80 +1472,514 @@ void* mem_resize(void* ptr, size_t size) {
         return NULL;
     }
 
-    pthread_mutex_lock(&memory_lock); // Kritisk sektion börjar - inspekterar blocket
+    if ((char*)ptr < memory_pool || (char*)ptr >= memory_pool + pool_size) return NULL;
+
+    // Block från en sida har fast storlek, större storlek flyttar blocket
+    MemPage* page = page_of(ptr);
+    if (page) {
+        if (size <= page->block_size) return ptr;
+        void* new_ptr = mem_alloc(size);
+        if (new_ptr) {
+            memcpy(new_ptr, ptr, page->block_size);
+            mem_free(ptr);
+        }
+        return new_ptr;
+    }
 
     // Hitta blocket som ska ändra storlek
     size_t offset = (char*)ptr - memory_pool;
-    MemBlock* current = block_list;
-    
-    while (current) {
-        if (current->offset == offset) {
-            // Fall 1: Nuvarande block är tillräckligt stort (krympa eller behåll)
-            if (current->size >= size) {
-                // In-place shrinking: Dela upp blocket om det är större än behövt
-                if (current->size > size) {
-                    MemBlock* new_block = (MemBlock*)malloc(sizeof(MemBlock));
-                    if (new_block) {
-                        // Skapa ett ledigt block från överskottet
-                        new_block->offset = current->offset + size;
-                        new_block->size = current->size - size;
-                        new_block->is_free = 1;
-                        new_block->next = current->next;
-                        
-                        current->size = size;
-                        current->next = new_block;
-                    }
-                }
-                pthread_mutex_unlock(&memory_lock); // Kritisk sektion slut - resize på plats lyckades
-                return ptr; // Samma pekare, ändrad storlek
-            } else {
-                // Fall 2: Nuvarande block är för litet - behöver allokera nytt och flytta data
-                // VIKTIGT: Lås upp före mem_alloc/mem_free för att undvika deadlock
-                size_t old_size = current->size;
-                pthread_mutex_unlock(&memory_lock); // Måste låsa upp innan rekursiva anrop
-                
-                // Allokera nytt block (denna funktion låser internt)
-                void* new_ptr = mem_alloc(size);
-                if (new_ptr) {
-                    memcpy(new_ptr, ptr, old_size); // Kopiera data från gammalt till nytt block
-                    mem_free(ptr); // Frigör gammalt block (denna funktion låser internt)
-                }
-                return new_ptr; // Returnera ny pekare eller NULL vid fel
+    MemRange* range = range_of(offset);
+
+    pthread_mutex_lock(&range->lock); // Kritisk sektion börjar - inspekterar blocket
+
+    MemBlock* current = range_find(range, offset);
+    if (!current) {
+        // Felhantering: Blocket hittades inte i listan
+        pthread_mutex_unlock(&range->lock); // Kritisk sektion slut
+        return NULL;
+    }
+
+    size_t old_size = current->span ? current->span : current->size;
+    int tag = current->tag; // Ändrad storlek räknas på taggen, en flytt behåller taggen
+    if (current->span && old_size >= size) {
+        // Allokeringar över flera intervall krymps inte på plats, överskottet ligger kvar tills blocket frigörs
+        pthread_mutex_unlock(&range->lock);
+        return ptr;
+    } else if (!current->span && current->size >= size) {
+        // Fall 1: Nuvarande block är tillräckligt stort (krympa eller behåll)
+        // In-place shrinking: Dela upp blocket om det är större än behövt
+        MemBlock* next_block = current->next;
+        if (current->size > size && next_block && next_block->is_free &&
+            current->offset + current->size == next_block->offset) {
+            // Nästa block är ledigt - överskottet läggs till det i stället för att bli ett eget block
+            size_t pos = free_index_find(range, next_block->offset);
+            map_remove(next_block);
+            next_block->offset = current->offset + size;
+            next_block->size += current->size - size;
+            current->size = size;
+            map_add(range, next_block);
+            free_index_set(range, pos, next_block);
+            page_bits_free(range, next_block);
+        } else {
+            MemBlock* new_block = NULL;
+            if (current->size > size && free_index_reserve(range, range->block_count + 1) == 0)
+                new_block = block_new(range);
+            if (new_block) {
+                // Skapa ett ledigt block från överskottet
+                new_block->offset = current->offset + size;
+                new_block->size = current->size - size;
+                new_block->is_free = 1;
+                new_block->span = 0;
+                new_block->next = current->next;
+                new_block->prev = current;
+                if (new_block->next) new_block->next->prev = new_block;
+
+                current->size = size;
+                current->next = new_block;
+                range->block_count++;
+                map_add(range, new_block);
+                free_index_insert(range, free_index_find(range, new_block->offset), new_block);
+                page_bits_free(range, new_block);
             }
         }
-        current = current->next;
+        size_t new_size = current->size;
+        range_publish(range);
+        pthread_mutex_unlock(&range->lock); // Kritisk sektion slut - resize på plats lyckades
+        if (tag) tag_account(tag, (long long)new_size - (long long)old_size, 0);
+        return ptr; // Samma pekare, ändrad storlek
+    } else if (!current->span && current->next && current->next->is_free &&
+               current->offset + current->size == current->next->offset &&
+               current->size + current->next->size >= size) {
+        // Fall 2: Nästa block är ledigt och tillräckligt stort - väx på plats utan kopiering
+        // Nästa block ligger alltid i samma intervall eftersom block inte korsar intervallgränser
+        MemBlock* next_block = current->next;
+        size_t pos = free_index_find(range, next_block->offset);
+        size_t remaining = current->size + next_block->size - size;
+        map_remove(next_block);
+        if (remaining > 0) {
+            // Flytta det lediga blockets början förbi den nya storleken
+            next_block->offset = current->offset + size;
+            next_block->size = remaining;
+            current->size = size;
+            map_add(range, next_block);
+            free_index_set(range, pos, next_block);
+        } else {
+            // Grannblocket förbrukas helt
+            current->size = size;
+            current->next = next_block->next;
+            if (current->next) current->next->prev = current;
+            block_delete(range, next_block);
+            range->block_count--;
+            free_index_remove(range, pos);
+        }
+        page_bits_use(range, current->offset, size);
+        range_publish(range);
+        pthread_mutex_unlock(&range->lock); // Kritisk sektion slut - tillväxt på plats lyckades
+        if (tag) tag_account(tag, (long long)size - (long long)old_size, 0);
+        return ptr;
+    }
+
+    // Fall 3: Nuvarande block är för litet - behöver allokera nytt och flytta data
+    // VIKTIGT: Lås upp före mem_alloc/mem_free för att undvika deadlock
+    pthread_mutex_unlock(&range->lock); // Måste låsa upp innan rekursiva anrop
+
+    // Allokera nytt block (denna funktion låser internt)
+    // Kopieringen sker utan lås och det gamla blocket frigörs först när den är klar
+    void* new_ptr = mem_alloc_tagged(size, tag);
+    if (new_ptr) {
+        mem_copy(new_ptr, ptr, old_size); // Kopiera data från gammalt till nytt block
+        mem_free(ptr); // Frigör gammalt block (denna funktion låser internt)
     }
-    
-    // Felhantering: Blocket hittades inte i listan
-    pthread_mutex_unlock(&memory_lock); // Kritisk sektion slut
+    return new_ptr; // Returnera ny pekare eller NULL vid fel
+}
+
+// Rör varje OS-sida i [start, start + size) så att sidfelen tas nu i stället för vid första allokeringen
+// MADV_POPULATE_WRITE mappar in sidorna utan att ändra innehållet, annars skrivs varje sida med en atomär or 0
+// som inte heller ändrar något även om området redan används
+static void prefault_touch(char* start, size_t size) {
+    size_t os_page = (size_t)sysconf(_SC_PAGESIZE);
+    char* first = (char*)((size_t)start & ~(os_page - 1));
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(first, start + size - first, MADV_POPULATE_WRITE) == 0) return;
+#endif
+    for (char* p = first; p < start + size; p += os_page)
+        __atomic_fetch_or(p < start ? start : p, 0, __ATOMIC_RELAXED);
+}
+
+typedef struct {
+    char* start;
+    size_t size;
+} PrefaultChunk;
+
+static void* prefault_worker(void* arg) {
+    PrefaultChunk* chunk = (PrefaultChunk*)arg;
+    prefault_touch(chunk->start, chunk->size);
     return NULL;
 }
 
+// Delar området mellan en tråd per CPU (minst MEM_PREFAULT_CHUNK per tråd), anropande tråd tar första delen
+static void prefault_parallel(char* start, size_t size) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t num_threads = cpus > 0 ? (size_t)cpus : 1;
+    if (num_threads > size / MEM_PREFAULT_CHUNK) num_threads = size / MEM_PREFAULT_CHUNK > 0 ? size / MEM_PREFAULT_CHUNK : 1;
+    if (num_threads > 64) num_threads = 64;
+
+    pthread_t threads[64];
+    PrefaultChunk chunks[64];
+    size_t part = size / num_threads;
+    size_t started = 0;
+    for (size_t i = 0; i < num_threads; i++) {
+        chunks[i].start = start + i * part;
+        chunks[i].size = i == num_threads - 1 ? size - i * part : part;
+        if (i > 0 && pthread_create(&threads[started], NULL, prefault_worker, &chunks[i]) == 0) {
+            started++;
+            continue;
+        }
+        if (i > 0) prefault_touch(chunks[i].start, chunks[i].size); // Tråden kunde inte skapas
+    }
+    prefault_touch(chunks[0].start, chunks[0].size);
+    for (size_t i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+}
+
+// Förfelar [start, start + size) eller hela poolen om start är NULL
+// Returnerar 0 vid lyckat anrop, -1 om poolen inte är initierad eller området ligger utanför den
+int mem_prefault(void* start, size_t size) {
+    if (!memory_pool) return -1;
+    if (!start) {
+        start = memory_pool;
+        size = pool_size;
+    }
+    if ((char*)start < memory_pool || size > pool_size || (size_t)((char*)start - memory_pool) > pool_size - size) {
+        fprintf(stderr, "Error: Prefault range is outside the memory pool\n");
+        return -1;
+    }
+    if (size > 0) prefault_parallel((char*)start, size);
+    return 0;
+}
+
+// Uppvärmning i mem_init när MemOptions.prefault är satt, anropas med memory_lock tagen
+// Hela poolen förfelas parallellt, sidkartan får alla sina löv, varje intervall får slabbar och index för en nod per 16 KiB,
+// och i sidindelat läge läggs färdiga tomma sidor per storleksklass ut för heaparna att ta över
+static void mem_warm_up(void) {
+    prefault_parallel(memory_pool, pool_size);
+
+    // Sidkartans alla löv skapas direkt
+    for (size_t i = 0; i < page_map_leaves; i++)
+        map_leaf(i << MEM_MAP_LEAF_BITS, 1);
+
+    for (int i = 0; i < num_ranges; i++) {
+        MemRange* range = &ranges[i];
+        size_t blocks = (range->end - range->start) / (16 * 1024);
+        for (size_t s = 1; s < blocks / MEM_SLAB_BLOCKS; s++) // range_init har redan lagt till en slab
+            if (block_slab_add(range) != 0) break;
+        if (free_index_reserve(range, blocks) == 0) {
+            // Den oanvända delen av indexet skrivs också så att den är inmappad
+            size_t unused = range->free_capacity - range->free_count;
+            memset(range->free_offsets + range->free_count, 0, unused * sizeof(size_t));
+            memset(range->free_sizes + range->free_count, 0, unused * sizeof(size_t));
+            memset(range->free_blocks + range->free_count, 0, unused * sizeof(MemBlock*));
+        }
+    }
+
+    if (paged_mode) {
+        // En sida per klass och CPU, högst en fjärdedel av poolen
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        size_t per_class = cpus > 0 ? (size_t)cpus : 1;
+        if (per_class * MEM_SIZE_CLASSES * MEM_PAGE_SIZE > pool_size / 4)
+            per_class = pool_size / 4 / (MEM_SIZE_CLASSES * MEM_PAGE_SIZE);
+        for (size_t i = 0; i < per_class; i++)
+            for (int c = 0; c < MEM_SIZE_CLASSES; c++) {
+                MemPage* page = page_new(c);
+                if (!page) return;
+                page->next = abandoned_pages[c];
+                abandoned_pages[c] = page;
+            }
+    }
+}
+
+// ********* Checkpoint och återställning *********
+// Filformat: CheckpointHeader, en CheckpointBlock per allokerat block i offsetordning,
+// sedan innehållet i de allokerade blocken i samma ordning. Lediga områden skrivs inte.
+// Pekare som lagras i poolen är bara giltiga efter mem_restore om poolen ligger på samma adress
+
+#define CHECKPOINT_MAGIC "MEMCKPT2"
+
+typedef struct {
+    char magic[8];
+    uint64_t pool_size;
+    uint64_t num_ranges;
+    uint64_t num_blocks; // Antal CheckpointBlock
+    uint64_t data_bytes; // Summan av blockens storlekar
+} CheckpointHeader;
+
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t span;
+    uint64_t tag;
+} CheckpointBlock;
+
+static int write_all(int fd, const void* buffer, size_t size) {
+    const char* p = (const char*)buffer;
+    while (size > 0) {
+        ssize_t written = write(fd, p, size);
+        if (written < 0) return -1;
+        p += written;
+        size -= written;
+    }
+    return 0;
+}
+
+// Skriver poolens allokerade block till path, returnerar 0 eller -1
+// Alla intervall är låsta under skrivningen så att bilden blir konsistent
+// Angränsande allokerade block skrivs med ett enda write
+int mem_checkpoint(const char* path) {
+    if (!memory_pool || paged_mode) {
+        fprintf(stderr, "Error: Checkpoint needs an initialized pool that is not in paged mode\n");
+        return -1;
+    }
+
+    lock_all_ranges();
+
+    CheckpointHeader header = {.pool_size = pool_size, .num_ranges = num_ranges};
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    for (int i = 0; i < num_ranges; i++)
+        for (MemBlock* block = ranges[i].block_list; block; block = block->next)
+            if (!block->is_free) {
+                header.num_blocks++;
+                header.data_bytes += block->size;
+            }
+
+    CheckpointBlock* blocks = (CheckpointBlock*)malloc((header.num_blocks ? header.num_blocks : 1) * sizeof(CheckpointBlock));
+    int fd = blocks ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    if (fd < 0) {
+        fprintf(stderr, "Error: Could not create checkpoint %s\n", path);
+        free(blocks);
+        unlock_all_ranges();
+        return -1;
+    }
+
+    size_t count = 0;
+    for (int i = 0; i < num_ranges; i++)
+        for (MemBlock* block = ranges[i].block_list; block; block = block->next)
+            if (!block->is_free)
+                blocks[count++] = (CheckpointBlock){block->offset, block->size, block->span, (uint64_t)block->tag};
+
+    int result = write_all(fd, &header, sizeof(header));
+    if (result == 0) result = write_all(fd, blocks, count * sizeof(CheckpointBlock));
+
+    // Innehållet skrivs som sammanhängande körningar av allokerade block
+    for (size_t i = 0; i < count && result == 0;) {
+        size_t start = blocks[i].offset;
+        size_t end = start + blocks[i].size;
+        for (i++; i < count && blocks[i].offset == end; i++)
+            end += blocks[i].size;
+        result = write_all(fd, memory_pool + start, end - start);
+    }
+
+    if (close(fd) != 0) result = -1;
+    if (result != 0) fprintf(stderr, "Error: Could not write checkpoint %s\n", path);
+    free(blocks);
+    unlock_all_ranges();
+    return result;
+}
+
+// Bygger om ett intervalls blocklista och index från de sorterade posterna som börjar i intervallet
+// Luckor mellan posterna blir lediga block
+static int range_rebuild(MemRange* range, const CheckpointBlock* blocks, size_t count) {
+    // Alla gamla noder tillbaka till slabbarnas reserv
+    while (range->block_list) {
+        MemBlock* next = range->block_list->next;
+        block_delete(range, range->block_list);
+        range->block_list = next;
+    }
+    range->block_count = 0;
+    range->free_count = 0;
+    range->free_bytes = 0;
+    range->largest_free = 0;
+    range->largest_dirty = 0;
+
+    // Intervallets poster i sidkartan och sidbitmappen nollas, blocken läggs in igen nedan
+    range->map_broken = 0;
+    if (range->page_bits) {
+        memset(range->page_bits, 0, range->page_words * sizeof(uint64_t));
+        memset(range->page_summary, 0, (range->page_words + 63) / 64 * sizeof(uint64_t));
+    }
+    for (size_t page = range->start >> MEM_MAP_SHIFT; page << MEM_MAP_SHIFT < range->end; page++) {
+        MemMapLeaf* leaf = map_leaf(page, 0);
+        if (leaf) leaf->blocks[page & (MEM_MAP_LEAF - 1)] = NULL;
+    }
+
+    MemBlock** tail = &range->block_list;
+    MemBlock* last = NULL;
+    size_t offset = range->start;
+    for (size_t i = 0; i <= count; i++) {
+        size_t next = i < count ? blocks[i].offset : range->end;
+        for (int allocated = 0; allocated < 2; allocated++) {
+            size_t size = allocated ? (i < count ? blocks[i].size : 0) : next - offset;
+            if (size == 0) continue;
+            MemBlock* block = block_new(range);
+            if (!block || free_index_reserve(range, range->block_count + 1) != 0) return -1;
+            block->offset = offset;
+            block->size = size;
+            block->is_free = !allocated;
+            block->span = allocated ? blocks[i].span : 0;
+            block->tag = allocated ? (int)blocks[i].tag : 0;
+            block->sampled_at = 0; // Samplingen följer inte med en checkpoint
+            block->next = NULL;
+            block->prev = last;
+            *tail = block;
+            tail = &block->next;
+            last = block;
+            range->block_count++;
+            map_add(range, block);
+            if (!allocated) {
+                free_index_insert(range, range->free_count, block);
+                page_bits_free(range, block);
+            }
+            offset += size;
+        }
+    }
+    return 0;
+}
+
+// Återställer poolen från en checkpoint, returnerar 0 eller -1
+// Poolen måste vara initierad med samma storlek och antal intervall och inte vara sidindelad.
+// Filen valideras helt innan något ändras, innehållet läses med en enda mmap av filen.
+int mem_restore(const char* path) {
+    if (!memory_pool || paged_mode) {
+        fprintf(stderr, "Error: Restore needs an initialized pool that is not in paged mode\n");
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CheckpointHeader)) {
+        fprintf(stderr, "Error: Could not read checkpoint %s\n", path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    char* file = (char*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED) {
+        fprintf(stderr, "Error: Could not map checkpoint %s\n", path);
+        return -1;
+    }
+
+    lock_all_ranges();
+
+    // Validering: rätt pool, rätt filstorlek, sorterade block som inte överlappar eller korsar intervallgränser
+    const CheckpointHeader* header = (const CheckpointHeader*)file;
+    const CheckpointBlock* blocks = (const CheckpointBlock*)(file + sizeof(CheckpointHeader));
+    int valid = memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) == 0 &&
+                header->pool_size == pool_size && header->num_ranges == (uint64_t)num_ranges &&
+                header->num_blocks <= pool_size && header->data_bytes <= pool_size &&
+                (size_t)st.st_size == sizeof(CheckpointHeader) + header->num_blocks * sizeof(CheckpointBlock) + header->data_bytes;
+    // En spännande allokering är ett block med span följt av otaggade delar utan span som fyller
+    // intervallen efter, precis fram till offset + span - som mem_alloc_spanning lägger dem
+    size_t end = 0, data_bytes = 0, span_end = 0;
+    for (size_t i = 0; valid && i < header->num_blocks; i++) {
+        size_t offset = blocks[i].offset, size = blocks[i].size;
+        if (size == 0 || blocks[i].tag >= MEM_MAX_TAGS || offset < end || size > pool_size - offset ||
+            offset + size > range_of(offset)->end || (end < span_end && offset != end)) {
+            valid = 0;
+            break;
+        }
+        if (offset < span_end) {
+            // Fortsättning: börjar i intervallets början och fyller det om allokeringen går vidare
+            valid = offset == range_of(offset)->start && blocks[i].span == 0 && blocks[i].tag == 0 &&
+                    (offset + size == span_end || (offset + size < span_end && offset + size == range_of(offset)->end));
+        } else if (blocks[i].span) {
+            valid = blocks[i].span >= size && blocks[i].span <= pool_size - offset &&
+                    (blocks[i].span == size || offset + size == range_of(offset)->end);
+            span_end = offset + blocks[i].span;
+        }
+        end = offset + size;
+        data_bytes += size;
+    }
+    if (end < span_end) valid = 0; // Sista spännande allokeringen saknar delar
+    if (!valid || data_bytes != header->data_bytes) {
+        fprintf(stderr, "Error: Checkpoint %s does not match the memory pool\n", path);
+        unlock_all_ranges();
+        munmap(file, st.st_size);
+        return -1;
+    }
+
+    // Metadata per intervall
+    int result = 0;
+    size_t first = 0;
+    for (int r = 0; r < num_ranges; r++) {
+        size_t last = first;
+        while (last < header->num_blocks && blocks[last].offset < ranges[r].end) last++;
+        if (range_rebuild(&ranges[r], blocks + first, last - first) != 0) result = -1;
+        first = last;
+    }
+
+    // Innehållet kopieras från mappningen till blockens platser
+    // Taggsummorna räknas om från de återställda blocken, delar av en spännande allokering saknar tagg
+    long long tag_bytes[MEM_MAX_TAGS] = {0}, tag_count[MEM_MAX_TAGS] = {0};
+    const char* data = (const char*)(blocks + header->num_blocks);
+    for (size_t i = 0; i < header->num_blocks; i++) {
+        memcpy(memory_pool + blocks[i].offset, data, blocks[i].size);
+        data += blocks[i].size;
+        tag_bytes[blocks[i].tag] += blocks[i].span ? blocks[i].span : blocks[i].size;
+        tag_count[blocks[i].tag]++;
+    }
+
+    if (result != 0) fprintf(stderr, "Error: Out of memory while restoring %s\n", path);
+    unlock_all_ranges();
+    munmap(file, st.st_size);
+
+    // memory_lock tas först efter intervallen släppts, samma låsordning som i resten av filen
+    pthread_mutex_lock(&memory_lock);
+    memcpy(retired_tag_bytes, tag_bytes, sizeof(tag_bytes));
+    memcpy(retired_tag_count, tag_count, sizeof(tag_count));
+    for (MemHeap* heap = heap_list; heap; heap = heap->next)
+        for (int t = 1; t < MEM_MAX_TAGS; t++) {
+            atomic_store_explicit(&heap->tag_bytes[t], 0, memory_order_relaxed);
+            atomic_store_explicit(&heap->tag_count[t], 0, memory_order_relaxed);
+        }
+    pthread_mutex_unlock(&memory_lock);
+    return result;
+}
+
 // Stänger ner minneshanteraren och frigör alla resurser
 // Låser under hela nedstängningen för att förhindra samtidig access
 // Kallas typiskt endast en gång vid programavslut
 void mem_deinit() {
     pthread_mutex_lock(&memory_lock); // Kritisk sektion börjar - serialiserar nedstängning
 
+    // Trådlokala heapar blir ogiltiga, så en tråd som avslutas efteråt rör inte de frigjorda heaparna och sidorna
+    atomic_fetch_add(&pool_generation, 1);
+
     // Frigör själva minnespoolen
     if (memory_pool) {
         free(memory_pool);
         memory_pool = NULL;
     }
 
-    // Frigör alla blocknoder i den länkade listan
-    MemBlock* current = block_list;
-    while (current) {
-        MemBlock* next = current->next;
-        free(current);
-        current = next;
-    }
+    // Frigör heapar med taggräknare och i sidindelat läge även sidbeskrivningarna
+    paged_destroy();
+
+    // Frigör alla intervall med deras blocklistor och index
+    for (int i = 0; i < num_ranges; i++)
+        range_destroy(&ranges[i]);
+    free(ranges);
+
+    // Frigör sidkartans löv och rot
+    for (size_t i = 0; page_map && i < page_map_leaves; i++)
+        free(atomic_load_explicit(&page_map[i], memory_order_relaxed));
+    free(page_map);
+    page_map = NULL;
+    page_map_leaves = 0;
 
     // Återställ alla globala variabler
-    block_list = NULL;
+    ranges = NULL;
+    num_ranges = 0;
+    range_size = 0;
     pool_size = 0;
 
     pthread_mutex_unlock(&memory_lock); // Kritisk sektion slut - nedstängning klar
     // OBS: Mutex förstörs inte här (skulle kräva pthread_mutex_destroy)
 }
-
@@ -3,14 +3,75 @@
 
 #include <stddef.h>
 
+// Ögonblicksbild av allokatorn, läses utan lås via mem_stats
+typedef struct {
+    size_t bytes_used;   // Summan av allokerade block
+    size_t free_blocks;  // Antal lediga block
+    size_t largest_free; // Största lediga block, den största allokering som kan lyckas
+} MemStats;
+
+// Taggar för mem_alloc_tagged är 1 till MEM_MAX_TAGS - 1, tagg 0 betyder otaggad och räknas inte
+#define MEM_MAX_TAGS 64
+
+// Summor för en tagg från mem_tag_stats
+typedef struct {
+    long long bytes; // Allokerade bytes med taggen
+    long long count; // Antal allokerade block med taggen
+} MemTagStats;
+
+// Histogram över samplade allokeringar från mem_size_histogram
+// Hink i rymmer storlekar i (2^(i-1), 2^i], hink 0 storlek 1. Antalen är sampel - gånger sample_rate ger en uppskattning
+#define MEM_HISTOGRAM_BUCKETS 48
+
+typedef struct {
+    size_t allocs;                  // Samplade allokeringar
+    size_t frees;                   // Samplade allokeringar som frigjorts
+    size_t bytes;                   // Summan av de samplade allokeringarnas storlek
+    unsigned long long lifetime_ns; // Summan av livslängden för de frigjorda
+} MemSizeBucket;
+
+typedef struct {
+    int sample_rate;
+    MemSizeBucket buckets[MEM_HISTOGRAM_BUCKETS];
+} MemHistogram;
+
+// Inställningar för mem_init_opts, nollställda fält ger samma beteende som mem_init
+typedef struct {
+    int num_ranges;  // Antal adressintervall med egna lås, begränsas så att varje intervall är minst 64 KiB
+    int paged;       // 1 = allokeringar upp till 1 KiB från sidor per storleksklass i trådlokala heapar
+    int prefault;    // 1 = förfela hela poolen och fyll metadatacachar redan i mem_init, fördelat på flera trådar
+    int sample_rate; // > 0: var sample_rate:e allokering per tråd registreras i storlekshistogrammet, 0 = av
+    int page_bitmap; // 1 = allokeringar på minst 4 KiB avrundas till hela sidor och placeras via en bitmapp över lediga sidor
+} MemOptions;
+
 void mem_init(size_t size);
 
+void mem_init_opts(size_t size, const MemOptions* options);
+
 void* mem_alloc(size_t size);
 
+void* mem_alloc_tagged(size_t size, int tag);
+
+void* mem_alloc_aligned(size_t size, size_t alignment);
+
 void mem_free(void* block);
 
 void* mem_resize(void* block, size_t size);
 
+size_t mem_size(void* block);
+
+void mem_stats(MemStats* stats);
+
+int mem_tag_stats(int tag, MemTagStats* stats);
+
+void mem_size_histogram(MemHistogram* histogram);
+
+int mem_prefault(void* start, size_t size);
+
+int mem_checkpoint(const char* path);
+
+int mem_restore(const char* path);
+
 void mem_deinit();
 
 #endif
@@ -0,0 +1,212 @@
+#include "mpmc_queue.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// Begränsad kö för flera producenter och konsumenter (Vyukov)
+// Varje slot har ett sekvensnummer som säger om den är ledig för en producent (seq == pos)
+// eller fylld för en konsument (seq == pos + 1). En CAS på enqueue_pos/dequeue_pos
+// reserverar sloten, sedan publiceras den med en release-store av sekvensnumret.
+// F: Ingen global mutex, producenter och konsumenter konkurrerar bara om varsin räknare
+// N: Blockerande varianter måste ändå falla tillbaka på mutex + condition variable vid väntan
+
+#define CACHE_LINE 64
+#define MPMC_SPIN_LIMIT 128 // Antal försök innan en blockerande operation somnar
+
+typedef struct {
+    atomic_size_t sequence;
+    // Elementdata följer direkt efter sekvensnumret
+} MpmcCell;
+
+struct MpmcQueue {
+    // Oföränderligt efter skapande
+    _Alignas(CACHE_LINE) char* cells;
+    size_t mask;
+    size_t elem_size;
+    size_t cell_size;
+
+    // Producenter och konsumenter har sina räknare på egna cache-lines
+    _Alignas(CACHE_LINE) atomic_size_t enqueue_pos;
+    _Alignas(CACHE_LINE) atomic_size_t dequeue_pos;
+
+    // Används bara av blockerande push/pop när kön är full respektive tom
+    _Alignas(CACHE_LINE) pthread_mutex_t wait_lock;
+    pthread_cond_t not_full;
+    pthread_cond_t not_empty;
+    atomic_int waiting_producers;
+    atomic_int waiting_consumers;
+};
+
+static inline MpmcCell* mpmc_cell(MpmcQueue* queue, size_t pos) {
+    return (MpmcCell*)(queue->cells + (pos & queue->mask) * queue->cell_size);
+}
+
+static inline void* mpmc_cell_data(MpmcCell* cell) {
+    return (char*)cell + sizeof(MpmcCell);
+}
+
+// Skapar en kö med plats för minst capacity element (avrundas upp till tvåpotens)
+// Struktur och slots allokeras som ett cache-line-alignat block ur minnespoolen
+MpmcQueue* mpmc_create(size_t capacity, size_t elem_size) {
+    if (capacity < 2 || elem_size == 0) {
+        fprintf(stderr, "Error: Invalid queue capacity or element size\n");
+        return NULL;
+    }
+
+    // Avrundningen till tvåpotens får inte slå runt, och huvud plus slots måste rymmas i size_t
+    size_t header = (sizeof(MpmcQueue) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    size_t cell_size = elem_size <= SIZE_MAX - sizeof(MpmcCell) - sizeof(size_t)
+                           ? (sizeof(MpmcCell) + elem_size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1)
+                           : 0;
+    size_t cap = 2;
+    if (capacity <= SIZE_MAX / 2 + 1)
+        while (cap < capacity) cap *= 2;
+    if (cell_size == 0 || cap < capacity || cap > (SIZE_MAX - header) / cell_size) {
+        fprintf(stderr, "Error: Queue capacity of %zu elements is too large\n", capacity);
+        return NULL;
+    }
+
+    char* block = (char*)mem_alloc_aligned(header + cap * cell_size, CACHE_LINE);
+    if (!block) {
+        fprintf(stderr, "Error: Could not allocate queue of %zu elements from memory pool\n", cap);
+        return NULL;
+    }
+
+    MpmcQueue* queue = (MpmcQueue*)block;
+    queue->cells = block + header;
+    queue->mask = cap - 1;
+    queue->elem_size = elem_size;
+    queue->cell_size = cell_size;
+
+    // Slot i är ledig för den producent som får position i
+    for (size_t i = 0; i < cap; i++)
+        atomic_init(&mpmc_cell(queue, i)->sequence, i);
+
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+    pthread_mutex_init(&queue->wait_lock, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    atomic_init(&queue->waiting_producers, 0);
+    atomic_init(&queue->waiting_consumers, 0);
+    return queue;
+}
+
+// Väcker en sovande tråd om någon väntar
+// Fence + läsning paras ihop med väntarens ökning av räknaren så att väckningen inte kan tappas
+static inline void mpmc_wake(MpmcQueue* queue, atomic_int* waiting, pthread_cond_t* cond) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiting, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&queue->wait_lock);
+        pthread_cond_signal(cond);
+        pthread_mutex_unlock(&queue->wait_lock);
+    }
+}
+
+static int mpmc_try_push_nowake(MpmcQueue* queue, const void* item) {
+    size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        MpmcCell* cell = mpmc_cell(queue, pos);
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            // Sloten är ledig - försök reservera positionen
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                memcpy(mpmc_cell_data(cell), item, queue->elem_size);
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                return 0;
+            }
+            // CAS misslyckades - pos har uppdaterats med aktuellt värde
+        } else if (diff < 0) {
+            return -1; // Sloten har ännu inte tömts ett varv tidigare - kön är full
+        } else {
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+static int mpmc_try_pop_nowake(MpmcQueue* queue, void* item) {
+    size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        MpmcCell* cell = mpmc_cell(queue, pos);
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                memcpy(item, mpmc_cell_data(cell), queue->elem_size);
+                // Sloten blir ledig för producenten ett varv senare
+                atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1; // Ingen producent har fyllt sloten - kön är tom
+        } else {
+            pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+// Icke-blockerande insättning, returnerar 0 eller -1 om kön är full
+int mpmc_try_push(MpmcQueue* queue, const void* item) {
+    if (mpmc_try_push_nowake(queue, item) != 0) return -1;
+    mpmc_wake(queue, &queue->waiting_consumers, &queue->not_empty);
+    return 0;
+}
+
+// Icke-blockerande uttag, returnerar 0 eller -1 om kön är tom
+int mpmc_try_pop(MpmcQueue* queue, void* item) {
+    if (mpmc_try_pop_nowake(queue, item) != 0) return -1;
+    mpmc_wake(queue, &queue->waiting_producers, &queue->not_full);
+    return 0;
+}
+
+// Blockerande insättning - spinner en kort stund och somnar sedan tills en konsument frigjort en slot
+void mpmc_push(MpmcQueue* queue, const void* item) {
+    for (int spin = 0; spin < MPMC_SPIN_LIMIT; spin++)
+        if (mpmc_try_push(queue, item) == 0) return;
+
+    pthread_mutex_lock(&queue->wait_lock);
+    atomic_fetch_add(&queue->waiting_producers, 1);
+    // Nytt försök efter registreringen - en konsument som tömt en slot innan dess syns här
+    while (mpmc_try_push_nowake(queue, item) != 0)
+        pthread_cond_wait(&queue->not_full, &queue->wait_lock);
+    atomic_fetch_sub(&queue->waiting_producers, 1);
+    pthread_mutex_unlock(&queue->wait_lock);
+
+    mpmc_wake(queue, &queue->waiting_consumers, &queue->not_empty);
+}
+
+// Blockerande uttag - spinner en kort stund och somnar sedan tills en producent fyllt en slot
+void mpmc_pop(MpmcQueue* queue, void* item) {
+    for (int spin = 0; spin < MPMC_SPIN_LIMIT; spin++)
+        if (mpmc_try_pop(queue, item) == 0) return;
+
+    pthread_mutex_lock(&queue->wait_lock);
+    atomic_fetch_add(&queue->waiting_consumers, 1);
+    while (mpmc_try_pop_nowake(queue, item) != 0)
+        pthread_cond_wait(&queue->not_empty, &queue->wait_lock);
+    atomic_fetch_sub(&queue->waiting_consumers, 1);
+    pthread_mutex_unlock(&queue->wait_lock);
+
+    mpmc_wake(queue, &queue->waiting_producers, &queue->not_full);
+}
+
+size_t mpmc_capacity(MpmcQueue* queue) {
+    return queue->mask + 1;
+}
+
+// Lämnar tillbaka kön till minnespoolen, får bara anropas när inga trådar använder den
+void mpmc_destroy(MpmcQueue* queue) {
+    if (!queue) return;
+    pthread_mutex_destroy(&queue->wait_lock);
+    pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->not_empty);
+    mem_free(queue);
+}
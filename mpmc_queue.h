@@ -0,0 +1,22 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <stddef.h>
+
+typedef struct MpmcQueue MpmcQueue;
+
+MpmcQueue* mpmc_create(size_t capacity, size_t elem_size);
+
+int mpmc_try_push(MpmcQueue* queue, const void* item);
+
+int mpmc_try_pop(MpmcQueue* queue, void* item);
+
+void mpmc_push(MpmcQueue* queue, const void* item);
+
+void mpmc_pop(MpmcQueue* queue, void* item);
+
+size_t mpmc_capacity(MpmcQueue* queue);
+
+void mpmc_destroy(MpmcQueue* queue);
+
+#endif
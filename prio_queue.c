@@ -0,0 +1,209 @@
+#include "prio_queue.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// Relaxerad prioritetskö (MultiQueue): flera binära heapar med var sitt lås
+// Insättning går till en slumpvis heap, delete-min jämför toppen på två slumpvisa heapar
+// och tar den minsta. Resultatet är inte strikt minsta elementet globalt, men nära,
+// och trådar krockar sällan eftersom de sprids över olika lås.
+// F: O(log n) per operation och låg konkurrens, N: ordningen är bara ungefärlig när num_queues > 1
+
+#define CACHE_LINE 64
+#define PRIO_EMPTY UINT32_MAX     // Toppvärde för en tom heap
+#define PRIO_MIN_CAPACITY 16
+#define PRIO_DELETE_ATTEMPTS 8    // Slumpvisa försök innan delete-min söker igenom alla heapar
+
+typedef struct {
+    uint16_t priority;
+    uint32_t value;
+} PrioEntry;
+
+typedef struct {
+    _Alignas(CACHE_LINE) pthread_mutex_t lock;
+    atomic_uint top;    // Minsta prioriteten eller PRIO_EMPTY - läses utan lås vid val av heap
+    PrioEntry* entries; // Binär heap i minnespoolen, växer med mem_resize
+    size_t len;
+    size_t capacity;
+} PrioHeap;
+
+struct PrioQueue {
+    PrioHeap* heaps;    // num_queues heapar, varje på egen cache-line
+    size_t num_queues;
+    atomic_size_t size;
+};
+
+// Trådlokal xorshift - billig slump utan delat tillstånd
+static _Thread_local uint32_t prio_seed = 0;
+
+static inline uint32_t prio_random(void) {
+    if (prio_seed == 0) prio_seed = (uint32_t)(size_t)&prio_seed | 1;
+    prio_seed ^= prio_seed << 13;
+    prio_seed ^= prio_seed >> 17;
+    prio_seed ^= prio_seed << 5;
+    return prio_seed;
+}
+
+static void prio_sift_up(PrioEntry* entries, size_t i) {
+    PrioEntry entry = entries[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (entries[parent].priority <= entry.priority) break;
+        entries[i] = entries[parent];
+        i = parent;
+    }
+    entries[i] = entry;
+}
+
+static void prio_sift_down(PrioEntry* entries, size_t len, size_t i) {
+    PrioEntry entry = entries[i];
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= len) break;
+        if (child + 1 < len && entries[child + 1].priority < entries[child].priority) child++;
+        if (entry.priority <= entries[child].priority) break;
+        entries[i] = entries[child];
+        i = child;
+    }
+    entries[i] = entry;
+}
+
+static inline void prio_update_top(PrioHeap* heap) {
+    atomic_store_explicit(&heap->top, heap->len ? heap->entries[0].priority : PRIO_EMPTY, memory_order_release);
+}
+
+// Skapar num_queues heapar med plats för capacity element totalt innan någon måste växa
+// Ett bra val är två heapar per tråd som använder kön
+PrioQueue* prio_create(size_t num_queues, size_t capacity) {
+    if (num_queues == 0) num_queues = 1;
+
+    PrioQueue* queue = (PrioQueue*)malloc(sizeof(PrioQueue));
+    if (!queue) {
+        fprintf(stderr, "Error: Memory allocation failed in prio_create.\n");
+        return NULL;
+    }
+
+    queue->heaps = (PrioHeap*)mem_alloc_aligned(num_queues * sizeof(PrioHeap), CACHE_LINE);
+    if (!queue->heaps) {
+        fprintf(stderr, "Error: Could not allocate %zu heaps from memory pool\n", num_queues);
+        free(queue);
+        return NULL;
+    }
+    queue->num_queues = num_queues;
+    atomic_init(&queue->size, 0);
+
+    size_t per_heap = capacity / num_queues;
+    if (per_heap < PRIO_MIN_CAPACITY) per_heap = PRIO_MIN_CAPACITY;
+
+    for (size_t i = 0; i < num_queues; i++) {
+        PrioHeap* heap = &queue->heaps[i];
+        pthread_mutex_init(&heap->lock, NULL);
+        atomic_init(&heap->top, PRIO_EMPTY);
+        heap->len = 0;
+        heap->capacity = per_heap;
+        heap->entries = (PrioEntry*)mem_alloc(per_heap * sizeof(PrioEntry));
+        if (!heap->entries) {
+            fprintf(stderr, "Error: Could not allocate heap storage from memory pool\n");
+            queue->num_queues = i + 1;
+            prio_destroy(queue);
+            return NULL;
+        }
+    }
+    return queue;
+}
+
+// Lägger in ett element i en slumpvis heap
+// trylock låter tråden byta heap istället för att vänta när någon annan håller låset
+// Returnerar 0 eller -1 om heapen inte kunde växa
+int prio_insert(PrioQueue* queue, uint16_t priority, uint32_t value) {
+    PrioHeap* heap = &queue->heaps[0];
+    if (queue->num_queues == 1) {
+        pthread_mutex_lock(&heap->lock);
+    } else {
+        do {
+            heap = &queue->heaps[prio_random() % queue->num_queues];
+        } while (pthread_mutex_trylock(&heap->lock) != 0);
+    }
+
+    if (heap->len == heap->capacity) {
+        PrioEntry* entries = (PrioEntry*)mem_resize(heap->entries, heap->capacity * 2 * sizeof(PrioEntry));
+        if (!entries) {
+            fprintf(stderr, "Error: Could not grow priority queue heap\n");
+            pthread_mutex_unlock(&heap->lock);
+            return -1;
+        }
+        heap->entries = entries;
+        heap->capacity *= 2;
+    }
+
+    heap->entries[heap->len].priority = priority;
+    heap->entries[heap->len].value = value;
+    prio_sift_up(heap->entries, heap->len++);
+    prio_update_top(heap);
+    atomic_fetch_add_explicit(&queue->size, 1, memory_order_relaxed);
+
+    pthread_mutex_unlock(&heap->lock);
+    return 0;
+}
+
+// Tar ut toppen ur en låst heap, returnerar -1 om den hunnit tömmas
+static int prio_pop_locked(PrioQueue* queue, PrioHeap* heap, uint16_t* priority, uint32_t* value) {
+    if (heap->len == 0) return -1;
+
+    if (priority) *priority = heap->entries[0].priority;
+    if (value) *value = heap->entries[0].value;
+    heap->entries[0] = heap->entries[--heap->len];
+    if (heap->len) prio_sift_down(heap->entries, heap->len, 0);
+    prio_update_top(heap);
+    atomic_fetch_sub_explicit(&queue->size, 1, memory_order_relaxed);
+    return 0;
+}
+
+// Tar ut ett element med (ungefär) lägst prioritet
+// Returnerar 0 eller -1 om kön är tom
+int prio_delete_min(PrioQueue* queue, uint16_t* priority, uint32_t* value) {
+    while (atomic_load_explicit(&queue->size, memory_order_relaxed) > 0) {
+        // Två slumpvisa heapar, välj den med lägst topp
+        for (int attempt = 0; attempt < PRIO_DELETE_ATTEMPTS; attempt++) {
+            PrioHeap* a = &queue->heaps[prio_random() % queue->num_queues];
+            PrioHeap* b = &queue->heaps[prio_random() % queue->num_queues];
+            uint32_t top_a = atomic_load_explicit(&a->top, memory_order_acquire);
+            uint32_t top_b = atomic_load_explicit(&b->top, memory_order_acquire);
+            PrioHeap* heap = top_b < top_a ? b : a;
+            if ((top_b < top_a ? top_b : top_a) == PRIO_EMPTY) continue;
+
+            if (pthread_mutex_trylock(&heap->lock) != 0) continue;
+            int result = prio_pop_locked(queue, heap, priority, value);
+            pthread_mutex_unlock(&heap->lock);
+            if (result == 0) return 0;
+        }
+
+        // Kön är nästan tom - sök igenom alla heapar så att inget element missas
+        for (size_t i = 0; i < queue->num_queues; i++) {
+            PrioHeap* heap = &queue->heaps[i];
+            if (atomic_load_explicit(&heap->top, memory_order_acquire) == PRIO_EMPTY) continue;
+            pthread_mutex_lock(&heap->lock);
+            int result = prio_pop_locked(queue, heap, priority, value);
+            pthread_mutex_unlock(&heap->lock);
+            if (result == 0) return 0;
+        }
+    }
+    return -1;
+}
+
+size_t prio_size(PrioQueue* queue) {
+    return atomic_load_explicit(&queue->size, memory_order_relaxed);
+}
+
+// Lämnar tillbaka alla heapar till minnespoolen, får bara anropas när inga trådar använder kön
+void prio_destroy(PrioQueue* queue) {
+    if (!queue) return;
+    for (size_t i = 0; i < queue->num_queues; i++) {
+        pthread_mutex_destroy(&queue->heaps[i].lock);
+        if (queue->heaps[i].entries) mem_free(queue->heaps[i].entries);
+    }
+    mem_free(queue->heaps);
+    free(queue);
+}
@@ -0,0 +1,19 @@
+#ifndef PRIO_QUEUE_H
+#define PRIO_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct PrioQueue PrioQueue;
+
+PrioQueue* prio_create(size_t num_queues, size_t capacity);
+
+int prio_insert(PrioQueue* queue, uint16_t priority, uint32_t value);
+
+int prio_delete_min(PrioQueue* queue, uint16_t* priority, uint32_t* value);
+
+size_t prio_size(PrioQueue* queue);
+
+void prio_destroy(PrioQueue* queue);
+
+#endif
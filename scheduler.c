@@ -0,0 +1,364 @@
+#include "scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+// Körtid med arbetsstöld: en fast uppsättning arbetartrådar med var sin Chase-Lev-deque.
+// En arbetare lägger nya uppgifter i botten av sin egen deque och tar dem därifrån (LIFO,
+// varm cache), lediga arbetare stjäl från toppen hos andra (FIFO, största delarna först).
+// Trådar utanför körtiden lägger uppgifter i en gemensam inkö.
+// Den som väntar på en grupp kör själv uppgifter under tiden, så nästlade grupper låser sig inte.
+// Ersätter en pthread_create per test eller operation med trådar som återanvänds.
+
+#define CACHE_LINE 64
+#define SCHED_DEQUE_CAPACITY 4096 // Tvåpotens - full deque gör att uppgiften körs direkt istället
+#define SCHED_SPIN_ROUNDS 64      // Försök att hitta arbete innan en arbetare somnar
+
+typedef struct Task {
+    void (*run)(struct Task* task);
+    task_fn fn;
+    void* arg;
+    TaskGroup* group;
+    struct Task* next;  // Länk i inkön
+    size_t begin, end;  // Intervall för parallel_for
+    size_t grain;
+    range_fn body;
+} Task;
+
+// Chase-Lev-deque (Lê m.fl., C11-minnesmodell) - bara ägaren använder bottom
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_long top;
+    _Alignas(CACHE_LINE) atomic_long bottom;
+    _Atomic(Task*) buffer[SCHED_DEQUE_CAPACITY];
+} WorkDeque;
+
+typedef struct {
+    WorkDeque deque;
+    Scheduler* scheduler;
+    pthread_t thread;
+    size_t index;
+    uint32_t seed; // Slump för val av offer
+} Worker;
+
+struct Scheduler {
+    Worker* workers;
+    size_t num_workers;
+
+    pthread_mutex_t inject_lock; // Inkö för uppgifter från trådar utanför körtiden
+    Task* inject_head;
+    Task* inject_tail;
+    atomic_size_t injected;      // Längd på inkön - låset tas bara när den inte är tom
+
+    atomic_size_t queued;        // Uppgifter i deques och inkö som ingen tagit än
+    atomic_size_t sleeping;
+    atomic_int shutdown;
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t wake;
+};
+
+static _Thread_local Worker* current_worker = NULL;
+
+// ********* Chase-Lev-deque *********
+
+static int deque_push(WorkDeque* deque, Task* task) {
+    long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (b - t >= SCHED_DEQUE_CAPACITY) return -1;
+    atomic_store_explicit(&deque->buffer[b & (SCHED_DEQUE_CAPACITY - 1)], task, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    return 0;
+}
+
+// Ägaren tar från botten - konkurrerar med tjuvar bara om sista elementet
+static Task* deque_take(WorkDeque* deque) {
+    long b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    Task* task = NULL;
+    if (t <= b) {
+        task = atomic_load_explicit(&deque->buffer[b & (SCHED_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+        if (t == b) {
+            if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+                task = NULL; // En tjuv hann före
+            atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+// Tjuvar tar från toppen, NULL om dequen är tom eller en annan tråd hann före
+static Task* deque_steal(WorkDeque* deque) {
+    long t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (t >= b) return NULL;
+    Task* task = atomic_load_explicit(&deque->buffer[t & (SCHED_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+        return NULL;
+    return task;
+}
+
+// ********* Köa och hitta uppgifter *********
+
+static void sched_wake_one(Scheduler* scheduler) {
+    if (atomic_load(&scheduler->sleeping) == 0) return;
+    pthread_mutex_lock(&scheduler->sleep_lock);
+    pthread_cond_signal(&scheduler->wake);
+    pthread_mutex_unlock(&scheduler->sleep_lock);
+}
+
+static void sched_run(Task* task) {
+    TaskGroup* group = task->group;
+    task->run(task);
+    free(task);
+    atomic_fetch_sub_explicit(&group->pending, 1, memory_order_release);
+}
+
+// Lägger uppgiften i arbetarens egen deque, annars i inkön
+// Returnerar -1 om den egna dequen är full - då kör anroparen uppgiften direkt
+static int sched_enqueue(Scheduler* scheduler, Task* task) {
+    Worker* worker = current_worker;
+    atomic_fetch_add(&scheduler->queued, 1); // Före publicering så att ingen somnar med arbete kvar
+    if (worker && worker->scheduler == scheduler) {
+        if (deque_push(&worker->deque, task) != 0) {
+            atomic_fetch_sub(&scheduler->queued, 1);
+            return -1;
+        }
+    } else {
+        task->next = NULL;
+        pthread_mutex_lock(&scheduler->inject_lock);
+        if (scheduler->inject_tail) scheduler->inject_tail->next = task;
+        else scheduler->inject_head = task;
+        scheduler->inject_tail = task;
+        atomic_fetch_add(&scheduler->injected, 1);
+        pthread_mutex_unlock(&scheduler->inject_lock);
+    }
+    sched_wake_one(scheduler);
+    return 0;
+}
+
+static Task* sched_pop_injected(Scheduler* scheduler) {
+    if (atomic_load_explicit(&scheduler->injected, memory_order_relaxed) == 0) return NULL;
+    pthread_mutex_lock(&scheduler->inject_lock);
+    Task* task = scheduler->inject_head;
+    if (task) {
+        scheduler->inject_head = task->next;
+        if (!scheduler->inject_head) scheduler->inject_tail = NULL;
+        atomic_fetch_sub(&scheduler->injected, 1);
+    }
+    pthread_mutex_unlock(&scheduler->inject_lock);
+    return task;
+}
+
+static inline uint32_t sched_random(uint32_t* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+// Egen deque först, sedan inkön, sedan ett varv stölder med slumpvis startpunkt
+static Task* sched_find_task(Scheduler* scheduler) {
+    Worker* worker = current_worker && current_worker->scheduler == scheduler ? current_worker : NULL;
+    Task* task = worker ? deque_take(&worker->deque) : NULL;
+    if (!task) task = sched_pop_injected(scheduler);
+    if (!task && scheduler->num_workers > 0) {
+        static _Thread_local uint32_t outside_seed = 0;
+        uint32_t* seed = worker ? &worker->seed : &outside_seed;
+        if (*seed == 0) *seed = (uint32_t)(uintptr_t)seed | 1;
+        size_t start = sched_random(seed) % scheduler->num_workers;
+        for (size_t i = 0; i < scheduler->num_workers && !task; i++) {
+            Worker* victim = &scheduler->workers[(start + i) % scheduler->num_workers];
+            if (victim != worker) task = deque_steal(&victim->deque);
+        }
+    }
+    if (task) atomic_fetch_sub(&scheduler->queued, 1);
+    return task;
+}
+
+static void* sched_worker_main(void* arg) {
+    Worker* worker = (Worker*)arg;
+    Scheduler* scheduler = worker->scheduler;
+    current_worker = worker;
+
+    while (!atomic_load(&scheduler->shutdown)) {
+        Task* task = NULL;
+        for (int round = 0; round < SCHED_SPIN_ROUNDS && !task; round++) {
+            task = sched_find_task(scheduler);
+            if (!task) sched_yield();
+        }
+        if (task) {
+            sched_run(task);
+            continue;
+        }
+
+        // Inget arbete - sov tills någon köar en uppgift
+        // sleeping ökas före kontrollen av queued och sched_enqueue ökar queued före kontrollen
+        // av sleeping, så minst en av dem ser den andra och väckningen går inte förlorad
+        pthread_mutex_lock(&scheduler->sleep_lock);
+        atomic_fetch_add(&scheduler->sleeping, 1);
+        while (atomic_load(&scheduler->queued) == 0 && !atomic_load(&scheduler->shutdown))
+            pthread_cond_wait(&scheduler->wake, &scheduler->sleep_lock);
+        atomic_fetch_sub(&scheduler->sleeping, 1);
+        pthread_mutex_unlock(&scheduler->sleep_lock);
+    }
+    return NULL;
+}
+
+// ********* Publikt API *********
+
+// Startar num_workers arbetartrådar, 0 ger en per tillgänglig processor
+Scheduler* sched_create(size_t num_workers) {
+    if (num_workers == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = cpus > 0 ? (size_t)cpus : 1;
+    }
+
+    Scheduler* scheduler = (Scheduler*)malloc(sizeof(Scheduler));
+    Worker* workers = (Worker*)aligned_alloc(CACHE_LINE, ((num_workers * sizeof(Worker) + CACHE_LINE - 1) / CACHE_LINE) * CACHE_LINE);
+    if (!scheduler || !workers) {
+        fprintf(stderr, "Error: Memory allocation failed in sched_create.\n");
+        free(scheduler);
+        free(workers);
+        return NULL;
+    }
+
+    scheduler->workers = workers;
+    scheduler->num_workers = 0;
+    scheduler->inject_head = scheduler->inject_tail = NULL;
+    atomic_init(&scheduler->injected, 0);
+    atomic_init(&scheduler->queued, 0);
+    atomic_init(&scheduler->sleeping, 0);
+    atomic_init(&scheduler->shutdown, 0);
+    pthread_mutex_init(&scheduler->inject_lock, NULL);
+    pthread_mutex_init(&scheduler->sleep_lock, NULL);
+    pthread_cond_init(&scheduler->wake, NULL);
+
+    // Alla deques initieras innan någon tråd startar och kan börja stjäla
+    for (size_t i = 0; i < num_workers; i++) {
+        Worker* worker = &workers[i];
+        atomic_init(&worker->deque.top, 0);
+        atomic_init(&worker->deque.bottom, 0);
+        worker->scheduler = scheduler;
+        worker->index = i;
+        worker->seed = (uint32_t)(i * 2654435761u) | 1;
+    }
+    scheduler->num_workers = num_workers;
+    for (size_t i = 0; i < num_workers; i++) {
+        if (pthread_create(&workers[i].thread, NULL, sched_worker_main, &workers[i])) {
+            perror("Failed to create worker thread");
+            // Stäng de som redan startats - övriga deques förblir tomma
+            atomic_store(&scheduler->shutdown, 1);
+            pthread_mutex_lock(&scheduler->sleep_lock);
+            pthread_cond_broadcast(&scheduler->wake);
+            pthread_mutex_unlock(&scheduler->sleep_lock);
+            for (size_t j = 0; j < i; j++) pthread_join(workers[j].thread, NULL);
+            scheduler->num_workers = 0;
+            sched_destroy(scheduler);
+            return NULL;
+        }
+    }
+    return scheduler;
+}
+
+// Stoppar arbetarna - alla grupper ska ha väntats in innan
+void sched_destroy(Scheduler* scheduler) {
+    if (!scheduler) return;
+    atomic_store(&scheduler->shutdown, 1);
+    pthread_mutex_lock(&scheduler->sleep_lock);
+    pthread_cond_broadcast(&scheduler->wake);
+    pthread_mutex_unlock(&scheduler->sleep_lock);
+    for (size_t i = 0; i < scheduler->num_workers; i++)
+        pthread_join(scheduler->workers[i].thread, NULL);
+
+    pthread_mutex_destroy(&scheduler->inject_lock);
+    pthread_mutex_destroy(&scheduler->sleep_lock);
+    pthread_cond_destroy(&scheduler->wake);
+    free(scheduler->workers);
+    free(scheduler);
+}
+
+size_t sched_num_workers(Scheduler* scheduler) {
+    return scheduler->num_workers;
+}
+
+void task_group_init(TaskGroup* group, Scheduler* scheduler) {
+    group->scheduler = scheduler;
+    atomic_init(&group->pending, 0);
+}
+
+static void sched_run_user(Task* task) {
+    task->fn(task->arg);
+}
+
+static int sched_spawn(TaskGroup* group, Task* task) {
+    task->group = group;
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    if (sched_enqueue(group->scheduler, task) != 0) sched_run(task);
+    return 0;
+}
+
+// Startar fn(arg) som en uppgift i gruppen, returnerar 0 eller -1 om uppgiften inte kunde skapas
+int task_group_spawn(TaskGroup* group, task_fn fn, void* arg) {
+    Task* task = (Task*)malloc(sizeof(Task));
+    if (!task) {
+        fprintf(stderr, "Error: Memory allocation failed in task_group_spawn.\n");
+        return -1;
+    }
+    task->run = sched_run_user;
+    task->fn = fn;
+    task->arg = arg;
+    return sched_spawn(group, task);
+}
+
+// Väntar tills alla uppgifter i gruppen (även de som startats inifrån gruppen) är klara
+// Tråden kör andra uppgifter medan den väntar istället för att blockera
+void task_group_wait(TaskGroup* group) {
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0) {
+        Task* task = sched_find_task(group->scheduler);
+        if (task) sched_run(task);
+        else sched_yield();
+    }
+}
+
+// Delar intervallet på mitten tills det är högst grain stort - ena halvan blir en ny uppgift
+// som andra arbetare kan stjäla, den andra fortsätter delas i samma uppgift
+static void sched_run_range(Task* task) {
+    size_t begin = task->begin, end = task->end;
+    while (end - begin > task->grain) {
+        size_t mid = begin + (end - begin) / 2;
+        Task* right = (Task*)malloc(sizeof(Task));
+        if (!right) break; // Kör resten i den här uppgiften
+        *right = *task;
+        right->begin = mid;
+        right->end = end;
+        sched_spawn(task->group, right);
+        end = mid;
+    }
+    task->body(begin, end, task->arg);
+}
+
+// Anropar body(b, e, ctx) för delintervall av [begin, end) med högst grain element
+// och återvänder när alla är klara. grain 0 väljs utifrån antal arbetare
+void parallel_for(Scheduler* scheduler, size_t begin, size_t end, size_t grain, range_fn body, void* ctx) {
+    if (begin >= end) return;
+    if (grain == 0) {
+        grain = (end - begin) / (8 * (scheduler->num_workers + 1));
+        if (grain == 0) grain = 1;
+    }
+
+    TaskGroup group;
+    task_group_init(&group, scheduler);
+    Task root = {.run = sched_run_range, .group = &group, .begin = begin, .end = end,
+                 .grain = grain, .body = body, .arg = ctx};
+    sched_run_range(&root); // Roten körs av anroparen själv och räknas inte i pending
+    task_group_wait(&group);
+}
@@ -0,0 +1,32 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+typedef struct Scheduler Scheduler;
+
+typedef void (*task_fn)(void* arg);
+
+typedef void (*range_fn)(size_t begin, size_t end, void* ctx);
+
+typedef struct TaskGroup {
+    Scheduler* scheduler;
+    atomic_size_t pending; // Startade men ännu inte avslutade uppgifter
+} TaskGroup;
+
+Scheduler* sched_create(size_t num_workers);
+
+void sched_destroy(Scheduler* scheduler);
+
+size_t sched_num_workers(Scheduler* scheduler);
+
+void task_group_init(TaskGroup* group, Scheduler* scheduler);
+
+int task_group_spawn(TaskGroup* group, task_fn fn, void* arg);
+
+void task_group_wait(TaskGroup* group);
+
+void parallel_for(Scheduler* scheduler, size_t begin, size_t end, size_t grain, range_fn body, void* ctx);
+
+#endif
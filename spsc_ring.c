@@ -0,0 +1,177 @@
+#include "spsc_ring.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+// Låsfri ringbuffert för exakt en producent och en konsument
+// Producenten skriver bara tail, konsumenten skriver bara head - inget lås behövs
+// Index räknas uppåt utan wrap, position i bufferten är index & mask
+
+#define CACHE_LINE 64
+
+struct SpscRing {
+    // Oföränderligt efter skapande - delas läsande av båda trådarna
+    _Alignas(CACHE_LINE) char* buffer;
+    size_t mask;
+    size_t elem_size;
+
+    // Konsumentens cache-line: egen position och senast sedda tail
+    _Alignas(CACHE_LINE) atomic_size_t head;
+    size_t cached_tail;
+
+    // Producentens cache-line: egen position och senast sedda head
+    _Alignas(CACHE_LINE) atomic_size_t tail;
+    size_t cached_head;
+};
+
+// Skapar en ring med plats för minst capacity element (avrundas upp till tvåpotens)
+// Struktur och buffert allokeras som ett cache-line-alignat block ur minnespoolen
+SpscRing* spsc_create(size_t capacity, size_t elem_size) {
+    if (capacity == 0 || elem_size == 0) {
+        fprintf(stderr, "Error: Invalid ring capacity or element size\n");
+        return NULL;
+    }
+
+    // Avrundningen till tvåpotens får inte slå runt, och huvud plus buffert måste rymmas i size_t
+    size_t header = (sizeof(SpscRing) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    size_t cap = 1;
+    if (capacity <= SIZE_MAX / 2 + 1)
+        while (cap < capacity) cap *= 2;
+    if (cap < capacity || cap > (SIZE_MAX - header) / elem_size) {
+        fprintf(stderr, "Error: Ring capacity of %zu elements is too large\n", capacity);
+        return NULL;
+    }
+
+    char* block = (char*)mem_alloc_aligned(header + cap * elem_size, CACHE_LINE);
+    if (!block) {
+        fprintf(stderr, "Error: Could not allocate ring of %zu elements from memory pool\n", cap);
+        return NULL;
+    }
+
+    SpscRing* ring = (SpscRing*)block;
+    ring->buffer = block + header;
+    ring->mask = cap - 1;
+    ring->elem_size = elem_size;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->cached_tail = 0;
+    ring->cached_head = 0;
+    return ring;
+}
+
+// Antal lediga platser sett från producenten
+// Läser konsumentens head (acquire) bara när den cachade kopian inte räcker
+static inline size_t spsc_free_slots(SpscRing* ring, size_t tail, size_t wanted) {
+    size_t capacity = ring->mask + 1;
+    size_t free_slots = capacity - (tail - ring->cached_head);
+    if (free_slots < wanted) {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        free_slots = capacity - (tail - ring->cached_head);
+    }
+    return free_slots;
+}
+
+// Antal tillgängliga element sett från konsumenten
+static inline size_t spsc_available(SpscRing* ring, size_t head, size_t wanted) {
+    size_t available = ring->cached_tail - head;
+    if (available < wanted) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        available = ring->cached_tail - head;
+    }
+    return available;
+}
+
+// Producent: kopierar in upp till count element och publicerar dem med en enda release-store
+// Returnerar antal element som fick plats
+size_t spsc_push(SpscRing* ring, const void* items, size_t count) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t free_slots = spsc_free_slots(ring, tail, count);
+    if (count > free_slots) count = free_slots;
+    if (count == 0) return 0;
+
+    // Kopieringen kan behöva delas i två delar runt buffertens slut
+    size_t pos = tail & ring->mask;
+    size_t first = ring->mask + 1 - pos;
+    if (first > count) first = count;
+    memcpy(ring->buffer + pos * ring->elem_size, items, first * ring->elem_size);
+    memcpy(ring->buffer, (const char*)items + first * ring->elem_size, (count - first) * ring->elem_size);
+
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+    return count;
+}
+
+// Konsument: kopierar ut upp till max_count element och frigör platserna med en enda release-store
+size_t spsc_pop(SpscRing* ring, void* items, size_t max_count) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t count = spsc_available(ring, head, max_count);
+    if (count > max_count) count = max_count;
+    if (count == 0) return 0;
+
+    size_t pos = head & ring->mask;
+    size_t first = ring->mask + 1 - pos;
+    if (first > count) first = count;
+    memcpy(items, ring->buffer + pos * ring->elem_size, first * ring->elem_size);
+    memcpy((char*)items + first * ring->elem_size, ring->buffer, (count - first) * ring->elem_size);
+
+    atomic_store_explicit(&ring->head, head + count, memory_order_release);
+    return count;
+}
+
+// Producent: lämnar ut en sammanhängande skrivbar del av bufferten (zero-copy)
+// *granted kan bli mindre än count vid buffertens slut eller om ringen är nästan full
+// Elementen blir synliga för konsumenten först vid spsc_commit
+void* spsc_reserve(SpscRing* ring, size_t count, size_t* granted) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t free_slots = spsc_free_slots(ring, tail, count);
+    size_t pos = tail & ring->mask;
+    size_t contiguous = ring->mask + 1 - pos;
+
+    if (count > free_slots) count = free_slots;
+    if (count > contiguous) count = contiguous;
+    *granted = count;
+    return count ? ring->buffer + pos * ring->elem_size : NULL;
+}
+
+// Producent: publicerar count element som skrivits i den reserverade delen
+void spsc_commit(SpscRing* ring, size_t count) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+}
+
+// Konsument: lämnar ut en sammanhängande läsbar del utan kopiering
+// Platserna återanvänds inte förrän de lämnats tillbaka med spsc_release
+const void* spsc_peek(SpscRing* ring, size_t max_count, size_t* available) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t count = spsc_available(ring, head, max_count);
+    size_t pos = head & ring->mask;
+    size_t contiguous = ring->mask + 1 - pos;
+
+    if (count > max_count) count = max_count;
+    if (count > contiguous) count = contiguous;
+    *available = count;
+    return count ? ring->buffer + pos * ring->elem_size : NULL;
+}
+
+// Konsument: lämnar tillbaka count lästa platser till producenten
+void spsc_release(SpscRing* ring, size_t count) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + count, memory_order_release);
+}
+
+// Ungefärligt antal element - exakt bara när ingen annan tråd arbetar mot ringen
+size_t spsc_size(SpscRing* ring) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return tail - head;
+}
+
+size_t spsc_capacity(SpscRing* ring) {
+    return ring->mask + 1;
+}
+
+// Lämnar tillbaka ringen till minnespoolen, får bara anropas när båda trådarna är klara
+void spsc_destroy(SpscRing* ring) {
+    if (ring) mem_free(ring);
+}
@@ -0,0 +1,28 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+
+typedef struct SpscRing SpscRing;
+
+SpscRing* spsc_create(size_t capacity, size_t elem_size);
+
+size_t spsc_push(SpscRing* ring, const void* items, size_t count);
+
+size_t spsc_pop(SpscRing* ring, void* items, size_t max_count);
+
+void* spsc_reserve(SpscRing* ring, size_t count, size_t* granted);
+
+void spsc_commit(SpscRing* ring, size_t count);
+
+const void* spsc_peek(SpscRing* ring, size_t max_count, size_t* available);
+
+void spsc_release(SpscRing* ring, size_t count);
+
+size_t spsc_size(SpscRing* ring);
+
+size_t spsc_capacity(SpscRing* ring);
+
+void spsc_destroy(SpscRing* ring);
+
+#endif
@@ -0,0 +1,273 @@
+#include "art.h"
+#include "linked_list.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    int thread_id; // Unique ID for each thread
+    int num_keys;  // Number of keys each thread inserts into its own tree
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_keys;
+} TestParams;
+
+typedef struct
+{
+    uint32_t last_key;
+    size_t count;
+} range_state_t;
+
+// Checks that results arrive in ascending order with the expected values
+int visit_ascending(uint32_t key, uint32_t value, void *ctx)
+{
+    range_state_t *state = (range_state_t *)ctx;
+    my_assert(state->count == 0 || key > state->last_key);
+    my_assert(value == (key ^ 0x5a5a5a5a));
+    state->last_key = key;
+    state->count++;
+    return 0;
+}
+
+int visit_stop_after_ten(uint32_t key, uint32_t value, void *ctx)
+{
+    (void)key;
+    (void)value;
+    return ++*(int *)ctx == 10;
+}
+
+// Spreads i over the whole key space so every node size gets used
+static uint32_t scatter(uint32_t i)
+{
+    return i * 2654435761u;
+}
+
+// ********* Test basic tree operations *********
+
+void test_art_insert_and_get(TestParams *params)
+{
+    printf_yellow("  Testing art insert/get (keys: %d) ---> ", params->num_keys);
+    mem_init(32 * 1024 * 1024);
+
+    ArtTree *tree = art_create();
+    my_assert(tree != NULL);
+    my_assert(art_get(tree, 0, NULL) == 0);
+
+    // Scattered keys plus a dense run that fills Node256 at the lowest level
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        my_assert(art_insert(tree, scatter(i), scatter(i) ^ 0x5a5a5a5a) == 0);
+        my_assert(art_insert(tree, 0x01000000u + i, (0x01000000u + i) ^ 0x5a5a5a5a) == 0);
+    }
+    size_t expected = art_size(tree);
+    my_assert(expected <= (size_t)params->num_keys * 2);
+
+    uint32_t value;
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        my_assert(art_get(tree, scatter(i), &value) == 1 && value == (scatter(i) ^ 0x5a5a5a5a));
+        my_assert(art_get(tree, 0x01000000u + i, &value) == 1);
+    }
+    my_assert(art_get(tree, 0x01000000u + params->num_keys, NULL) == 0);
+
+    // Updating an existing key keeps the size
+    my_assert(art_insert(tree, scatter(0), 7) == 0);
+    my_assert(art_get(tree, scatter(0), &value) == 1 && value == 7);
+    my_assert(art_size(tree) == expected);
+
+    art_destroy(tree);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_art_range_and_prefix(TestParams *params)
+{
+    printf_yellow("  Testing art range and prefix queries (keys: %d) ---> ", params->num_keys);
+    mem_init(32 * 1024 * 1024);
+
+    ArtTree *tree = art_create();
+    for (int i = 0; i < params->num_keys; i++)
+        my_assert(art_insert(tree, scatter(i), scatter(i) ^ 0x5a5a5a5a) == 0);
+
+    // Full ordered iteration
+    range_state_t state = {0};
+    my_assert(art_range(tree, 0, UINT32_MAX, visit_ascending, &state) == art_size(tree));
+
+    // A sub-range must match a brute-force count
+    uint32_t low = 0x40000000u, high = 0x9fffffffu;
+    size_t expected = 0;
+    for (int i = 0; i < params->num_keys; i++)
+        expected += scatter(i) >= low && scatter(i) <= high;
+    state = (range_state_t){0};
+    my_assert(art_range(tree, low, high, visit_ascending, &state) == expected);
+    my_assert(art_range(tree, high, low, NULL, NULL) == 0);
+
+    // Prefix query on the top 8 bits
+    uint32_t prefix = scatter(params->num_keys / 2) & 0xff000000u;
+    expected = 0;
+    for (int i = 0; i < params->num_keys; i++)
+        expected += (scatter(i) & 0xff000000u) == prefix;
+    state = (range_state_t){0};
+    my_assert(art_prefix(tree, prefix, 8, visit_ascending, &state) == expected);
+    my_assert(art_prefix(tree, scatter(0), 32, NULL, NULL) == 1);
+    my_assert(art_prefix(tree, 0, 0, NULL, NULL) == art_size(tree));
+
+    // The visitor can stop early
+    int seen = 0;
+    size_t visited = art_range(tree, 0, UINT32_MAX, visit_stop_after_ten, &seen);
+    my_assert(visited == (art_size(tree) < 10 ? art_size(tree) : 10));
+
+    art_destroy(tree);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// Each thread owns its tree, but all trees draw nodes from the shared memory pool
+void *thread_art_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    ArtTree *tree = art_create();
+    my_assert(tree != NULL);
+
+    for (int i = 0; i < data->num_keys; i++)
+    {
+        uint32_t key = rand();
+        my_assert(art_insert(tree, key, key ^ 0x5a5a5a5a) == 0);
+    }
+
+    range_state_t state = {0};
+    my_assert(art_range(tree, 0, UINT32_MAX, visit_ascending, &state) == art_size(tree));
+
+    art_destroy(tree);
+    return NULL;
+}
+
+void test_art_multithread(TestParams *params)
+{
+    printf_yellow("  Testing art per-thread trees (threads: %d, keys: %d) ---> ", params->num_threads, params->num_keys);
+    mem_init(32 * 1024 * 1024);
+
+    pthread_t threads[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i].thread_id = i;
+        thread_data[i].num_keys = params->num_keys / params->num_threads;
+        if (pthread_create(&threads[i], NULL, thread_art_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Compare against list_search lookups *********
+
+void test_art_performance(TestParams *params)
+{
+    printf_yellow("  Testing art vs list_search lookups (keys: %d) ---> ", params->num_keys);
+    mem_init(32 * 1024 * 1024);
+
+    Node *head = NULL;
+    ArtTree *tree = art_create();
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        list_insert(&head, (uint16_t)(i * 2));
+        art_insert(tree, i * 2, i);
+    }
+
+    struct timespec start, end;
+    int list_hits = 0, art_hits = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_keys; i++)
+        list_hits += list_search(&head, (uint16_t)i) != NULL;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double list_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_keys; i++)
+        art_hits += art_get(tree, i, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double art_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    my_assert(list_hits == art_hits);
+    printf("list: %f s, art: %f s ---> ", list_time, art_time);
+
+    list_cleanup(&head);
+    art_destroy(tree);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_art_insert_and_get - Test inserts and point lookups\n");
+        printf(" 2. test_art_range_and_prefix - Test ordered iteration, range and prefix queries\n");
+        printf(" 3. test_art_multithread - Test per-thread trees on a shared pool\n");
+        printf(" 4. test_art_performance - Compare lookups against list_search\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        for (int j = 0; j < 17; j += 4) // from 2^0 = 1 up to 2^16 = 65536 keys
+        {
+            test_art_insert_and_get(&(TestParams){.num_keys = pow(2, j)});
+            test_art_range_and_prefix(&(TestParams){.num_keys = pow(2, j)});
+        }
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_art_multithread(&(TestParams){.num_threads = pow(2, i), .num_keys = 16384});
+        break;
+    case 1:
+        test_art_insert_and_get(&(TestParams){.num_keys = 65536});
+        break;
+    case 2:
+        test_art_range_and_prefix(&(TestParams){.num_keys = 65536});
+        break;
+    case 3:
+        test_art_multithread(&(TestParams){.num_threads = base_num_threads, .num_keys = 16384});
+        break;
+    case 4:
+        test_art_performance(&(TestParams){.num_keys = 16384});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
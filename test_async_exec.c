@@ -0,0 +1,344 @@
+#include "async_exec.h"
+#include "linked_list.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    AsyncExecutor *executor; // Executor shared by all threads
+    Node **head;             // List used by the locking baseline
+    int thread_id;           // Unique ID for each thread
+    int num_ops;             // Number of operations each thread submits
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_ops;
+} TestParams;
+
+// Submits until the thread's ring has room; a full ring never blocks the caller
+static void submit_retry(AsyncExecutor *executor, ListOp op, async_callback callback, void *ctx, AsyncFuture *future)
+{
+    while (list_submit(executor, op, callback, ctx, future) != 0)
+        sched_yield();
+}
+
+void count_callback(AsyncFuture *future, void *ctx)
+{
+    my_assert(async_poll(future));
+    atomic_fetch_add((atomic_int *)ctx, 1);
+}
+
+// ********* Test basic submission *********
+
+void test_async_list_ops()
+{
+    printf_yellow("  Testing list_submit with futures ---> ");
+    mem_init(1024 * 1024);
+    Node *head = NULL;
+    AsyncExecutor *executor = async_create(&head, 64);
+    my_assert(executor != NULL);
+
+    AsyncFuture futures[40];
+    for (int i = 0; i < 32; i++)
+        submit_retry(executor, (ListOp){.type = LIST_OP_INSERT, .data = i}, NULL, NULL, &futures[i]);
+    submit_retry(executor, (ListOp){.type = LIST_OP_SEARCH, .data = 5}, NULL, NULL, &futures[32]);
+    submit_retry(executor, (ListOp){.type = LIST_OP_SEARCH, .data = 500}, NULL, NULL, &futures[33]);
+    submit_retry(executor, (ListOp){.type = LIST_OP_DELETE, .data = 5}, NULL, NULL, &futures[34]);
+    submit_retry(executor, (ListOp){.type = LIST_OP_DELETE, .data = 5}, NULL, NULL, &futures[35]);
+    submit_retry(executor, (ListOp){.type = LIST_OP_COUNT}, NULL, NULL, &futures[36]);
+
+    // Operations from one thread complete in submission order
+    async_wait(&futures[36]);
+    for (int i = 0; i < 36; i++)
+        my_assert(async_poll(&futures[i]));
+    my_assert(futures[0].result == 0);
+    my_assert(futures[32].result == 1);
+    my_assert(futures[33].result == 0);
+    my_assert(futures[34].result == 1);
+    my_assert(futures[35].result == 0);
+    my_assert(futures[36].result == 31);
+
+    async_destroy(executor);
+    my_assert(list_count_nodes(&head) == 31);
+    list_cleanup(&head);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_async_callbacks_and_memory()
+{
+    printf_yellow("  Testing callbacks and mem_submit_alloc/free ---> ");
+    mem_init(1024 * 1024);
+    Node *head = NULL;
+    AsyncExecutor *executor = async_create(&head, 16);
+
+    // Callbacks without futures
+    atomic_int completed = 0;
+    for (int i = 0; i < 100; i++)
+        submit_retry(executor, (ListOp){.type = LIST_OP_INSERT, .data = i}, count_callback, &completed, NULL);
+
+    AsyncFuture alloc;
+    while (mem_submit_alloc(executor, 256, count_callback, &completed, &alloc) != 0)
+        sched_yield();
+    async_wait(&alloc);
+    my_assert(alloc.result == 0 && alloc.ptr != NULL);
+    memset(alloc.ptr, 0xab, 256);
+
+    AsyncFuture release;
+    while (mem_submit_free(executor, alloc.ptr, NULL, NULL, &release) != 0)
+        sched_yield();
+    async_wait(&release);
+    my_assert(release.result == 0);
+
+    // An allocation that cannot fit reports failure instead of blocking
+    AsyncFuture too_big;
+    while (mem_submit_alloc(executor, 4 * 1024 * 1024, NULL, NULL, &too_big) != 0)
+        sched_yield();
+    async_wait(&too_big);
+    my_assert(too_big.result == -1 && too_big.ptr == NULL);
+
+    my_assert(completed == 101);
+
+    async_destroy(executor);
+    my_assert(list_count_nodes(&head) == 100);
+    list_cleanup(&head);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Test many submitting threads *********
+
+void *thread_submit_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    AsyncFuture last;
+    for (int i = 0; i < data->num_ops; i++)
+        submit_retry(data->executor, (ListOp){.type = LIST_OP_INSERT, .data = data->thread_id}, NULL, NULL, i == data->num_ops - 1 ? &last : NULL);
+    if (data->num_ops > 0)
+        async_wait(&last);
+    return NULL;
+}
+
+void test_async_multithread(TestParams *params)
+{
+    printf_yellow("  Testing async submission (threads: %d, ops: %d) ---> ", params->num_threads, params->num_ops);
+    mem_init(4 * 1024 * 1024);
+    Node *head = NULL;
+    AsyncExecutor *executor = async_create(&head, 64);
+
+    pthread_t threads[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i] = (thread_data_t){.executor = executor, .thread_id = i, .num_ops = params->num_ops / params->num_threads};
+        if (pthread_create(&threads[i], NULL, thread_submit_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    async_destroy(executor);
+
+    // Every thread's inserts arrived exactly once
+    int per_thread = params->num_ops / params->num_threads;
+    int counts[params->num_threads];
+    memset(counts, 0, sizeof(counts));
+    for (Node *current = head; current; current = current->next)
+        counts[current->data]++;
+    for (int i = 0; i < params->num_threads; i++)
+        my_assert(counts[i] == per_thread);
+
+    list_cleanup(&head);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Test executor and thread lifetimes *********
+
+typedef struct
+{
+    AsyncExecutor *executor;   // Replaced by the main thread every round
+    pthread_barrier_t barrier; // Separates creating, submitting and destroying
+    int rounds;
+} lifecycle_data_t;
+
+// A long-lived thread whose registrations go stale as the executors are destroyed by another thread
+void *thread_lifecycle_worker(void *arg)
+{
+    lifecycle_data_t *data = (lifecycle_data_t *)arg;
+    for (int i = 0; i < data->rounds; i++)
+    {
+        pthread_barrier_wait(&data->barrier);
+        AsyncFuture future;
+        submit_retry(data->executor, (ListOp){.type = LIST_OP_INSERT, .data = i}, NULL, NULL, &future);
+        async_wait(&future);
+        my_assert(future.result == 0);
+        pthread_barrier_wait(&data->barrier);
+    }
+    return NULL;
+}
+
+void test_async_lifecycle()
+{
+    printf_yellow("  Testing executor and submitter lifetimes ---> ");
+    mem_init(4 * 1024 * 1024);
+
+    // More executors than a thread has slots, often at a reused address
+    lifecycle_data_t data = {.rounds = 32};
+    pthread_barrier_init(&data.barrier, NULL, 2);
+    pthread_t worker;
+    pthread_create(&worker, NULL, thread_lifecycle_worker, &data);
+    for (int i = 0; i < data.rounds; i++)
+    {
+        Node *head = NULL;
+        data.executor = async_create(&head, 16);
+        my_assert(data.executor != NULL);
+        pthread_barrier_wait(&data.barrier);
+        pthread_barrier_wait(&data.barrier);
+        async_destroy(data.executor);
+        my_assert(list_count_nodes(&head) == 1 && head->data == i);
+        list_cleanup(&head);
+    }
+    pthread_join(worker, NULL);
+    pthread_barrier_destroy(&data.barrier);
+
+    // More short-lived submitting threads than rings, their rings are handed on as they exit
+    Node *head = NULL;
+    AsyncExecutor *executor = async_create(&head, 16);
+    int waves = 12, per_wave = 64;
+    pthread_t threads[per_wave];
+    thread_data_t thread_data[per_wave];
+    for (int w = 0; w < waves; w++)
+    {
+        for (int i = 0; i < per_wave; i++)
+        {
+            thread_data[i] = (thread_data_t){.executor = executor, .thread_id = i, .num_ops = 4};
+            pthread_create(&threads[i], NULL, thread_submit_function, &thread_data[i]);
+        }
+        for (int i = 0; i < per_wave; i++)
+            pthread_join(threads[i], NULL);
+    }
+    async_destroy(executor);
+    my_assert(list_count_nodes(&head) == waves * per_wave * 4);
+    list_cleanup(&head);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Compare against list_insert under list_mutex *********
+
+void *thread_locked_insert(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    for (int i = 0; i < data->num_ops; i++)
+        list_insert(data->head, data->thread_id);
+    return NULL;
+}
+
+void test_async_performance(TestParams *params)
+{
+    printf_yellow("  Testing list_submit vs list_insert (threads: %d, ops: %d) ---> ", params->num_threads, params->num_ops);
+    mem_init(4 * 1024 * 1024);
+
+    struct timespec start, end;
+    double times[2];
+    for (int mode = 0; mode < 2; mode++)
+    {
+        Node *head = NULL;
+        AsyncExecutor *executor = mode ? async_create(&head, 1024) : NULL;
+        pthread_t threads[params->num_threads];
+        thread_data_t thread_data[params->num_threads];
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < params->num_threads; i++)
+        {
+            thread_data[i] = (thread_data_t){.executor = executor, .head = &head, .thread_id = i, .num_ops = params->num_ops / params->num_threads};
+            pthread_create(&threads[i], NULL, mode ? thread_submit_function : thread_locked_insert, &thread_data[i]);
+        }
+        for (int i = 0; i < params->num_threads; i++)
+            pthread_join(threads[i], NULL);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        times[mode] = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        if (executor)
+            async_destroy(executor);
+        my_assert(list_count_nodes(&head) == (params->num_ops / params->num_threads) * params->num_threads);
+        list_cleanup(&head);
+    }
+
+    printf("list_insert: %f s, list_submit: %f s ---> ", times[0], times[1]);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_async_list_ops - Test list operations completed through futures\n");
+        printf(" 2. test_async_callbacks_and_memory - Test callbacks and pool allocations\n");
+        printf(" 3. test_async_multithread - Test submission from a base number of threads\n");
+        printf(" 4. test_async_performance - Compare against list_insert under list_mutex\n");
+        printf(" 5. test_async_lifecycle - Test executors and submitting threads coming and going\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        test_async_list_ops();
+        test_async_callbacks_and_memory();
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_async_multithread(&(TestParams){.num_threads = pow(2, i), .num_ops = 4096});
+        test_async_lifecycle();
+        break;
+    case 1:
+        test_async_list_ops();
+        break;
+    case 2:
+        test_async_callbacks_and_memory();
+        break;
+    case 3:
+        test_async_multithread(&(TestParams){.num_threads = base_num_threads, .num_ops = 4096});
+        break;
+    case 4:
+        test_async_performance(&(TestParams){.num_threads = base_num_threads, .num_ops = 16384});
+        break;
+    case 5:
+        test_async_lifecycle();
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,271 @@
+#include "bptree.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    int thread_id; // Unique ID for each thread
+    int num_keys;  // Number of keys each thread inserts into its own tree
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_keys;
+} TestParams;
+
+typedef struct
+{
+    uint32_t last_key;
+    size_t count;
+} range_state_t;
+
+// Checks that range results arrive in ascending order
+int visit_ascending(uint32_t key, uint32_t value, void *ctx)
+{
+    range_state_t *state = (range_state_t *)ctx;
+    my_assert(state->count == 0 || key > state->last_key);
+    my_assert(value == key * 2);
+    state->last_key = key;
+    state->count++;
+    return 0;
+}
+
+// ********* Test basic tree operations *********
+
+void test_bptree_insert_and_get(TestParams *params)
+{
+    printf_yellow("  Testing bptree insert/get/iterate (keys: %d) ---> ", params->num_keys);
+    mem_init(16 * 1024 * 1024);
+
+    BPlusTree *tree = bptree_create();
+    my_assert(tree != NULL);
+    my_assert(bptree_get(tree, 1, NULL) == 0);
+
+    // Insert even keys in a scrambled order
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        uint32_t key = (uint32_t)((i * 7919L) % params->num_keys) * 2;
+        my_assert(bptree_insert(tree, key, key * 2) == 0);
+    }
+    my_assert(bptree_size(tree) == (size_t)params->num_keys);
+
+    uint32_t value;
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        my_assert(bptree_get(tree, i * 2, &value) == 1 && value == (uint32_t)i * 4);
+        my_assert(bptree_get(tree, i * 2 + 1, &value) == 0);
+    }
+
+    // Updating an existing key keeps the size
+    my_assert(bptree_insert(tree, 0, 0) == 0);
+    my_assert(bptree_size(tree) == (size_t)params->num_keys);
+
+    // Full ordered iteration through the leaf chain
+    BPlusCursor cursor;
+    uint32_t key;
+    int count = 0;
+    bptree_seek(tree, 0, &cursor);
+    while (bptree_next(&cursor, &key, &value))
+    {
+        my_assert(key == (uint32_t)count * 2);
+        count++;
+    }
+    my_assert(count == params->num_keys);
+
+    // Seeking to a missing key lands on the next larger one
+    bptree_seek(tree, 3, &cursor);
+    if (params->num_keys > 2)
+        my_assert(bptree_next(&cursor, &key, NULL) == 1 && key == 4);
+    else
+        my_assert(bptree_next(&cursor, &key, NULL) == 0);
+
+    bptree_destroy(tree);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_bptree_range(TestParams *params)
+{
+    printf_yellow("  Testing bptree range scans (keys: %d) ---> ", params->num_keys);
+    mem_init(16 * 1024 * 1024);
+
+    BPlusTree *tree = bptree_create();
+    for (int i = params->num_keys - 1; i >= 0; i--)
+        my_assert(bptree_insert(tree, i, i * 2) == 0);
+
+    range_state_t state = {0};
+    uint32_t low = params->num_keys / 4, high = params->num_keys / 2;
+    my_assert(bptree_range(tree, low, high, visit_ascending, &state) == high - low + 1);
+    my_assert(state.count == high - low + 1);
+    my_assert(state.last_key == high);
+
+    my_assert(bptree_range(tree, params->num_keys, UINT32_MAX, NULL, NULL) == 0);
+    my_assert(bptree_range(tree, 0, UINT32_MAX, NULL, NULL) == (size_t)params->num_keys);
+
+    bptree_destroy(tree);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_bptree_bulk_load(TestParams *params)
+{
+    printf_yellow("  Testing bptree bulk load (keys: %d) ---> ", params->num_keys);
+    mem_init(16 * 1024 * 1024);
+
+    uint32_t *keys = malloc(params->num_keys * sizeof(uint32_t));
+    uint32_t *values = malloc(params->num_keys * sizeof(uint32_t));
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        keys[i] = i * 3;
+        values[i] = keys[i] * 2;
+    }
+
+    BPlusTree *tree = bptree_create();
+    my_assert(bptree_bulk_load(tree, keys, values, params->num_keys) == 0);
+    my_assert(bptree_size(tree) == (size_t)params->num_keys);
+    my_assert(bptree_bulk_load(tree, keys, values, params->num_keys) == -1); // Tree is no longer empty
+
+    uint32_t value;
+    for (int i = 0; i < params->num_keys; i++)
+        my_assert(bptree_get(tree, keys[i], &value) == 1 && value == keys[i] * 2);
+
+    range_state_t state = {0};
+    my_assert(bptree_range(tree, 0, UINT32_MAX, visit_ascending, &state) == (size_t)params->num_keys);
+
+    // Inserts after a bulk load split the full leaves as usual
+    for (int i = 0; i < params->num_keys; i++)
+        my_assert(bptree_insert(tree, keys[i] + 1, (keys[i] + 1) * 2) == 0);
+    my_assert(bptree_size(tree) == (size_t)params->num_keys * 2);
+    state = (range_state_t){0};
+    my_assert(bptree_range(tree, 0, UINT32_MAX, visit_ascending, &state) == (size_t)params->num_keys * 2);
+    bptree_destroy(tree);
+
+    // Unsorted input is rejected
+    tree = bptree_create();
+    keys[0] = keys[1];
+    my_assert(bptree_bulk_load(tree, keys, values, params->num_keys) == -1);
+    my_assert(bptree_size(tree) == 0);
+    bptree_destroy(tree);
+
+    free(keys);
+    free(values);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// Each thread owns its tree, but all trees draw nodes from the shared memory pool
+void *thread_tree_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    BPlusTree *tree = bptree_create();
+    my_assert(tree != NULL);
+
+    for (int i = 0; i < data->num_keys; i++)
+        my_assert(bptree_insert(tree, rand(), data->thread_id) == 0);
+
+    range_state_t state = {0};
+    BPlusCursor cursor;
+    uint32_t key;
+    bptree_seek(tree, 0, &cursor);
+    while (bptree_next(&cursor, &key, NULL))
+    {
+        my_assert(state.count == 0 || key > state.last_key);
+        state.last_key = key;
+        state.count++;
+    }
+    my_assert(state.count == bptree_size(tree));
+
+    bptree_destroy(tree);
+    return NULL;
+}
+
+void test_bptree_multithread(TestParams *params)
+{
+    printf_yellow("  Testing bptree per-thread trees (threads: %d, keys: %d) ---> ", params->num_threads, params->num_keys);
+    mem_init(32 * 1024 * 1024);
+
+    pthread_t threads[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i].thread_id = i;
+        thread_data[i].num_keys = params->num_keys / params->num_threads;
+        if (pthread_create(&threads[i], NULL, thread_tree_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_bptree_insert_and_get - Test inserts, point lookups and ordered iteration\n");
+        printf(" 2. test_bptree_range - Test range scans\n");
+        printf(" 3. test_bptree_bulk_load - Test bulk loading from sorted input\n");
+        printf(" 4. test_bptree_multithread - Test per-thread trees on a shared pool\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        for (int j = 0; j < 17; j += 4) // from 2^0 = 1 up to 2^16 = 65536 keys
+        {
+            test_bptree_insert_and_get(&(TestParams){.num_keys = pow(2, j)});
+            test_bptree_range(&(TestParams){.num_keys = pow(2, j)});
+            test_bptree_bulk_load(&(TestParams){.num_keys = pow(2, j) + 1});
+        }
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_bptree_multithread(&(TestParams){.num_threads = pow(2, i), .num_keys = 16384});
+        break;
+    case 1:
+        test_bptree_insert_and_get(&(TestParams){.num_keys = 65536});
+        break;
+    case 2:
+        test_bptree_range(&(TestParams){.num_keys = 65536});
+        break;
+    case 3:
+        test_bptree_bulk_load(&(TestParams){.num_keys = 65536});
+        break;
+    case 4:
+        test_bptree_multithread(&(TestParams){.num_threads = base_num_threads, .num_keys = 16384});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
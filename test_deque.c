@@ -0,0 +1,290 @@
+#include "deque.h"
+#include "linked_list.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    ConcurrentDeque *deque; // Deque shared by all threads
+    int thread_id;          // Unique ID for each thread
+    int num_items;          // Number of items each producer pushes
+    atomic_long *sum;       // Sum of all popped items
+    atomic_int *popped;     // Number of popped items
+    int total;              // Number of items pushed by all producers
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_items;
+} TestParams;
+
+// ********* Test basic deque operations *********
+
+void test_deque_both_ends(TestParams *params)
+{
+    printf_yellow("  Testing deque push/pop at both ends (items: %d) ---> ", params->num_items);
+    mem_init(16 * 1024 * 1024);
+
+    Deque *deque = deque_create(sizeof(uint32_t));
+    my_assert(deque != NULL);
+    uint32_t value;
+    my_assert(deque_pop_back(deque, &value) == -1);
+    my_assert(deque_pop_front(deque, &value) == -1);
+    my_assert(deque_at(deque, 0) == NULL);
+
+    // Front gets the odd numbers descending, back the even ones ascending
+    for (int i = 0; i < params->num_items; i++)
+    {
+        uint32_t even = i * 2, odd = i * 2 + 1;
+        my_assert(deque_push_back(deque, &even) == 0);
+        my_assert(deque_push_front(deque, &odd) == 0);
+    }
+    my_assert(deque_size(deque) == (size_t)params->num_items * 2);
+
+    // Indexed access from the front
+    for (int i = 0; i < params->num_items; i++)
+    {
+        my_assert(*(uint32_t *)deque_at(deque, i) == (uint32_t)(params->num_items - 1 - i) * 2 + 1);
+        my_assert(*(uint32_t *)deque_at(deque, params->num_items + i) == (uint32_t)i * 2);
+    }
+    my_assert(deque_at(deque, params->num_items * 2) == NULL);
+
+    for (int i = params->num_items - 1; i >= 0; i--)
+    {
+        my_assert(deque_pop_back(deque, &value) == 0 && value == (uint32_t)i * 2);
+        my_assert(deque_pop_front(deque, &value) == 0 && value == (uint32_t)i * 2 + 1);
+    }
+    my_assert(deque_size(deque) == 0);
+    my_assert(deque_pop_front(deque, &value) == -1);
+
+    deque_destroy(deque);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_deque_sliding_window(TestParams *params)
+{
+    printf_yellow("  Testing deque sliding window (items: %d) ---> ", params->num_items);
+    mem_init(1024 * 1024);
+
+    // Appending at the tail and dropping from the head walks through the map forever,
+    // so the map must be re-centered instead of growing
+    Deque *deque = deque_create(sizeof(uint64_t));
+    int window = 100;
+    uint64_t value;
+    for (int i = 0; i < params->num_items; i++)
+    {
+        uint64_t item = i;
+        my_assert(deque_push_back(deque, &item) == 0);
+        if (deque_size(deque) > (size_t)window)
+        {
+            my_assert(deque_pop_front(deque, &value) == 0);
+            my_assert(value == (uint64_t)(i - window));
+        }
+    }
+    size_t expected = params->num_items < window ? params->num_items : window;
+    my_assert(deque_size(deque) == expected);
+    if (expected)
+        my_assert(*(uint64_t *)deque_at(deque, expected - 1) == (uint64_t)params->num_items - 1);
+
+    // Emptying and refilling from the other side reuses the memory
+    while (deque_pop_back(deque, NULL) == 0)
+        ;
+    for (int i = 0; i < params->num_items; i++)
+    {
+        uint64_t item = i;
+        my_assert(deque_push_front(deque, &item) == 0);
+        if (deque_size(deque) > (size_t)window)
+            my_assert(deque_pop_back(deque, &value) == 0 && value == (uint64_t)(i - window));
+    }
+
+    deque_destroy(deque);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Test the concurrent deque *********
+
+void *thread_producer_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    for (int i = 0; i < data->num_items; i++)
+    {
+        uint32_t item = data->thread_id * data->num_items + i + 1;
+        // Alternate ends so both locks see pushes
+        if (i % 2)
+            my_assert(cdeque_push_back(data->deque, &item) == 0);
+        else
+            my_assert(cdeque_push_front(data->deque, &item) == 0);
+    }
+    return NULL;
+}
+
+void *thread_consumer_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    uint32_t item;
+    int turn = data->thread_id;
+    while (atomic_load(data->popped) < data->total)
+    {
+        int status = turn++ % 2 ? cdeque_pop_back(data->deque, &item) : cdeque_pop_front(data->deque, &item);
+        if (status == 0)
+        {
+            atomic_fetch_add(data->sum, item);
+            atomic_fetch_add(data->popped, 1);
+        }
+    }
+    return NULL;
+}
+
+void test_cdeque_multithread(TestParams *params)
+{
+    printf_yellow("  Testing concurrent deque (threads: %d, items: %d) ---> ", params->num_threads, params->num_items);
+    mem_init(32 * 1024 * 1024);
+
+    ConcurrentDeque *deque = cdeque_create(sizeof(uint32_t));
+    my_assert(deque != NULL);
+
+    // Half of the threads produce, the other half consume (at least one of each)
+    int producers = params->num_threads > 1 ? params->num_threads / 2 : 1;
+    int consumers = params->num_threads > 1 ? params->num_threads - producers : 1;
+    int per_producer = params->num_items / producers;
+    int total = per_producer * producers;
+
+    atomic_long sum = 0;
+    atomic_int popped = 0;
+    pthread_t threads[producers + consumers];
+    thread_data_t thread_data[producers + consumers];
+
+    for (int i = 0; i < producers + consumers; i++)
+    {
+        thread_data[i] = (thread_data_t){.deque = deque, .thread_id = i < producers ? i : i - producers, .num_items = per_producer, .sum = &sum, .popped = &popped, .total = total};
+        if (pthread_create(&threads[i], NULL, i < producers ? thread_producer_function : thread_consumer_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < producers + consumers; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Every item 1..total was popped exactly once
+    my_assert(popped == total);
+    my_assert(sum == (long)total * (total + 1) / 2);
+    my_assert(cdeque_size(deque) == 0);
+
+    cdeque_destroy(deque);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Compare against a list used as a sliding window *********
+
+void test_deque_performance(TestParams *params)
+{
+    printf_yellow("  Testing deque vs list sliding window (items: %d) ---> ", params->num_items);
+    mem_init(16 * 1024 * 1024);
+    int window = 1024;
+
+    Node *head = NULL;
+    int list_size = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_items; i++)
+    {
+        list_insert(&head, (uint16_t)i);
+        if (++list_size > window)
+        {
+            list_delete(&head, head->data);
+            list_size--;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double list_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    list_cleanup(&head);
+
+    Deque *deque = deque_create(sizeof(uint16_t));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_items; i++)
+    {
+        uint16_t item = (uint16_t)i;
+        deque_push_back(deque, &item);
+        if (deque_size(deque) > (size_t)window)
+            deque_pop_front(deque, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double deque_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    my_assert(deque_size(deque) == (size_t)window);
+
+    printf("list: %f s, deque: %f s ---> ", list_time, deque_time);
+
+    deque_destroy(deque);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_deque_both_ends - Test push, pop and indexing at both ends\n");
+        printf(" 2. test_deque_sliding_window - Test a sliding window that walks through the chunk map\n");
+        printf(" 3. test_cdeque_multithread - Test the concurrent deque with a base number of threads\n");
+        printf(" 4. test_deque_performance - Compare against the linked list as a sliding window\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        for (int j = 0; j < 17; j += 4) // from 2^0 = 1 up to 2^16 = 65536 items
+        {
+            test_deque_both_ends(&(TestParams){.num_items = pow(2, j)});
+            test_deque_sliding_window(&(TestParams){.num_items = pow(2, j)});
+        }
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_cdeque_multithread(&(TestParams){.num_threads = pow(2, i), .num_items = 65536});
+        break;
+    case 1:
+        test_deque_both_ends(&(TestParams){.num_items = 65536});
+        break;
+    case 2:
+        test_deque_sliding_window(&(TestParams){.num_items = 1000000});
+        break;
+    case 3:
+        test_cdeque_multithread(&(TestParams){.num_threads = base_num_threads, .num_items = 65536});
+        break;
+    case 4:
+        test_deque_performance(&(TestParams){.num_items = 65536});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include "hash_set.h"
+#include "linked_list.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    HashSet *set;  // Set shared by all threads
+    int thread_id; // Unique ID for each thread
+    int num_keys;  // Number of keys each thread owns
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_keys;
+} TestParams;
+
+// ********* Test basic set operations *********
+
+void test_hash_set_basic(TestParams *params)
+{
+    printf_yellow("  Testing hash set insert/contains/remove (keys: %d) ---> ", params->num_keys);
+    mem_init(16 * 1024 * 1024);
+
+    // Start small so every segment has to grow
+    HashSet *set = hash_set_create(8, 0);
+    my_assert(set != NULL);
+    my_assert(hash_set_contains(set, 0) == 0);
+
+    for (int i = 0; i < params->num_keys; i++)
+        my_assert(hash_set_insert(set, i * 3) == 1);
+    my_assert(hash_set_insert(set, 0) == 0);
+    my_assert(hash_set_size(set) == (size_t)params->num_keys);
+
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        my_assert(hash_set_contains(set, i * 3) == 1);
+        my_assert(hash_set_contains(set, i * 3 + 1) == 0);
+    }
+
+    // Remove every other key; the probe chains of the rest must stay intact
+    for (int i = 0; i < params->num_keys; i += 2)
+        my_assert(hash_set_remove(set, i * 3) == 1);
+    my_assert(hash_set_remove(set, 0) == 0);
+    for (int i = 0; i < params->num_keys; i++)
+        my_assert(hash_set_contains(set, i * 3) == (i % 2));
+    my_assert(hash_set_size(set) == (size_t)params->num_keys / 2);
+
+    // UINT32_MAX is an ordinary key
+    my_assert(hash_set_insert(set, UINT32_MAX) == 1);
+    my_assert(hash_set_contains(set, UINT32_MAX) == 1);
+    my_assert(hash_set_remove(set, UINT32_MAX) == 1);
+
+    hash_set_destroy(set);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void *thread_hash_set_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    uint32_t base = (uint32_t)data->thread_id * data->num_keys;
+
+    // Each thread owns a key range, so its own view must be exact even while others write
+    for (int i = 0; i < data->num_keys; i++)
+        my_assert(hash_set_insert(data->set, base + i) == 1);
+    for (int i = 0; i < data->num_keys; i++)
+        my_assert(hash_set_contains(data->set, base + i) == 1);
+    for (int i = 0; i < data->num_keys; i += 2)
+        my_assert(hash_set_remove(data->set, base + i) == 1);
+    for (int i = 0; i < data->num_keys; i++)
+        my_assert(hash_set_contains(data->set, base + i) == (i % 2));
+    return NULL;
+}
+
+void test_hash_set_multithread(TestParams *params)
+{
+    printf_yellow("  Testing hash set concurrent access (threads: %d, keys: %d) ---> ", params->num_threads, params->num_keys);
+    mem_init(32 * 1024 * 1024);
+
+    HashSet *set = hash_set_create(64, 1024);
+    my_assert(set != NULL);
+
+    pthread_t threads[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i].set = set;
+        thread_data[i].thread_id = i;
+        thread_data[i].num_keys = params->num_keys / params->num_threads;
+        if (pthread_create(&threads[i], NULL, thread_hash_set_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    int per_thread = params->num_keys / params->num_threads;
+    my_assert(hash_set_size(set) == (size_t)params->num_threads * (per_thread / 2));
+
+    hash_set_destroy(set);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Compare against list_search membership *********
+
+void test_hash_set_performance(TestParams *params)
+{
+    printf_yellow("  Testing hash set vs list_search membership (keys: %d) ---> ", params->num_keys);
+    mem_init(16 * 1024 * 1024);
+
+    Node *head = NULL;
+    HashSet *set = hash_set_create(16, params->num_keys);
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        list_insert(&head, i * 2);
+        hash_set_insert(set, i * 2);
+    }
+
+    struct timespec start, end;
+    int list_hits = 0, set_hits = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_keys; i++)
+        list_hits += list_search(&head, i) != NULL;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double list_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_keys; i++)
+        set_hits += hash_set_contains(set, i);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double set_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    my_assert(list_hits == set_hits);
+    printf("list: %f s, set: %f s ---> ", list_time, set_time);
+
+    list_cleanup(&head);
+    hash_set_destroy(set);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_hash_set_basic - Test insert, contains, remove and segment growth\n");
+        printf(" 2. test_hash_set_multithread - Test concurrent access with a base number of threads\n");
+        printf(" 3. test_hash_set_performance - Compare membership checks against list_search\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        for (int j = 0; j < 17; j += 4) // from 2^0 = 1 up to 2^16 = 65536 keys
+            test_hash_set_basic(&(TestParams){.num_keys = pow(2, j)});
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_hash_set_multithread(&(TestParams){.num_threads = pow(2, i), .num_keys = 65536});
+        break;
+    case 1:
+        test_hash_set_basic(&(TestParams){.num_keys = 65536});
+        break;
+    case 2:
+        test_hash_set_multithread(&(TestParams){.num_threads = base_num_threads, .num_keys = 65536});
+        break;
+    case 3:
+        test_hash_set_performance(&(TestParams){.num_keys = 16384});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
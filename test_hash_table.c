@@ -0,0 +1,223 @@
+#include "hash_table.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    int thread_id; // Unique ID for each thread
+    int num_keys;  // Number of keys each thread inserts into its own table
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_keys;
+    size_t memory_size;
+} TestParams;
+
+// ********* Test basic hash table operations *********
+
+void test_hash_table_basic()
+{
+    printf_yellow("  Testing hash_table insert/get/remove ---> ");
+    mem_init(1024 * 1024);
+
+    HashTable *table = hash_table_create(0);
+    my_assert(table != NULL);
+
+    uint32_t value = 0;
+    my_assert(hash_table_get(table, 42, &value) == 0);
+
+    my_assert(hash_table_insert(table, 42, 1) == 0);
+    my_assert(hash_table_insert(table, 7, 2) == 0);
+    my_assert(hash_table_size(table) == 2);
+    my_assert(hash_table_get(table, 42, &value) == 1 && value == 1);
+    my_assert(hash_table_get(table, 7, &value) == 1 && value == 2);
+
+    // Updating an existing key must not add a new entry
+    my_assert(hash_table_insert(table, 42, 3) == 0);
+    my_assert(hash_table_size(table) == 2);
+    my_assert(hash_table_get(table, 42, &value) == 1 && value == 3);
+
+    my_assert(hash_table_remove(table, 42) == 1);
+    my_assert(hash_table_remove(table, 42) == 0);
+    my_assert(hash_table_get(table, 42, &value) == 0);
+    my_assert(hash_table_get(table, 7, &value) == 1 && value == 2);
+    my_assert(hash_table_size(table) == 1);
+
+    hash_table_destroy(table);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_hash_table_growth(TestParams *params)
+{
+    printf_yellow("  Testing hash_table growth (keys: %d) ---> ", params->num_keys);
+    mem_init(params->memory_size);
+
+    HashTable *table = hash_table_create(0);
+    my_assert(table != NULL);
+
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        my_assert(hash_table_insert(table, (uint32_t)i * 2654435761u, i) == 0);
+    }
+    my_assert(hash_table_size(table) == (size_t)params->num_keys);
+
+    uint32_t value;
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        my_assert(hash_table_get(table, (uint32_t)i * 2654435761u, &value) == 1);
+        my_assert(value == (uint32_t)i);
+    }
+
+    hash_table_destroy(table);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// Interleaved inserts and removes leave tombstones behind, which forces in-place rehashing
+void test_hash_table_churn(TestParams *params)
+{
+    printf_yellow("  Testing hash_table insert/remove churn (keys: %d) ---> ", params->num_keys);
+    mem_init(params->memory_size);
+
+    HashTable *table = hash_table_create(64);
+    my_assert(table != NULL);
+
+    int window = params->num_keys < 96 ? params->num_keys / 2 : 48;
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        my_assert(hash_table_insert(table, i, i + 1) == 0);
+        if (i >= window)
+        {
+            my_assert(hash_table_remove(table, i - window) == 1);
+        }
+    }
+    my_assert(hash_table_size(table) == (size_t)window);
+
+    uint32_t value;
+    for (int i = 0; i < params->num_keys; i++)
+    {
+        int expected = i >= params->num_keys - window;
+        my_assert(hash_table_get(table, i, &value) == expected);
+        if (expected)
+            my_assert(value == (uint32_t)i + 1);
+    }
+
+    hash_table_destroy(table);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// Each thread owns its table, but all tables draw from the shared memory pool
+void *thread_table_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    HashTable *table = hash_table_create(0);
+    my_assert(table != NULL);
+
+    uint32_t base = (uint32_t)data->thread_id << 20;
+    for (int i = 0; i < data->num_keys; i++)
+    {
+        my_assert(hash_table_insert(table, base + i, i) == 0);
+    }
+    uint32_t value;
+    for (int i = 0; i < data->num_keys; i++)
+    {
+        my_assert(hash_table_get(table, base + i, &value) == 1 && value == (uint32_t)i);
+    }
+
+    hash_table_destroy(table);
+    return NULL;
+}
+
+void test_hash_table_multithread(TestParams *params)
+{
+    printf_yellow("  Testing hash_table per-thread tables (threads: %d, keys: %d) ---> ", params->num_threads, params->num_keys);
+    mem_init(params->memory_size);
+
+    pthread_t threads[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+    int keys_per_thread = params->num_keys / params->num_threads;
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i].thread_id = i;
+        thread_data[i].num_keys = keys_per_thread;
+        if (pthread_create(&threads[i], NULL, thread_table_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_hash_table_basic - Test insert, get and remove\n");
+        printf(" 2. test_hash_table_growth - Test growth via mem_resize\n");
+        printf(" 3. test_hash_table_churn - Test tombstones and in-place rehashing\n");
+        printf(" 4. test_hash_table_multithread - Test per-thread tables on a shared pool\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        test_hash_table_basic();
+        for (int j = 4; j < 17; j += 4) // from 2^4 = 16 up to 2^16 = 65536 keys
+        {
+            test_hash_table_growth(&(TestParams){.num_keys = pow(2, j), .memory_size = 8 * 1024 * 1024});
+            test_hash_table_churn(&(TestParams){.num_keys = pow(2, j), .memory_size = 1024 * 1024});
+        }
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_hash_table_multithread(&(TestParams){.num_threads = pow(2, i), .num_keys = 16384, .memory_size = 16 * 1024 * 1024});
+        break;
+    case 1:
+        test_hash_table_basic();
+        break;
+    case 2:
+        test_hash_table_growth(&(TestParams){.num_keys = 65536, .memory_size = 8 * 1024 * 1024});
+        break;
+    case 3:
+        test_hash_table_churn(&(TestParams){.num_keys = 65536, .memory_size = 1024 * 1024});
+        break;
+    case 4:
+        test_hash_table_multithread(&(TestParams){.num_threads = base_num_threads, .num_keys = 16384, .memory_size = 16 * 1024 * 1024});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
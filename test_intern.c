@@ -0,0 +1,242 @@
+#include "intern.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    int thread_id;   // Unique ID for each thread
+    int num_strings; // Number of strings each thread interns into its own pool
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_strings;
+} TestParams;
+
+// ********* Test basic interning *********
+
+void test_intern_basic(TestParams *params)
+{
+    printf_yellow("  Testing intern string/get/find (strings: %d) ---> ", params->num_strings);
+    mem_init(16 * 1024 * 1024);
+
+    StringPool *pool = intern_create(4);
+    my_assert(pool != NULL);
+    my_assert(intern_count(pool) == 0);
+    my_assert(intern_get(pool, 0) == NULL);
+    my_assert(intern_find(pool, "missing", 7) == INTERN_INVALID_ID);
+
+    // IDs are handed out densely in first-seen order
+    char buffer[32];
+    for (int i = 0; i < params->num_strings; i++)
+    {
+        sprintf(buffer, "string-%d", i);
+        my_assert(intern_string(pool, buffer) == (uint32_t)i);
+    }
+    my_assert(intern_count(pool) == (size_t)params->num_strings);
+
+    // Interning the same contents again returns the same ID and stores nothing new
+    for (int i = 0; i < params->num_strings; i++)
+    {
+        sprintf(buffer, "string-%d", i);
+        my_assert(intern_string(pool, buffer) == (uint32_t)i);
+        my_assert(intern_find(pool, buffer, strlen(buffer)) == (uint32_t)i);
+        my_assert(strcmp(intern_get(pool, i), buffer) == 0);
+        my_assert(intern_length(pool, i) == strlen(buffer));
+    }
+    my_assert(intern_count(pool) == (size_t)params->num_strings);
+
+    intern_destroy(pool);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_intern_lengths()
+{
+    printf_yellow("  Testing intern explicit lengths and self-references ---> ");
+    mem_init(1024 * 1024);
+
+    StringPool *pool = intern_create(0);
+    my_assert(pool != NULL);
+
+    // Prefixes and embedded NUL bytes are distinct strings
+    uint32_t empty = intern_string(pool, "");
+    uint32_t ab = intern_string_n(pool, "abc", 2);
+    uint32_t abc = intern_string(pool, "abc");
+    uint32_t with_nul = intern_string_n(pool, "ab\0c", 4);
+    my_assert(empty != ab && ab != abc && abc != with_nul && ab != with_nul);
+    my_assert(intern_length(pool, empty) == 0 && strcmp(intern_get(pool, empty), "") == 0);
+    my_assert(strcmp(intern_get(pool, ab), "ab") == 0);
+    my_assert(intern_length(pool, with_nul) == 4);
+    my_assert(memcmp(intern_get(pool, with_nul), "ab\0c", 4) == 0);
+
+    // Interning a substring of an already interned string, even while the arena grows
+    for (int i = 0; i < 1000; i++)
+    {
+        const char *source = intern_get(pool, abc);
+        uint32_t id = intern_string_n(pool, source + 1, 2);
+        my_assert(strcmp(intern_get(pool, id), "bc") == 0);
+        char buffer[32];
+        sprintf(buffer, "filler-%d", i);
+        intern_string(pool, buffer);
+    }
+    my_assert(intern_find(pool, "bc", 2) != INTERN_INVALID_ID);
+
+    intern_destroy(pool);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// Each thread owns its pool, but all pools draw memory from the shared memory pool
+void *thread_intern_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    StringPool *pool = intern_create(16);
+    my_assert(pool != NULL);
+
+    char buffer[32];
+    for (int i = 0; i < data->num_strings; i++)
+    {
+        sprintf(buffer, "%d:%d", data->thread_id, i % 64);
+        uint32_t id = intern_string(pool, buffer);
+        my_assert(id == (uint32_t)(i % 64));
+    }
+    my_assert(intern_count(pool) == (size_t)(data->num_strings < 64 ? data->num_strings : 64));
+
+    intern_destroy(pool);
+    return NULL;
+}
+
+void test_intern_multithread(TestParams *params)
+{
+    printf_yellow("  Testing intern per-thread pools (threads: %d, strings: %d) ---> ", params->num_threads, params->num_strings);
+    mem_init(32 * 1024 * 1024);
+
+    pthread_t threads[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i].thread_id = i;
+        thread_data[i].num_strings = params->num_strings;
+        if (pthread_create(&threads[i], NULL, thread_intern_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Compare integer IDs against strcmp *********
+
+void test_intern_compare_performance(TestParams *params)
+{
+    printf_yellow("  Testing intern ID compare vs strcmp (strings: %d) ---> ", params->num_strings);
+    mem_init(16 * 1024 * 1024);
+
+    StringPool *pool = intern_create(params->num_strings);
+    char **strings = malloc(params->num_strings * sizeof(char *));
+    uint32_t *ids = malloc(params->num_strings * sizeof(uint32_t));
+    for (int i = 0; i < params->num_strings; i++)
+    {
+        strings[i] = malloc(48);
+        sprintf(strings[i], "a-fairly-long-shared-prefix/%d", i);
+        ids[i] = intern_string(pool, strings[i]);
+    }
+
+    struct timespec start, end;
+    size_t matches = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_strings; i++)
+        for (int j = 0; j < 64; j++)
+            matches += strcmp(strings[i], strings[(i + j) % params->num_strings]) == 0;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double strcmp_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    size_t id_matches = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_strings; i++)
+        for (int j = 0; j < 64; j++)
+            id_matches += ids[i] == ids[(i + j) % params->num_strings];
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double id_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    my_assert(matches == id_matches);
+    printf("strcmp: %f s, ids: %f s ---> ", strcmp_time, id_time);
+
+    for (int i = 0; i < params->num_strings; i++)
+        free(strings[i]);
+    free(strings);
+    free(ids);
+    intern_destroy(pool);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_intern_basic - Test interning, lookups and stable IDs\n");
+        printf(" 2. test_intern_lengths - Test explicit lengths and interning from the arena itself\n");
+        printf(" 3. test_intern_multithread - Test per-thread pools on a shared memory pool\n");
+        printf(" 4. test_intern_compare_performance - Compare ID equality against strcmp\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        for (int j = 0; j < 17; j += 4) // from 2^0 = 1 up to 2^16 = 65536 strings
+            test_intern_basic(&(TestParams){.num_strings = pow(2, j)});
+        test_intern_lengths();
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_intern_multithread(&(TestParams){.num_threads = pow(2, i), .num_strings = 1024});
+        break;
+    case 1:
+        test_intern_basic(&(TestParams){.num_strings = 65536});
+        break;
+    case 2:
+        test_intern_lengths();
+        break;
+    case 3:
+        test_intern_multithread(&(TestParams){.num_threads = base_num_threads, .num_strings = 1024});
+        break;
+    case 4:
+        test_intern_compare_performance(&(TestParams){.num_strings = 65536});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
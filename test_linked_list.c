@@ -644,6 +644,150 @@ void test_list_edge_cases()
     printf_green("[PASS].\n");
 }
 
+// ********* Set operations between lists *********
+
+// Checks that a result list is strictly ascending and matches the expected membership
+void check_set_result(Node *result, const char *expected)
+{
+    int count = 0;
+    for (Node *current = result; current; current = current->next)
+    {
+        my_assert(expected[current->data]);
+        my_assert(!current->next || current->next->data > current->data);
+        count++;
+    }
+    int expected_count = 0;
+    for (int v = 0; v < 65536; v++)
+        expected_count += expected[v];
+    my_assert(count == expected_count);
+}
+
+void test_list_set_operations(int count, int sorted)
+{
+    printf_yellow("  Testing list set operations (nodes: %d, %s) ---> ", count, sorted ? "sorted" : "unsorted");
+    Node *a = NULL, *b = NULL, *result = NULL;
+    char *in_a = calloc(65536, 1);
+    char *in_b = calloc(65536, 1);
+    char *expected = malloc(65536);
+
+    // Overlapping value ranges with duplicates; sorted inputs take the merge-join path
+    for (int i = 0; i < count; i++)
+    {
+        uint16_t va = sorted ? i * 3 / 4 : rand() % (count * 2);
+        uint16_t vb = sorted ? count / 2 + i : rand() % (count * 2);
+        list_insert(&a, va);
+        list_insert(&b, vb);
+        in_a[va] = 1;
+        in_b[vb] = 1;
+    }
+
+    list_intersect(&a, &b, &result);
+    for (int v = 0; v < 65536; v++)
+        expected[v] = in_a[v] && in_b[v];
+    check_set_result(result, expected);
+    list_cleanup(&result);
+
+    list_union(&a, &b, &result);
+    for (int v = 0; v < 65536; v++)
+        expected[v] = in_a[v] || in_b[v];
+    check_set_result(result, expected);
+    list_cleanup(&result);
+
+    list_difference(&a, &b, &result);
+    for (int v = 0; v < 65536; v++)
+        expected[v] = in_a[v] && !in_b[v];
+    check_set_result(result, expected);
+    list_cleanup(&result);
+
+    // Operations with an empty list
+    Node *empty = NULL;
+    list_intersect(&a, &empty, &result);
+    my_assert(result == NULL);
+    list_difference(&empty, &a, &result);
+    my_assert(result == NULL);
+    list_union(&empty, &a, &result);
+    check_set_result(result, in_a);
+    list_cleanup(&result);
+
+    list_cleanup(&a);
+    list_cleanup(&b);
+    free(in_a);
+    free(in_b);
+    free(expected);
+    printf_green("[PASS].\n");
+}
+
+void test_list_intersect_performance(int count)
+{
+    printf_yellow("  Testing list_intersect vs list_search loop (nodes: %d) ---> ", count);
+    Node *a = NULL, *b = NULL, *result = NULL;
+    for (int i = 0; i < count; i++)
+    {
+        list_insert(&a, rand() % 65536);
+        list_insert(&b, rand() % 65536);
+    }
+
+    struct timespec start, end;
+    int search_matches = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (Node *current = a; current; current = current->next)
+        search_matches += list_search(&b, current->data) != NULL;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double search_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    list_intersect(&a, &b, &result);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double intersect_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    // The search loop counts duplicates in a, the intersection does not
+    my_assert(list_count_nodes(&result) <= search_matches);
+    printf("search: %f s, intersect: %f s ---> ", search_time, intersect_time);
+
+    list_cleanup(&result);
+    list_cleanup(&a);
+    list_cleanup(&b);
+    printf_green("[PASS].\n");
+}
+
+void test_list_apply_batch()
+{
+    printf_yellow("  Testing list_apply_batch ---> ");
+    Node *head = NULL;
+    list_insert(&head, 1);
+
+    ListOp ops[] = {
+        {LIST_OP_INSERT, 2},
+        {LIST_OP_INSERT, 3},
+        {LIST_OP_COUNT, 0},
+        {LIST_OP_DELETE, 3}, // Deleting the tail must not leave a stale tail pointer
+        {LIST_OP_INSERT, 4},
+        {LIST_OP_SEARCH, 3},
+        {LIST_OP_SEARCH, 4},
+        {LIST_OP_DELETE, 9},
+        {LIST_OP_COUNT, 0},
+    };
+    int results[9];
+    list_apply_batch(&head, ops, 9, results);
+
+    my_assert(results[0] == 0 && results[1] == 0);
+    my_assert(results[2] == 3);
+    my_assert(results[3] == 1);
+    my_assert(results[5] == 0 && results[6] == 1);
+    my_assert(results[7] == 0);
+    my_assert(results[8] == 3);
+    my_assert(head->data == 1 && head->next->data == 2 && head->next->next->data == 4);
+    my_assert(head->next->next->next == NULL);
+
+    // Emptying the list and refilling it in one batch
+    ListOp refill[] = {{LIST_OP_DELETE, 1}, {LIST_OP_DELETE, 2}, {LIST_OP_DELETE, 4}, {LIST_OP_INSERT, 7}, {LIST_OP_COUNT, 0}};
+    list_apply_batch(&head, refill, 5, results);
+    my_assert(results[4] == 1 && head->data == 7 && head->next == NULL);
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
 // Main function to run all tests
 int main(int argc, char *argv[])
 {
@@ -670,6 +814,9 @@ int main(int argc, char *argv[])
         printf(" 6. test_list_insert_after - Test multiple insertions after a given node\n");
         printf(" 7. test_list_insert_after - Test multiple insertions after a given node\n");
         printf(" 8. test_list_delete - Test multiple detelions\n");
+        printf(" 9. test_list_set_operations - Test intersect, union and difference\n");
+        printf(" 10. test_list_intersect_performance - Compare list_intersect against a list_search loop\n");
+        printf(" 11. test_list_apply_batch - Test batched operations under one lock\n");
         printf(" 0. Run all tests\n");
         return 1;
     }
@@ -696,6 +843,12 @@ int main(int argc, char *argv[])
                 test_list_delete_multithreaded(&(TestParams){.num_threads = pow(2, i), .num_nodes = pow(2, j)});
             }
 
+        for (int j = 0; j < 15; j += 2) // from 2^0 = 1 up to 2^14 = 16384 nodes
+        {
+            test_list_set_operations(pow(2, j), 1);
+            test_list_set_operations(pow(2, j), 0);
+        }
+        test_list_apply_batch();
         break;
     case 1:
         test_list_insert_multithread(&(TestParams){.num_threads = base_num_threads, .num_nodes = 1024});
@@ -730,6 +883,17 @@ int main(int argc, char *argv[])
                 test_list_delete_multithreaded(&(TestParams){.num_threads = pow(2, i), .num_nodes = pow(2, j)});
         break;
 
+    case 9:
+        test_list_set_operations(16384, 1);
+        test_list_set_operations(16384, 0);
+        break;
+    case 10:
+        test_list_intersect_performance(16384);
+        break;
+    case 11:
+        test_list_apply_batch();
+        break;
+
     default:
         printf("Invalid test function\n");
         break;
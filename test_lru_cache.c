@@ -0,0 +1,228 @@
+#include "lru_cache.h"
+#include "linked_list.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    LRUCache *cache; // Cache shared by all threads
+    int thread_id;   // Unique ID for each thread
+    int num_ops;     // Number of operations each thread performs
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_ops;
+    int capacity;
+} TestParams;
+
+// ********* Test basic cache operations *********
+
+void test_lru_put_get_evict(TestParams *params)
+{
+    printf_yellow("  Testing lru put/get/evict (capacity: %d) ---> ", params->capacity);
+    mem_init(16 * 1024 * 1024);
+
+    // A single shard gives exact LRU order
+    LRUCache *cache = lru_create(params->capacity, 1);
+    my_assert(cache != NULL);
+    my_assert(lru_get(cache, 1, NULL) == 0);
+
+    for (int i = 0; i < params->capacity; i++)
+        my_assert(lru_put(cache, i, i * 2) == 0);
+    my_assert(lru_size(cache) == (size_t)params->capacity);
+
+    // Touch the first half so the second half becomes least recently used
+    uint32_t value;
+    int half = params->capacity / 2;
+    for (int i = 0; i < half; i++)
+        my_assert(lru_get(cache, i, &value) == 1 && value == (uint32_t)i * 2);
+
+    // New keys evict the untouched half, oldest first
+    for (int i = 0; i < params->capacity - half; i++)
+    {
+        my_assert(lru_put(cache, params->capacity + i, i) == 0);
+        my_assert(lru_get(cache, half + i, NULL) == 0);
+    }
+    my_assert(lru_size(cache) == (size_t)params->capacity);
+    for (int i = 0; i < half; i++)
+        my_assert(lru_get(cache, i, &value) == 1 && value == (uint32_t)i * 2);
+
+    // Updating keeps the size and refreshes the value
+    my_assert(lru_put(cache, 0, 12345) == 0);
+    my_assert(lru_get(cache, 0, &value) == 1 && value == 12345);
+    my_assert(lru_size(cache) == (size_t)params->capacity);
+
+    // Removed entries are reused without evicting anything
+    my_assert(lru_remove(cache, 0) == 1);
+    my_assert(lru_remove(cache, 0) == 0);
+    my_assert(lru_size(cache) == (size_t)params->capacity - 1);
+    my_assert(lru_put(cache, 0, 1) == 0);
+    my_assert(lru_size(cache) == (size_t)params->capacity);
+    if (half > 1)
+        my_assert(lru_get(cache, 1, NULL) == 1);
+
+    lru_destroy(cache);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void *thread_lru_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    uint32_t base = (uint32_t)data->thread_id << 16;
+    uint32_t value;
+
+    for (int i = 0; i < data->num_ops; i++)
+    {
+        uint32_t key = base + (i % 256);
+        my_assert(lru_put(data->cache, key, key) == 0);
+        // A hit must always return the value stored for that key
+        if (lru_get(data->cache, base + (rand() % 256), &value))
+            my_assert((value >> 16) == (uint32_t)data->thread_id);
+        if (i % 7 == 0)
+            lru_remove(data->cache, base + (rand() % 256));
+    }
+    return NULL;
+}
+
+void test_lru_multithread(TestParams *params)
+{
+    printf_yellow("  Testing lru sharded cache (threads: %d, ops: %d) ---> ", params->num_threads, params->num_ops);
+    mem_init(16 * 1024 * 1024);
+
+    LRUCache *cache = lru_create(params->capacity, 16);
+    my_assert(cache != NULL);
+
+    pthread_t threads[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i].cache = cache;
+        thread_data[i].thread_id = i;
+        thread_data[i].num_ops = params->num_ops / params->num_threads;
+        if (pthread_create(&threads[i], NULL, thread_lru_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    my_assert(lru_size(cache) <= (size_t)params->capacity);
+
+    lru_destroy(cache);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Compare against an LRU emulated with the linked list *********
+
+void test_lru_performance(TestParams *params)
+{
+    printf_yellow("  Testing lru vs list-emulated LRU (capacity: %d, ops: %d) ---> ", params->capacity, params->num_ops);
+    mem_init(16 * 1024 * 1024);
+
+    // List emulation: a touch deletes the value and re-appends it at the tail
+    Node *head = NULL;
+    int list_size = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_ops; i++)
+    {
+        uint16_t key = rand() % (params->capacity * 2);
+        if (list_search(&head, key))
+        {
+            list_delete(&head, key);
+            list_size--;
+        }
+        else if (list_size == params->capacity)
+        {
+            list_delete(&head, head->data);
+            list_size--;
+        }
+        list_insert(&head, key);
+        list_size++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double list_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    list_cleanup(&head);
+
+    LRUCache *cache = lru_create(params->capacity, 1);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < params->num_ops; i++)
+    {
+        uint16_t key = rand() % (params->capacity * 2);
+        if (!lru_get(cache, key, NULL))
+            my_assert(lru_put(cache, key, key) == 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double lru_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    my_assert(lru_size(cache) == (size_t)params->capacity);
+
+    printf("list: %f s, lru: %f s ---> ", list_time, lru_time);
+
+    lru_destroy(cache);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_lru_put_get_evict - Test put, get, update, remove and eviction order\n");
+        printf(" 2. test_lru_multithread - Test a sharded cache with a base number of threads\n");
+        printf(" 3. test_lru_performance - Compare against an LRU emulated with the linked list\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        for (int j = 0; j < 17; j += 4) // from 2^0 = 1 up to 2^16 = 65536 entries
+            test_lru_put_get_evict(&(TestParams){.capacity = pow(2, j)});
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_lru_multithread(&(TestParams){.num_threads = pow(2, i), .num_ops = 65536, .capacity = 1024});
+        break;
+    case 1:
+        test_lru_put_get_evict(&(TestParams){.capacity = 65536});
+        break;
+    case 2:
+        test_lru_multithread(&(TestParams){.num_threads = base_num_threads, .num_ops = 65536, .capacity = 1024});
+        break;
+    case 3:
+        test_lru_performance(&(TestParams){.capacity = 1024, .num_ops = 65536});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
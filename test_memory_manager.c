@@ -2,17 +2,21 @@
 #include <sys/time.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "memory_manager.h"
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <time.h>
 #include <dlfcn.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
 #include <fcntl.h>
 #include "common_defs.h"
 #include "barrier.h"
+#include "scheduler.h"
 
 #include <unistd.h>
 
@@ -234,6 +238,26 @@ void *test_zero_alloc_and_free(void *arg)
     return NULL;
 }
 
+void *test_aligned_alloc_and_free(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+
+    // Each thread asks for a different power of two alignment
+    size_t alignment = (size_t)16 << (data->thread_id % 4);
+    size_t size = data->block_size / 4;
+    char *block = (char *)mem_alloc_aligned(size, alignment);
+    my_assert(block != NULL);
+    my_assert(((size_t)block & (alignment - 1)) == 0);
+    memset(block, data->thread_id, size);
+
+    my_barrier_wait(&barrier);
+
+    sanityCheck(size, block, data->thread_id);
+    mem_free(block);
+
+    return NULL;
+}
+
 /*
  * This function is used to test the allocation of random blocks of memory and then freeing them in a multithreading context.
  * The test passes if all allocations and deallocations are successful.
@@ -299,6 +323,47 @@ void test_random_blocks_multithread(TestParams params)
     printf_green("[PASS].\n");
 }
 
+/*
+ * Same workload as test_random_blocks_multithread, but the per-thread work items run as tasks
+ * on the work-stealing scheduler instead of one pthread_create per item.
+ */
+void run_alloc_free_range(size_t begin, size_t end, void *ctx)
+{
+    thread_data_t *thread_data = (thread_data_t *)ctx;
+    for (size_t i = begin; i < end; i++)
+        thread_alloc_free(&thread_data[i]);
+}
+
+void test_random_blocks_scheduled(TestParams params)
+{
+    printf_yellow("  Testing \"mem_alloc\" and mem_free for random blocks on the scheduler (workers: %d, max_block_size: %zu) ---> ", params.num_threads, params.block_size);
+    srand(time(NULL)); // Initialize random seed
+
+    int total_blocks = 1000 + rand() % 10000;
+    int mem_size = total_blocks * params.block_size;
+    int num_items = params.num_threads * 4; // More work items than workers so they get stolen
+
+    mem_init(mem_size);
+    Scheduler *scheduler = sched_create(params.num_threads);
+    my_assert(scheduler != NULL);
+
+    thread_data_t thread_data[num_items];
+    void *block_pointers[total_blocks]; // Array to hold pointers to allocated blocks
+
+    for (int i = 0; i < num_items; i++)
+    {
+        thread_data[i].num_blocks = total_blocks / num_items;
+        thread_data[i].max_block_size = params.block_size;
+        thread_data[i].block_pointers = &block_pointers[i * thread_data[i].num_blocks];
+    }
+
+    parallel_for(scheduler, 0, num_items, 1, run_alloc_free_range, thread_data);
+
+    sched_destroy(scheduler);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
 /*
  * This function is used to test the resizing of memory blocks in a multithreading context.
  * Each thread will allocate a block of memory, resize it, and then free it.
@@ -373,6 +438,985 @@ void test_resize_multithread(TestParams params)
     }
 }
 
+/*
+ * This function tests that mem_resize grows a block in place when the neighbouring block is free,
+ * and relocates it (preserving the contents) when the neighbour is in use.
+ */
+void test_resize_in_place()
+{
+    printf_yellow("  Testing \"mem_resize\" in place growth ---> ");
+    mem_init(4096);
+
+    char *block = mem_alloc(100);
+    my_assert(block != NULL);
+    memset(block, 0x5A, 100);
+
+    // The rest of the pool is free, so the block can grow without moving
+    char *grown = mem_resize(block, 1000);
+    my_assert(grown == block);
+    sanityCheck(100, grown, 0x5A);
+
+    // Occupy the neighbour, the next growth has to relocate
+    void *neighbour = mem_alloc(100);
+    my_assert(neighbour != NULL);
+    char *moved = mem_resize(grown, 2000);
+    my_assert(moved != NULL && moved != grown);
+    sanityCheck(100, moved, 0x5A);
+
+    mem_free(neighbour);
+    mem_free(moved);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+/*
+ * This function tests that the free block index keeps first-fit placement: with holes of varying sizes
+ * the lowest hole that fits is used, and after random churn everything coalesces back into one block.
+ */
+void test_first_fit_index()
+{
+    printf_yellow("  Testing \"mem_alloc\" first fit over the free block index ---> ");
+    size_t pool = 64 * 1024;
+    mem_init(pool);
+
+    // 48 blocks of 32..256 bytes, the even ones are freed to leave holes separated by used blocks
+    char *blocks[48];
+    for (int i = 0; i < 48; i++)
+    {
+        blocks[i] = mem_alloc(32 * (1 + i % 8));
+        my_assert(blocks[i] != NULL);
+    }
+    for (int i = 0; i < 48; i += 2)
+        mem_free(blocks[i]);
+
+    // The largest even hole is 224 bytes (i % 8 == 6), so 200 bytes lands in holes 6, 14, 22, ...
+    my_assert(mem_alloc(200) == blocks[6]);
+    my_assert(mem_alloc(200) == blocks[14]);
+    my_assert(mem_alloc(100) == blocks[4]);
+    my_assert(mem_alloc(32) == blocks[0]);
+
+    // Nothing in the holes fits, the block comes from the free space after the last used block
+    char *tail = mem_alloc(300);
+    my_assert(tail > blocks[47]);
+
+    // Random churn, then release everything and check that the whole pool is one free block again
+    void *churn[256] = {NULL};
+    for (int i = 0; i < 4096; i++)
+    {
+        int slot = rand() % 256;
+        if (churn[slot] && rand() % 3 == 0)
+            churn[slot] = mem_resize(churn[slot], 1 + rand() % 256);
+        else if (churn[slot])
+        {
+            mem_free(churn[slot]);
+            churn[slot] = NULL;
+        }
+        else
+            churn[slot] = mem_alloc(1 + rand() % 128);
+    }
+    for (int i = 0; i < 256; i++)
+        mem_free(churn[i]);
+    for (int i = 1; i < 48; i += 2)
+        mem_free(blocks[i]);
+    mem_free(blocks[0]);
+    mem_free(blocks[4]);
+    mem_free(blocks[6]);
+    mem_free(blocks[14]);
+    mem_free(tail);
+
+    char *whole = mem_alloc(pool);
+    my_assert(whole == blocks[0]);
+    my_assert(mem_alloc(1) == NULL);
+    mem_free(whole);
+
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+/*
+ * This function tests the lock-free allocator summary. A polling thread reads mem_stats while the workers
+ * allocate and free, and every snapshot it sees has to be internally consistent.
+ */
+typedef struct
+{
+    size_t pool_size;
+    atomic_int stop;
+    long snapshots;
+} stats_poller_t;
+
+void *thread_poll_stats(void *arg)
+{
+    stats_poller_t *poller = (stats_poller_t *)arg;
+    do
+    {
+        MemStats stats;
+        mem_stats(&stats);
+        my_assert(stats.bytes_used <= poller->pool_size);
+        my_assert(stats.largest_free <= poller->pool_size - stats.bytes_used);
+        my_assert((stats.free_blocks == 0) == (stats.largest_free == 0));
+        poller->snapshots++;
+    } while (!atomic_load(&poller->stop));
+    return NULL;
+}
+
+void test_mem_stats(TestParams params)
+{
+    printf_yellow("  Testing \"mem_stats\" lock-free snapshots (threads: %d) ---> ", params.num_threads);
+    srand(time(NULL));
+    mem_init(4096);
+
+    MemStats stats;
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0 && stats.free_blocks == 1 && stats.largest_free == 4096);
+
+    void *a = mem_alloc(100);
+    void *b = mem_alloc(200);
+    mem_free(a);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 200 && stats.free_blocks == 2 && stats.largest_free == 4096 - 300);
+
+    b = mem_resize(b, 1000);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 1000 && stats.largest_free == 4096 - 1100);
+    mem_free(b);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0 && stats.free_blocks == 1 && stats.largest_free == 4096);
+    mem_deinit();
+
+    // Random blocks on a larger pool with a poller reading concurrently
+    int total_blocks = 1024;
+    size_t block_size = 256;
+    mem_init(total_blocks * block_size);
+
+    stats_poller_t poller = {.pool_size = total_blocks * block_size};
+    pthread_t poll_thread;
+    my_assert(pthread_create(&poll_thread, NULL, thread_poll_stats, &poller) == 0);
+
+    pthread_t threads[params.num_threads];
+    thread_data_t thread_data[params.num_threads];
+    void *block_pointers[total_blocks];
+    for (int i = 0; i < params.num_threads; i++)
+    {
+        thread_data[i].num_blocks = total_blocks / params.num_threads;
+        thread_data[i].max_block_size = block_size;
+        thread_data[i].block_pointers = &block_pointers[i * thread_data[i].num_blocks];
+        pthread_create(&threads[i], NULL, thread_alloc_free, &thread_data[i]);
+    }
+    for (int i = 0; i < params.num_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    atomic_store(&poller.stop, 1);
+    pthread_join(poll_thread, NULL);
+    my_assert(poller.snapshots > 0);
+
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0 && stats.largest_free == poller.pool_size);
+
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+/*
+ * This function tests a pool split into address ranges with separate locks. Random blocks are allocated
+ * from many threads, and allocations larger than one range have to span range boundaries.
+ */
+void test_range_striping(TestParams params)
+{
+    printf_yellow("  Testing \"mem_init_opts\" address range striping (threads: %d) ---> ", params.num_threads);
+    srand(time(NULL));
+    size_t range = 256 * 1024;
+    size_t pool = 4 * range;
+    mem_init_opts(pool, &(MemOptions){.num_ranges = 4});
+
+    // The whole pool is one allocation across all four ranges
+    char *whole = mem_alloc(pool);
+    my_assert(whole != NULL);
+    memset(whole, 0x3C, pool);
+    my_assert(mem_alloc(1) == NULL);
+    MemStats stats;
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == pool && stats.free_blocks == 0);
+    mem_free(whole);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0 && stats.free_blocks == 4 && stats.largest_free == range);
+
+    // One block per range, the free tails are not contiguous so a larger block has nowhere to go
+    void *blocks[4];
+    for (int i = 0; i < 4; i++)
+    {
+        blocks[i] = mem_alloc(200 * 1024);
+        my_assert(blocks[i] != NULL);
+    }
+    my_assert(mem_alloc(100 * 1024) == NULL);
+    for (int i = 0; i < 4; i++)
+        mem_free(blocks[i]);
+
+    // Spanning blocks keep their contents when they grow and relocate
+    char *span = mem_alloc(300 * 1024);
+    my_assert(span != NULL);
+    memset(span, 0x6E, 300 * 1024);
+    char *grown = mem_resize(span, 600 * 1024);
+    my_assert(grown != NULL);
+    sanityCheck(300 * 1024, grown, 0x6E);
+    my_assert(mem_resize(grown, 100) == grown);
+    mem_free(grown);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0 && stats.free_blocks == 4);
+
+    // Concurrent random blocks, each thread starts in its own range and steals when it runs out
+    pthread_t threads[params.num_threads];
+    thread_data_t thread_data[params.num_threads];
+    int total_blocks = 2048;
+    void *block_pointers[total_blocks];
+    for (int i = 0; i < params.num_threads; i++)
+    {
+        thread_data[i].num_blocks = total_blocks / params.num_threads;
+        thread_data[i].max_block_size = pool / total_blocks;
+        thread_data[i].block_pointers = &block_pointers[i * thread_data[i].num_blocks];
+        pthread_create(&threads[i], NULL, thread_alloc_free, &thread_data[i]);
+    }
+    for (int i = 0; i < params.num_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    // Everything coalesced back within each range
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0 && stats.free_blocks == 4);
+    my_assert(mem_alloc(pool) != NULL);
+
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+/*
+ * These functions test the page-local sharded mode. Threads in a ring free each other's small blocks,
+ * so every page gets both local and cross-thread frees, and pages are handed back or adopted when threads exit.
+ */
+typedef struct
+{
+    int thread_id;
+    int num_threads;
+    int num_blocks;
+    char **blocks; // num_blocks per thread, thread i owns blocks[i * num_blocks ...]
+} paged_ring_t;
+
+void *thread_paged_ring(void *arg)
+{
+    paged_ring_t *data = (paged_ring_t *)arg;
+    char **own = &data->blocks[data->thread_id * data->num_blocks];
+    char **neighbour = &data->blocks[((data->thread_id + 1) % data->num_threads) * data->num_blocks];
+
+    for (int round = 0; round < 2; round++)
+    {
+        for (int i = 0; i < data->num_blocks; i++)
+        {
+            size_t size = 1 + (i * 37) % 1024;
+            own[i] = mem_alloc(size);
+            my_assert(own[i] != NULL);
+            memset(own[i], data->thread_id, size);
+        }
+        my_barrier_wait(&barrier);
+
+        // Round 0 frees the neighbour's blocks (remote frees), round 1 its own (local frees)
+        char **victims = round == 0 ? neighbour : own;
+        int victim_id = round == 0 ? (data->thread_id + 1) % data->num_threads : data->thread_id;
+        for (int i = 0; i < data->num_blocks; i++)
+        {
+            sanityCheck(1 + (i * 37) % 1024, victims[i], (char)victim_id);
+            mem_free(victims[i]);
+        }
+        my_barrier_wait(&barrier);
+    }
+    return NULL;
+}
+
+// Allocates small blocks and exits without freeing them, the main thread frees them afterwards
+void *thread_paged_leave(void *arg)
+{
+    char **blocks = (char **)arg;
+    for (int i = 0; i < 256; i++)
+    {
+        blocks[i] = mem_alloc(48);
+        my_assert(blocks[i] != NULL);
+    }
+    return NULL;
+}
+
+// Allocates from its heap, then outlives the pool it allocated from
+void *thread_paged_outlive(void *arg)
+{
+    (void)arg;
+    my_assert(mem_alloc(48) != NULL);
+    my_barrier_wait(&barrier);
+    my_barrier_wait(&barrier); // The main thread calls mem_deinit in between
+    return NULL;
+}
+
+void test_paged_mode(TestParams params)
+{
+    printf_yellow("  Testing \"mem_init_opts\" paged mode (threads: %d) ---> ", params.num_threads);
+    // Each thread can hold one 64 KiB page per size class
+    mem_init_opts((4 + 2 * params.num_threads) * 1024 * 1024, &(MemOptions){.paged = 1});
+
+    // Blocks of one size class come out of the page in address order
+    char *a = mem_alloc(24);
+    char *b = mem_alloc(24);
+    my_assert(a != NULL && b == a + 32);
+
+    // Every small size, zero included, gets its own block
+    char *small[1025];
+    for (int i = 0; i <= 1024; i++)
+    {
+        small[i] = mem_alloc(i);
+        my_assert(small[i] != NULL);
+        memset(small[i], i & 0x7F, i);
+    }
+    for (int i = 0; i <= 1024; i++)
+    {
+        sanityCheck(i, small[i], i & 0x7F);
+        mem_free(small[i]);
+    }
+
+    // Resizing within the size class keeps the block, larger sizes move it to the block allocator
+    my_assert(mem_resize(a, 30) == a);
+    memset(a, 0x42, 30);
+    char *large = mem_resize(a, 4000);
+    my_assert(large != NULL && large != a);
+    sanityCheck(30, large, 0x42);
+    mem_free(large);
+    mem_free(b);
+
+    MemStats before;
+    mem_stats(&before);
+
+    // Ring of threads freeing each other's blocks, all their pages are handed back when they exit
+    pthread_t threads[params.num_threads];
+    paged_ring_t ring[params.num_threads];
+    int num_blocks = 512;
+    char **blocks = malloc(params.num_threads * num_blocks * sizeof(char *));
+    my_barrier_init(&barrier, params.num_threads);
+    for (int i = 0; i < params.num_threads; i++)
+    {
+        ring[i] = (paged_ring_t){.thread_id = i, .num_threads = params.num_threads, .num_blocks = num_blocks, .blocks = blocks};
+        my_assert(pthread_create(&threads[i], NULL, thread_paged_ring, &ring[i]) == 0);
+    }
+    for (int i = 0; i < params.num_threads; i++)
+        pthread_join(threads[i], NULL);
+    my_barrier_destroy(&barrier);
+    free(blocks);
+
+    MemStats after;
+    mem_stats(&after);
+    my_assert(after.bytes_used == before.bytes_used);
+
+    // A thread exits with live blocks, its page is abandoned and adopted by the next thread of that size class
+    char *left[256];
+    pthread_t thread;
+    pthread_create(&thread, NULL, thread_paged_leave, left);
+    pthread_join(thread, NULL);
+    for (int i = 0; i < 256; i++)
+        mem_free(left[i]);
+    char *adopted[256];
+    pthread_create(&thread, NULL, thread_paged_leave, adopted);
+    pthread_join(thread, NULL);
+    my_assert(adopted[0] >= left[0] - 64 * 1024 && adopted[0] < left[0] + 64 * 1024);
+    for (int i = 0; i < 256; i++)
+        mem_free(adopted[i]);
+
+    mem_deinit();
+
+    // A new pool gives the thread a new heap, and the default mode is unchanged afterwards
+    mem_init_opts(1024 * 1024, &(MemOptions){.paged = 1});
+    a = mem_alloc(100);
+    my_assert(a != NULL);
+    mem_free(a);
+
+    // A thread that exits after mem_deinit leaves its stale heap alone
+    my_barrier_init(&barrier, 2);
+    pthread_create(&thread, NULL, thread_paged_outlive, NULL);
+    my_barrier_wait(&barrier);
+    mem_deinit();
+    my_barrier_wait(&barrier);
+    pthread_join(thread, NULL);
+    my_barrier_destroy(&barrier);
+
+    mem_init(1024);
+    a = mem_alloc(100);
+    my_assert(a != NULL && mem_alloc(0) != NULL);
+    mem_free(a);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+/*
+ * This function tests that relocating resizes of large blocks copy every byte, also when the blocks
+ * start at unaligned addresses and the size is not a multiple of the copy width.
+ */
+void test_resize_large_copy()
+{
+    printf_yellow("  Testing \"mem_resize\" relocating large blocks ---> ");
+    mem_init(16 * 1024 * 1024);
+
+    size_t sizes[] = {1000, 256 * 1024, 1024 * 1024 + 13, 3 * 1024 * 1024 + 7};
+    for (int i = 0; i < 4; i++)
+    {
+        unsigned char *skew = mem_alloc(3); // Pushes the next block off any alignment
+        unsigned char *block = mem_alloc(sizes[i]);
+        my_assert(block != NULL);
+        for (size_t j = 0; j < sizes[i]; j++)
+            block[j] = (unsigned char)(j * 31 + i);
+
+        void *neighbour = mem_alloc(1); // Forces the growth to relocate
+        unsigned char *moved = mem_resize(block, sizes[i] * 2 + 5);
+        my_assert(moved != NULL && moved != block);
+        for (size_t j = 0; j < sizes[i]; j++)
+            my_assert(moved[j] == (unsigned char)(j * 31 + i));
+
+        mem_free(moved);
+        mem_free(neighbour);
+        mem_free(skew);
+    }
+
+    MemStats stats;
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+/*
+ * This function tests prefaulting. After a prefaulting mem_init, writing the whole pool should take almost
+ * no page faults, and mem_prefault must never change the contents of memory that is already in use.
+ */
+long minor_faults()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+void test_prefault()
+{
+    printf_yellow("  Testing \"mem_prefault\" and prefaulting mem_init ---> ");
+    size_t pool = 32 * 1024 * 1024;
+    mem_init_opts(pool, &(MemOptions){.num_ranges = 4, .prefault = 1});
+
+    char *block = mem_alloc(pool);
+    my_assert(block != NULL);
+    long before = minor_faults();
+    memset(block, 0x11, pool);
+    my_assert(minor_faults() - before < (long)(pool / 4096) / 8);
+
+    my_assert(mem_prefault(NULL, 0) == 0);
+    my_assert(mem_prefault(block + 4096 + 17, 1000000) == 0);
+    my_assert(mem_prefault(block + pool - 10, 100) == -1);
+    for (size_t i = 0; i < pool; i += 4093)
+        my_assert(block[i] == 0x11);
+
+    mem_free(block);
+    mem_deinit();
+    my_assert(mem_prefault(NULL, 0) == -1);
+
+    // In paged mode the pool starts out with empty pages ready for every size class
+    mem_init_opts(pool, &(MemOptions){.paged = 1, .prefault = 1});
+    MemStats stats;
+    mem_stats(&stats);
+    my_assert(stats.bytes_used >= 20 * 64 * 1024);
+    void *small = mem_alloc(64);
+    my_assert(small != NULL);
+    mem_free(small);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+/*
+ * This function tests mem_checkpoint and mem_restore. The pool is changed after the checkpoint, and the restore
+ * has to bring back the same blocks with the same contents, including a block that spans two ranges.
+ */
+void test_checkpoint_restore()
+{
+    printf_yellow("  Testing \"mem_checkpoint\" and mem_restore ---> ");
+    char path[] = "/tmp/mem_checkpoint_XXXXXX";
+    int fd = mkstemp(path);
+    my_assert(fd >= 0);
+    close(fd);
+
+    size_t pool = 1024 * 1024;
+    mem_init_opts(pool, &(MemOptions){.num_ranges = 2});
+    char *blocks[8];
+    for (int i = 0; i < 8; i++)
+    {
+        blocks[i] = mem_alloc(1000 * (i + 1));
+        my_assert(blocks[i] != NULL);
+        memset(blocks[i], 'a' + i, 1000 * (i + 1));
+    }
+    mem_free(blocks[2]);
+    mem_free(blocks[5]);
+    char *span = mem_alloc(700 * 1024); // Larger than one range
+    my_assert(span != NULL);
+    memset(span, 'z', 700 * 1024);
+
+    MemStats saved;
+    mem_stats(&saved);
+    my_assert(mem_checkpoint(path) == 0);
+
+    // Change everything, then roll back
+    for (int i = 0; i < 8; i++)
+        if (i != 2 && i != 5)
+            mem_free(blocks[i]);
+    mem_free(span);
+    char *other = mem_alloc(pool / 4);
+    memset(other, 0, pool / 4);
+
+    my_assert(mem_restore(path) == 0);
+    MemStats restored;
+    mem_stats(&restored);
+    my_assert(restored.bytes_used == saved.bytes_used && restored.free_blocks == saved.free_blocks &&
+              restored.largest_free == saved.largest_free);
+    for (int i = 0; i < 8; i++)
+        if (i != 2 && i != 5)
+            sanityCheck(1000 * (i + 1), blocks[i], 'a' + i);
+    sanityCheck(700 * 1024, span, 'z');
+
+    // The restored blocks are real blocks, freeing them all gives back the whole pool
+    for (int i = 0; i < 8; i++)
+        if (i != 2 && i != 5)
+            mem_free(blocks[i]);
+    mem_free(span);
+    mem_stats(&restored);
+    my_assert(restored.bytes_used == 0);
+    my_assert(mem_alloc(pool) != NULL);
+    mem_deinit();
+
+    // A pool with another layout or in paged mode is rejected and left as it was
+    mem_init(pool / 2);
+    void *kept = mem_alloc(100);
+    my_assert(mem_restore(path) == -1);
+    my_assert(mem_alloc(pool / 2 - 100) != NULL);
+    mem_free(kept);
+    mem_deinit();
+    mem_init_opts(pool, &(MemOptions){.paged = 1});
+    my_assert(mem_checkpoint(path) == -1 && mem_restore(path) == -1);
+    mem_deinit();
+
+    // A record whose span does not match the blocks after it is rejected
+    fd = open(path, O_RDWR);
+    my_assert(fd >= 0);
+    off_t span_at = -1;
+    uint64_t word;
+    for (off_t at = 0; span_at < 0 && pread(fd, &word, sizeof(word), at) == sizeof(word); at += sizeof(word))
+        if (word == 700 * 1024)
+            span_at = at;
+    my_assert(span_at >= 0);
+    uint64_t corrupt[] = {700 * 1024 + 4096, 4 * pool, 1};
+    mem_init_opts(pool, &(MemOptions){.num_ranges = 2});
+    for (int i = 0; i < 3; i++)
+    {
+        my_assert(pwrite(fd, &corrupt[i], sizeof(word), span_at) == sizeof(word));
+        my_assert(mem_restore(path) == -1);
+    }
+    word = 700 * 1024;
+    my_assert(pwrite(fd, &word, sizeof(word), span_at) == sizeof(word));
+    close(fd);
+    my_assert(mem_restore(path) == 0 && mem_size(span) == 700 * 1024);
+    mem_deinit();
+
+    // A truncated file is rejected
+    my_assert(truncate(path, 100) == 0);
+    mem_init_opts(pool, &(MemOptions){.num_ranges = 2});
+    my_assert(mem_restore(path) == -1);
+    mem_deinit();
+
+    unlink(path);
+    printf_green("[PASS].\n");
+}
+
+typedef struct
+{
+    int tag;
+    int count;
+} tagged_thread_t;
+
+// Allocates count tagged blocks of 100 bytes and frees every other one before the thread exits
+void *thread_tagged_alloc(void *arg)
+{
+    tagged_thread_t *data = (tagged_thread_t *)arg;
+    void *blocks[data->count];
+    for (int i = 0; i < data->count; i++)
+    {
+        blocks[i] = mem_alloc_tagged(100, data->tag);
+        my_assert(blocks[i] != NULL);
+    }
+    for (int i = 0; i < data->count; i += 2)
+        mem_free(blocks[i]);
+    return NULL;
+}
+
+// Holds a tagged block while the main thread calls mem_deinit, then exits
+void *thread_tagged_outlive(void *arg)
+{
+    (void)arg;
+    my_assert(mem_alloc_tagged(64, 1) != NULL);
+    my_barrier_wait(&barrier);
+    my_barrier_wait(&barrier);
+    return NULL;
+}
+
+void *thread_tagged_free(void *arg)
+{
+    mem_free(arg);
+    return NULL;
+}
+
+/*
+ * This function tests mem_alloc_tagged and mem_tag_stats. The per-tag totals have to follow allocations, frees
+ * and resizes, survive the exit of the threads that made them, and come back with a checkpoint restore.
+ */
+void test_tagged_allocations(TestParams params)
+{
+    printf_yellow("  Testing \"mem_alloc_tagged\" and mem_tag_stats (threads: %d) ---> ", params.num_threads);
+    MemTagStats stats;
+    mem_init_opts(1024 * 1024, &(MemOptions){.num_ranges = 2});
+
+    my_assert(mem_tag_stats(0, &stats) == -1 && mem_tag_stats(MEM_MAX_TAGS, &stats) == -1);
+    my_assert(mem_alloc_tagged(100, MEM_MAX_TAGS) == NULL && mem_alloc_tagged(100, -1) == NULL);
+
+    void *first[10];
+    void *second[5];
+    for (int i = 0; i < 10; i++)
+        first[i] = mem_alloc_tagged(100, 1);
+    for (int i = 0; i < 5; i++)
+        second[i] = mem_alloc_tagged(1000, 2);
+    void *untagged = mem_alloc(500);
+    my_assert(mem_tag_stats(1, &stats) == 0 && stats.bytes == 1000 && stats.count == 10);
+    my_assert(mem_tag_stats(2, &stats) == 0 && stats.bytes == 5000 && stats.count == 5);
+    my_assert(mem_tag_stats(3, &stats) == 0 && stats.bytes == 0 && stats.count == 0);
+
+    // Shrinking in place and moving to a bigger block keep the tag
+    second[0] = mem_resize(second[0], 400);
+    my_assert(mem_tag_stats(2, &stats) == 0 && stats.bytes == 4400 && stats.count == 5);
+    second[1] = mem_resize(second[1], 3000);
+    my_assert(second[1] != NULL);
+    my_assert(mem_tag_stats(2, &stats) == 0 && stats.bytes == 6400 && stats.count == 5);
+
+    // A block that spans both ranges counts with its full size
+    void *span = mem_alloc_tagged(700 * 1024, 3);
+    my_assert(span != NULL);
+    my_assert(mem_tag_stats(3, &stats) == 0 && stats.bytes == 700 * 1024 && stats.count == 1);
+    mem_free(span);
+    mem_free(span); // A double free must not count twice
+    my_assert(mem_tag_stats(3, &stats) == 0 && stats.bytes == 0 && stats.count == 0);
+
+    // Counters of exited threads are folded into the totals
+    pthread_t threads[params.num_threads];
+    tagged_thread_t data[params.num_threads];
+    for (int i = 0; i < params.num_threads; i++)
+    {
+        data[i] = (tagged_thread_t){.tag = 4 + i % 2, .count = 20};
+        pthread_create(&threads[i], NULL, thread_tagged_alloc, &data[i]);
+    }
+    for (int i = 0; i < params.num_threads; i++)
+        pthread_join(threads[i], NULL);
+    long long expected[2] = {0, 0};
+    for (int i = 0; i < params.num_threads; i++)
+        expected[i % 2] += 10;
+    my_assert(mem_tag_stats(4, &stats) == 0 && stats.count == expected[0] && stats.bytes == expected[0] * 100);
+    my_assert(mem_tag_stats(5, &stats) == 0 && stats.count == expected[1] && stats.bytes == expected[1] * 100);
+
+    // Blocks freed by another thread are taken off the tag as well
+    for (int i = 0; i < 5; i++)
+    {
+        pthread_create(&threads[0], NULL, thread_tagged_free, first[i]);
+        pthread_join(threads[0], NULL);
+    }
+    my_assert(mem_tag_stats(1, &stats) == 0 && stats.bytes == 500 && stats.count == 5);
+
+    // A restore brings back the totals of the checkpoint
+    char path[] = "/tmp/mem_tagged_XXXXXX";
+    int fd = mkstemp(path);
+    my_assert(fd >= 0);
+    close(fd);
+    my_assert(mem_checkpoint(path) == 0);
+    for (int i = 5; i < 10; i++)
+        mem_free(first[i]);
+    my_assert(mem_tag_stats(1, &stats) == 0 && stats.bytes == 0 && stats.count == 0);
+    my_assert(mem_restore(path) == 0);
+    my_assert(mem_tag_stats(1, &stats) == 0 && stats.bytes == 500 && stats.count == 5);
+    my_assert(mem_tag_stats(2, &stats) == 0 && stats.bytes == 6400 && stats.count == 5);
+    unlink(path);
+
+    mem_free(untagged);
+
+    // A thread that exits after mem_deinit does not touch the freed heaps
+    my_barrier_init(&barrier, 2);
+    pthread_create(&threads[0], NULL, thread_tagged_outlive, NULL);
+    my_barrier_wait(&barrier);
+    mem_deinit();
+    my_barrier_wait(&barrier);
+    pthread_join(threads[0], NULL);
+    my_barrier_destroy(&barrier);
+
+    // A new pool starts from zero, and in paged mode tagged blocks bypass the pages
+    mem_init_opts(1024 * 1024, &(MemOptions){.paged = 1});
+    my_assert(mem_tag_stats(1, &stats) == 0 && stats.bytes == 0 && stats.count == 0);
+    void *small = mem_alloc_tagged(16, 1);
+    my_assert(mem_tag_stats(1, &stats) == 0 && stats.bytes == 16 && stats.count == 1);
+    mem_free(small);
+    my_assert(mem_tag_stats(1, &stats) == 0 && stats.bytes == 0 && stats.count == 0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+typedef struct
+{
+    int count;
+    size_t size;
+} sampled_thread_t;
+
+// Allocates and frees count blocks of the given size one at a time
+void *thread_sampled_alloc(void *arg)
+{
+    sampled_thread_t *data = (sampled_thread_t *)arg;
+    for (int i = 0; i < data->count; i++)
+    {
+        void *block = mem_alloc(data->size);
+        my_assert(block != NULL);
+        mem_free(block);
+    }
+    return NULL;
+}
+
+/*
+ * This function tests the sampled size histogram. With a sample rate of 1 every allocation and free is counted,
+ * with a higher rate each thread samples exactly every sample_rate:th allocation. Sampled small allocations in paged
+ * mode are taken as regular blocks so that their frees can be matched.
+ */
+void test_size_histogram(TestParams params)
+{
+    printf_yellow("  Testing \"mem_size_histogram\" sampling (threads: %d) ---> ", params.num_threads);
+    MemHistogram histogram;
+
+    mem_init_opts(1024 * 1024, &(MemOptions){.sample_rate = 1});
+    void *small[10];
+    void *large[5];
+    for (int i = 0; i < 10; i++)
+        small[i] = mem_alloc(100); // Bucket 7 holds (64, 128]
+    for (int i = 0; i < 5; i++)
+        large[i] = mem_alloc(1024); // Bucket 10 holds (512, 1024]
+    for (int i = 0; i < 3; i++)
+        mem_free(small[i]);
+    mem_free(small[0]); // A double free is not counted
+    mem_size_histogram(&histogram);
+    my_assert(histogram.sample_rate == 1);
+    my_assert(histogram.buckets[7].allocs == 10 && histogram.buckets[7].bytes == 1000 && histogram.buckets[7].frees == 3);
+    my_assert(histogram.buckets[10].allocs == 5 && histogram.buckets[10].bytes == 5120 && histogram.buckets[10].frees == 0);
+    my_assert(histogram.buckets[7].lifetime_ns > 0 && histogram.buckets[10].lifetime_ns == 0);
+    size_t total = 0;
+    for (int i = 0; i < MEM_HISTOGRAM_BUCKETS; i++)
+        total += histogram.buckets[i].allocs;
+    my_assert(total == 15);
+    for (int i = 3; i < 10; i++)
+        mem_free(small[i]);
+    for (int i = 0; i < 5; i++)
+        mem_free(large[i]);
+    mem_deinit();
+
+    // Each thread samples its first allocation and then every fourth
+    mem_init_opts(4 * 1024 * 1024, &(MemOptions){.num_ranges = 4, .paged = 1, .sample_rate = 4});
+    pthread_t threads[params.num_threads];
+    sampled_thread_t data = {.count = 400, .size = 48};
+    for (int i = 0; i < params.num_threads; i++)
+        pthread_create(&threads[i], NULL, thread_sampled_alloc, &data);
+    for (int i = 0; i < params.num_threads; i++)
+        pthread_join(threads[i], NULL);
+    mem_size_histogram(&histogram);
+    my_assert(histogram.sample_rate == 4);
+    my_assert(histogram.buckets[6].allocs == (size_t)params.num_threads * 100);
+    my_assert(histogram.buckets[6].frees == (size_t)params.num_threads * 100);
+    my_assert(histogram.buckets[6].bytes == (size_t)params.num_threads * 100 * 48);
+    MemStats stats;
+    mem_stats(&stats);
+    my_assert(stats.bytes_used % (64 * 1024) == 0); // Only empty small-object pages may remain
+    mem_deinit();
+
+    // Without a sample rate nothing is recorded
+    mem_init(1024 * 1024);
+    void *block = mem_alloc(100);
+    mem_free(block);
+    mem_size_histogram(&histogram);
+    my_assert(histogram.sample_rate == 0 && histogram.buckets[7].allocs == 0 && histogram.buckets[7].frees == 0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+/*
+ * This function tests the page map behind mem_free, mem_resize and mem_size. Many small blocks share each page,
+ * so lookups have to step over their neighbours, and pointers that are not the start of a block are rejected.
+ */
+void test_page_map()
+{
+    printf_yellow("  Testing \"mem_size\" and page map lookups ---> ");
+    size_t pool = 1000 * 1000; // Not a multiple of the map page size
+    mem_init_opts(pool, &(MemOptions){.num_ranges = 3});
+    MemStats stats;
+
+    int count = 20000;
+    char **blocks = malloc(count * sizeof(char *));
+    for (int i = 0; i < count; i++)
+    {
+        blocks[i] = mem_alloc(10 + i % 7);
+        my_assert(blocks[i] != NULL);
+        my_assert(mem_size(blocks[i]) == (size_t)(10 + i % 7));
+    }
+
+    // Foreign, interior and freed pointers
+    int local;
+    my_assert(mem_size(NULL) == 0 && mem_size(&local) == 0 && mem_size(blocks[5] + 1) == 0);
+    mem_stats(&stats);
+    size_t used = stats.bytes_used;
+    mem_free(blocks[5] + 1);
+    mem_free(&local);
+    my_assert(mem_resize(blocks[5] + 1, 100) == NULL);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == used);
+
+    // Free from the end, then every other block from the front, then the rest
+    for (int i = count - 1; i >= count / 2; i--)
+        mem_free(blocks[i]);
+    for (int i = 0; i < count / 2; i += 2)
+    {
+        mem_free(blocks[i]);
+        my_assert(mem_size(blocks[i]) == 0);
+    }
+
+    // In-place resizes move the start of the free neighbour
+    blocks[1] = mem_resize(blocks[1], 5);
+    my_assert(mem_size(blocks[1]) == 5);
+    blocks[1] = mem_resize(blocks[1], 10 + 10 + 11); // Grows into the freed blocks[2]
+    my_assert(mem_size(blocks[1]) == 31);
+    for (int i = 1; i < count / 2; i += 2)
+        mem_free(blocks[i]);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0 && stats.free_blocks == 3);
+
+    // A block spanning two ranges reports its full size
+    char *span = mem_alloc(pool / 2);
+    my_assert(span != NULL && mem_size(span) == pool / 2);
+    mem_free(span);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0);
+    free(blocks);
+    mem_deinit();
+
+    // Paged mode reports the size class for live blocks, and 0 for free slots and blocks freed by any thread
+    mem_init_opts(pool, &(MemOptions){.paged = 1});
+    char *small = mem_alloc(20);
+    my_assert(mem_size(small) == 32 && mem_size(small + 16) == 0 && mem_size(small + 32) == 0);
+    char *large = mem_alloc(5000);
+    my_assert(mem_size(large) == 5000);
+    mem_free(small);
+    my_assert(mem_size(small) == 0);
+    char *remote = mem_alloc(20);
+    my_assert(mem_size(remote) == 32);
+    pthread_t thread;
+    pthread_create(&thread, NULL, thread_tagged_free, remote);
+    pthread_join(thread, NULL);
+    my_assert(mem_size(remote) == 0);
+    mem_free(large);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// Keeps up to 16 live blocks of random sizes around the page size and checks their contents before freeing them
+void *thread_page_bitmap(void *arg)
+{
+    unsigned int seed = (unsigned int)(size_t)arg;
+    char value = 'A' + (char)((size_t)arg % 26);
+    char *blocks[16] = {NULL};
+    size_t sizes[16] = {0};
+    for (int i = 0; i < 2000; i++)
+    {
+        int slot = rand_r(&seed) % 16;
+        if (blocks[slot])
+        {
+            sanityCheck(sizes[slot], blocks[slot], value);
+            mem_free(blocks[slot]);
+        }
+        sizes[slot] = 1 + rand_r(&seed) % (64 * 1024);
+        blocks[slot] = mem_alloc(sizes[slot]);
+        my_assert(blocks[slot] != NULL);
+        if (sizes[slot] >= 4096)
+            my_assert(((size_t)blocks[slot] & 4095) == 0 && mem_size(blocks[slot]) == ((sizes[slot] + 4095) & ~(size_t)4095));
+        memset(blocks[slot], value, sizes[slot]);
+    }
+    for (int slot = 0; slot < 16; slot++)
+    {
+        sanityCheck(sizes[slot], blocks[slot], value);
+        mem_free(blocks[slot]);
+    }
+    return NULL;
+}
+
+/*
+ * This function tests the page bitmap. Allocations of a page or more are rounded up to whole pages and start on a
+ * page boundary, a freed run of pages that crosses bitmap words is found again, and threads that mix page and
+ * small allocations leave the pool completely free.
+ */
+void test_page_bitmap(TestParams params)
+{
+    printf_yellow("  Testing \"mem_alloc\" with the page bitmap (threads: %d) ---> ", params.num_threads);
+    size_t page = 4096;
+    MemStats stats;
+    mem_init_opts(4 * 1024 * 1024, &(MemOptions){.page_bitmap = 1});
+
+    char *first = mem_alloc(5000);
+    my_assert(((size_t)first & (page - 1)) == 0 && mem_size(first) == 2 * page);
+    char *small = mem_alloc(100);
+    my_assert(small == first + 2 * page && mem_size(small) == 100);
+    char *odd = mem_alloc(page - 1); // Below one page - no rounding
+    my_assert(mem_size(odd) == page - 1);
+    char *next = mem_alloc(page); // The page holding small and odd is not free
+    my_assert(((size_t)next & (page - 1)) == 0 && next >= odd + page - 1);
+
+    char *pages[200];
+    for (int i = 0; i < 200; i++)
+    {
+        pages[i] = mem_alloc(page);
+        my_assert(pages[i] == next + (i + 1) * page);
+    }
+    for (int i = 60; i < 140; i++)
+        mem_free(pages[i]);
+    char *run = mem_alloc(80 * page);
+    my_assert(run == pages[60]);
+    mem_free(run);
+    char *shorter = mem_alloc(3 * page);
+    my_assert(shorter == pages[60]);
+
+    // Freeing the small blocks joins their page with the neighbours again
+    mem_free(shorter);
+    for (int i = 0; i < 200; i++)
+        if (i < 60 || i >= 140)
+            mem_free(pages[i]);
+    mem_free(small);
+    mem_free(odd);
+    mem_free(next);
+    mem_free(first);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0 && stats.free_blocks == 1);
+    my_assert(mem_alloc(4 * 1024 * 1024) != NULL);
+    mem_deinit();
+
+    mem_init_opts(16 * 1024 * 1024, &(MemOptions){.num_ranges = 4, .page_bitmap = 1});
+    pthread_t threads[params.num_threads];
+    for (int i = 0; i < params.num_threads; i++)
+        pthread_create(&threads[i], NULL, thread_page_bitmap, (void *)(size_t)(i + 1));
+    for (int i = 0; i < params.num_threads; i++)
+        pthread_join(threads[i], NULL);
+    mem_stats(&stats);
+    my_assert(stats.bytes_used == 0 && stats.free_blocks == 4);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
 void *alloc_exceeding_memory(void *arg)
 {
     size_t size_to_allocate = (size_t)arg;
@@ -923,8 +1967,18 @@ int main(int argc, char *argv[])
         printf("\n*** Testing various functions with a base number of threads: ***\n");
         run_concurrent_test(test_alloc_and_free, (TestParams){.num_threads = base_num_threads, .memory_size = 1024}, "mem_alloc and mem_free");
         run_concurrent_test(test_zero_alloc_and_free, (TestParams){.num_threads = base_num_threads, .memory_size = 1024}, "zero alloc and free");
+        run_concurrent_test(test_aligned_alloc_and_free, (TestParams){.num_threads = base_num_threads, .memory_size = 4096}, "mem_alloc_aligned and mem_free");
 
         test_resize_multithread((TestParams){.num_threads = base_num_threads});
+        test_resize_in_place();
+        test_first_fit_index();
+        test_resize_large_copy();
+        test_prefault();
+        test_checkpoint_restore();
+        test_tagged_allocations((TestParams){.num_threads = base_num_threads});
+        test_size_histogram((TestParams){.num_threads = base_num_threads});
+        test_page_map();
+        test_page_bitmap((TestParams){.num_threads = base_num_threads});
 
         test_exceed_single_allocation_multithread((TestParams){.num_threads = base_num_threads});
         test_exceed_cumulative_allocation_multithread((TestParams){.num_threads = base_num_threads, .memory_size = 1024}); // TODO: Fix this to be able to run with various configurations
@@ -936,6 +1990,12 @@ int main(int argc, char *argv[])
 
         test_memory_fragmentation_multithread((TestParams){.num_threads = base_num_threads, .memory_size = 2048});
         test_random_blocks_multithread((TestParams){.num_threads = base_num_threads, .block_size = 1024});
+        test_random_blocks_scheduled((TestParams){.num_threads = base_num_threads, .block_size = 1024});
+        test_mem_stats((TestParams){.num_threads = base_num_threads});
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_range_striping((TestParams){.num_threads = pow(2, i)});
+        for (int i = 0; i < 7; i++) // from 2^0 = 1 up to 2^6 = 64 threads
+            test_paged_mode((TestParams){.num_threads = pow(2, i)});
 
         break;
 
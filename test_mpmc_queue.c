@@ -0,0 +1,271 @@
+#include "mpmc_queue.h"
+#include "linked_list.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/time.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    MpmcQueue *queue;         // Queue shared by all threads (NULL for the list-as-queue baseline)
+    Node **head;              // Head of the list used as a queue by the baseline
+    int thread_id;            // Unique ID for each thread
+    int num_items;            // Number of items each producer pushes
+    atomic_int *claimed;      // Items claimed by consumers so far
+    int total_items;          // Total number of items pushed by all producers
+    atomic_llong *sum;        // Sum of all consumed items
+    int blocking;             // Use blocking push/pop instead of try_push/try_pop
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads; // Number of producers, and the same number of consumers
+    int num_items;   // Total number of items
+    int blocking;
+} TestParams;
+
+// ********* Test basic queue operations *********
+
+void test_mpmc_basic()
+{
+    printf_yellow("  Testing mpmc try_push/try_pop ---> ");
+    mem_init(4096);
+
+    MpmcQueue *queue = mpmc_create(3, sizeof(uint32_t));
+    my_assert(queue != NULL);
+    my_assert(mpmc_capacity(queue) == 4);
+
+    uint32_t value;
+    my_assert(mpmc_try_pop(queue, &value) == -1);
+    for (uint32_t i = 0; i < 4; i++)
+        my_assert(mpmc_try_push(queue, &i) == 0);
+    my_assert(mpmc_try_push(queue, &value) == -1);
+
+    // FIFO order, and slots are reused after a full lap
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        my_assert(mpmc_try_pop(queue, &value) == 0 && value == i);
+        uint32_t next = i + 4;
+        my_assert(mpmc_try_push(queue, &next) == 0);
+    }
+    for (uint32_t i = 4; i < 8; i++)
+        my_assert(mpmc_try_pop(queue, &value) == 0 && value == i);
+    my_assert(mpmc_try_pop(queue, &value) == -1);
+
+    mpmc_destroy(queue);
+
+    // Capacities whose rounding or slot array size would overflow are rejected
+    my_assert(mpmc_create(SIZE_MAX, 1) == NULL);
+    my_assert(mpmc_create(SIZE_MAX / 2 + 2, 1) == NULL);
+    my_assert(mpmc_create(SIZE_MAX / 16, 8) == NULL);
+    my_assert(mpmc_create(4, SIZE_MAX - 4) == NULL);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Producers and consumers *********
+
+// Pops the head of the list under list_mutex, the way the list is used as a queue today
+int list_queue_pop(Node **head, uint16_t *data)
+{
+    pthread_mutex_lock(&list_mutex);
+    Node *node = *head;
+    if (node)
+        *head = node->next;
+    pthread_mutex_unlock(&list_mutex);
+
+    if (!node)
+        return -1;
+    *data = node->data;
+    free(node);
+    return 0;
+}
+
+void *producer_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    for (int i = 0; i < data->num_items; i++)
+    {
+        uint32_t value = (uint16_t)(data->thread_id * data->num_items + i);
+        if (!data->queue)
+            list_insert(data->head, value);
+        else if (data->blocking)
+            mpmc_push(data->queue, &value);
+        else
+            while (mpmc_try_push(data->queue, &value) != 0)
+                sched_yield();
+    }
+    return NULL;
+}
+
+void *consumer_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    long long sum = 0;
+
+    // Each claim guarantees that one more item will eventually arrive
+    while (atomic_fetch_add(data->claimed, 1) < data->total_items)
+    {
+        uint32_t value;
+        if (!data->queue)
+        {
+            uint16_t node_value;
+            while (list_queue_pop(data->head, &node_value) != 0)
+                sched_yield();
+            value = node_value;
+        }
+        else if (data->blocking)
+            mpmc_pop(data->queue, &value);
+        else
+            while (mpmc_try_pop(data->queue, &value) != 0)
+                sched_yield();
+        sum += value;
+    }
+    atomic_fetch_add(data->sum, sum);
+    return NULL;
+}
+
+// Runs num_threads producers and num_threads consumers, either on the MPMC queue or on the list
+long run_queue_test(TestParams *params, int use_list)
+{
+    pthread_t producers[params->num_threads];
+    pthread_t consumers[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+    atomic_int claimed = 0;
+    atomic_llong sum = 0;
+    int items_per_thread = params->num_items / params->num_threads;
+    int total_items = items_per_thread * params->num_threads;
+
+    Node *head = NULL;
+    MpmcQueue *queue = NULL;
+    if (use_list)
+        list_init(&head, sizeof(Node) * total_items);
+    else
+    {
+        queue = mpmc_create(1024, sizeof(uint32_t));
+        my_assert(queue != NULL);
+    }
+
+    struct timeval start_time, end_time;
+    gettimeofday(&start_time, NULL);
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i] = (thread_data_t){.queue = queue, .head = &head, .thread_id = i, .num_items = items_per_thread,
+                                         .claimed = &claimed, .total_items = total_items, .sum = &sum, .blocking = params->blocking};
+        if (pthread_create(&consumers[i], NULL, consumer_function, &thread_data[i]) ||
+            pthread_create(&producers[i], NULL, producer_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+
+    gettimeofday(&end_time, NULL);
+
+    // Every pushed value must have been consumed exactly once
+    long long expected = 0;
+    for (int i = 0; i < total_items; i++)
+        expected += (uint16_t)i;
+    my_assert(atomic_load(&sum) == expected);
+
+    if (use_list)
+    {
+        my_assert(list_count_nodes(&head) == 0);
+        list_cleanup(&head);
+    }
+    else
+        mpmc_destroy(queue);
+
+    long seconds = end_time.tv_sec - start_time.tv_sec;
+    return ((seconds * 1000000) + end_time.tv_usec) - (start_time.tv_usec);
+}
+
+void test_mpmc_multithread(TestParams *params)
+{
+    printf_yellow("  Testing mpmc %s (producers: %d, consumers: %d, items: %d) ---> ", params->blocking ? "push/pop" : "try_push/try_pop", params->num_threads, params->num_threads, params->num_items);
+    mem_init(1024 * 1024);
+    run_queue_test(params, 0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// Compares the MPMC queue with the list-as-queue pattern (list_insert + locked head removal)
+void benchmark_mpmc_vs_list(TestParams *params)
+{
+    printf_yellow("  Benchmark (producers: %d, consumers: %d, items: %d) ---> ", params->num_threads, params->num_threads, params->num_items);
+    mem_init(1024 * 1024);
+    long queue_time = run_queue_test(params, 0);
+    long list_time = run_queue_test(params, 1);
+    mem_deinit();
+    printf_yellow("mpmc: %ld microseconds, list: %ld microseconds.\t", queue_time, list_time);
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_mpmc_basic - Test try_push/try_pop and FIFO order\n");
+        printf(" 2. test_mpmc_multithread - Test non-blocking producers and consumers\n");
+        printf(" 3. test_mpmc_multithread - Test blocking producers and consumers\n");
+        printf(" 4. benchmark_mpmc_vs_list - Compare with the list used as a queue, 1 to 256 threads\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        test_mpmc_basic();
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+        {
+            test_mpmc_multithread(&(TestParams){.num_threads = pow(2, i), .num_items = 65536});
+            test_mpmc_multithread(&(TestParams){.num_threads = pow(2, i), .num_items = 65536, .blocking = 1});
+        }
+        break;
+    case 1:
+        test_mpmc_basic();
+        break;
+    case 2:
+        test_mpmc_multithread(&(TestParams){.num_threads = base_num_threads, .num_items = 65536});
+        break;
+    case 3:
+        test_mpmc_multithread(&(TestParams){.num_threads = base_num_threads, .num_items = 65536, .blocking = 1});
+        break;
+    case 4:
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            benchmark_mpmc_vs_list(&(TestParams){.num_threads = pow(2, i), .num_items = 16384, .blocking = 1});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
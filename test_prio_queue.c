@@ -0,0 +1,250 @@
+#include "prio_queue.h"
+#include "linked_list.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/time.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    PrioQueue *queue;   // Queue shared by all threads
+    int thread_id;      // Unique ID for each thread
+    int num_items;      // Number of items each thread inserts
+    atomic_llong *sum;  // Sum of all values removed by delete-min
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_items; // Total number of items
+} TestParams;
+
+// ********* Test basic priority queue operations *********
+
+// With a single heap the queue is a strict priority queue
+void test_prio_strict_order()
+{
+    printf_yellow("  Testing prio_queue strict order with one heap ---> ");
+    mem_init(64 * 1024);
+
+    PrioQueue *queue = prio_create(1, 0);
+    my_assert(queue != NULL);
+
+    uint16_t priority;
+    uint32_t value;
+    my_assert(prio_delete_min(queue, &priority, &value) == -1);
+
+    // More items than the initial capacity, so the heap must grow through mem_resize
+    for (int i = 0; i < 1000; i++)
+    {
+        uint16_t p = (uint16_t)((i * 7919) % 1000);
+        my_assert(prio_insert(queue, p, p + 100000) == 0);
+    }
+    my_assert(prio_size(queue) == 1000);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        my_assert(prio_delete_min(queue, &priority, &value) == 0);
+        my_assert(priority == i);
+        my_assert(value == (uint32_t)i + 100000);
+    }
+    my_assert(prio_size(queue) == 0);
+    my_assert(prio_delete_min(queue, &priority, &value) == -1);
+
+    prio_destroy(queue);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// With several heaps the order is relaxed, but every item must come out exactly once
+void test_prio_relaxed()
+{
+    printf_yellow("  Testing prio_queue relaxed order with 8 heaps ---> ");
+    mem_init(256 * 1024);
+
+    PrioQueue *queue = prio_create(8, 1024);
+    my_assert(queue != NULL);
+
+    int seen[4096] = {0};
+    for (int i = 0; i < 4096; i++)
+        my_assert(prio_insert(queue, (uint16_t)(4095 - i), i) == 0);
+
+    uint16_t priority;
+    uint32_t value;
+    long long rank_error = 0;
+    for (int i = 0; i < 4096; i++)
+    {
+        my_assert(prio_delete_min(queue, &priority, &value) == 0);
+        my_assert(priority == 4095 - value);
+        my_assert(seen[value]++ == 0);
+        rank_error += priority > i ? priority - i : i - priority;
+    }
+    my_assert(prio_delete_min(queue, &priority, &value) == -1);
+    // The two-choice rule keeps the removed items close to the true minimum
+    my_assert(rank_error / 4096 < 256);
+
+    prio_destroy(queue);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Concurrent inserts and deletes *********
+
+void *thread_prio_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    long long sum = 0;
+
+    for (int i = 0; i < data->num_items; i++)
+    {
+        uint32_t value = data->thread_id * data->num_items + i;
+        my_assert(prio_insert(data->queue, (uint16_t)rand(), value) == 0);
+    }
+    for (int i = 0; i < data->num_items; i++)
+    {
+        uint32_t value;
+        // Other threads may still be inserting, so an empty result is retried
+        while (prio_delete_min(data->queue, NULL, &value) != 0)
+            ;
+        sum += value;
+    }
+    atomic_fetch_add(data->sum, sum);
+    return NULL;
+}
+
+void test_prio_multithread(TestParams *params)
+{
+    printf_yellow("  Testing prio_queue insert/delete_min (threads: %d, items: %d) ---> ", params->num_threads, params->num_items);
+    mem_init(4 * 1024 * 1024);
+
+    PrioQueue *queue = prio_create(2 * params->num_threads, params->num_items);
+    my_assert(queue != NULL);
+
+    pthread_t threads[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+    atomic_llong sum = 0;
+    int items_per_thread = params->num_items / params->num_threads;
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i] = (thread_data_t){.queue = queue, .thread_id = i, .num_items = items_per_thread, .sum = &sum};
+        if (pthread_create(&threads[i], NULL, thread_prio_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    long long total = (long long)items_per_thread * params->num_threads;
+    my_assert(atomic_load(&sum) == total * (total - 1) / 2);
+    my_assert(prio_size(queue) == 0);
+
+    prio_destroy(queue);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// Compares against an ordered list maintained with list_insert_before, the way it is used as a scheduler queue today
+void benchmark_prio_vs_list(TestParams *params)
+{
+    printf_yellow("  Benchmark single-threaded scheduling (items: %d) ---> ", params->num_items);
+    mem_init(4 * 1024 * 1024);
+    struct timeval start_time, end_time;
+
+    gettimeofday(&start_time, NULL);
+    PrioQueue *queue = prio_create(1, params->num_items);
+    for (int i = 0; i < params->num_items; i++)
+        prio_insert(queue, (uint16_t)rand(), i);
+    for (int i = 0; i < params->num_items; i++)
+        prio_delete_min(queue, NULL, NULL);
+    prio_destroy(queue);
+    gettimeofday(&end_time, NULL);
+    long queue_time = (end_time.tv_sec - start_time.tv_sec) * 1000000 + end_time.tv_usec - start_time.tv_usec;
+
+    gettimeofday(&start_time, NULL);
+    Node *head = NULL;
+    list_init(&head, sizeof(Node) * params->num_items);
+    for (int i = 0; i < params->num_items; i++)
+    {
+        uint16_t priority = (uint16_t)rand();
+        Node *next = head;
+        while (next && next->data <= priority)
+            next = next->next;
+        if (next)
+            list_insert_before(&head, next, priority);
+        else
+            list_insert(&head, priority);
+    }
+    for (int i = 0; i < params->num_items; i++)
+        list_delete(&head, head->data);
+    gettimeofday(&end_time, NULL);
+    long list_time = (end_time.tv_sec - start_time.tv_sec) * 1000000 + end_time.tv_usec - start_time.tv_usec;
+
+    mem_deinit();
+    printf_yellow("prio_queue: %ld microseconds, list: %ld microseconds.\t", queue_time, list_time);
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_prio_strict_order - Test strict ordering with a single heap\n");
+        printf(" 2. test_prio_relaxed - Test relaxed ordering with several heaps\n");
+        printf(" 3. test_prio_multithread - Test concurrent insert and delete_min\n");
+        printf(" 4. benchmark_prio_vs_list - Compare with an ordered list\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        test_prio_strict_order();
+        test_prio_relaxed();
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_prio_multithread(&(TestParams){.num_threads = pow(2, i), .num_items = 65536});
+        break;
+    case 1:
+        test_prio_strict_order();
+        break;
+    case 2:
+        test_prio_relaxed();
+        break;
+    case 3:
+        test_prio_multithread(&(TestParams){.num_threads = base_num_threads, .num_items = 65536});
+        break;
+    case 4:
+        for (int j = 8; j < 15; j += 2) // from 2^8 = 256 up to 2^14 = 16384 items
+            benchmark_prio_vs_list(&(TestParams){.num_items = pow(2, j)});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
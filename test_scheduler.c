@@ -0,0 +1,298 @@
+#include "scheduler.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    int thread_id;  // Unique ID for each thread
+    size_t begin;   // First index handled by the thread
+    size_t end;     // One past the last index
+    uint64_t *data; // Shared input array
+    uint64_t sum;   // Partial result
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_tasks;
+} TestParams;
+
+// ********* Test task groups *********
+
+void increment_task(void *arg)
+{
+    atomic_fetch_add((atomic_int *)arg, 1);
+}
+
+void test_task_group(TestParams *params)
+{
+    printf_yellow("  Testing task groups (workers: %d, tasks: %d) ---> ", params->num_threads, params->num_tasks);
+    Scheduler *scheduler = sched_create(params->num_threads);
+    my_assert(scheduler != NULL);
+    my_assert(sched_num_workers(scheduler) == (size_t)params->num_threads);
+
+    // Spawned from outside the runtime, so every task goes through the inject queue
+    atomic_int counter = 0;
+    TaskGroup group;
+    task_group_init(&group, scheduler);
+    for (int i = 0; i < params->num_tasks; i++)
+        my_assert(task_group_spawn(&group, increment_task, &counter) == 0);
+    task_group_wait(&group);
+    my_assert(counter == params->num_tasks);
+
+    // A group can be reused after waiting
+    for (int i = 0; i < params->num_tasks; i++)
+        my_assert(task_group_spawn(&group, increment_task, &counter) == 0);
+    task_group_wait(&group);
+    my_assert(counter == params->num_tasks * 2);
+
+    sched_destroy(scheduler);
+    printf_green("[PASS].\n");
+}
+
+typedef struct
+{
+    Scheduler *scheduler;
+    int n;
+    long result;
+} fib_arg_t;
+
+// Naive recursive Fibonacci with a nested task group per level
+void fib_task(void *arg)
+{
+    fib_arg_t *fib = (fib_arg_t *)arg;
+    if (fib->n < 2)
+    {
+        fib->result = fib->n;
+        return;
+    }
+    fib_arg_t left = {.scheduler = fib->scheduler, .n = fib->n - 1};
+    fib_arg_t right = {.scheduler = fib->scheduler, .n = fib->n - 2};
+    TaskGroup group;
+    task_group_init(&group, fib->scheduler);
+    task_group_spawn(&group, fib_task, &left);
+    fib_task(&right);
+    task_group_wait(&group);
+    fib->result = left.result + right.result;
+}
+
+void test_nested_groups(TestParams *params)
+{
+    printf_yellow("  Testing nested task groups (workers: %d) ---> ", params->num_threads);
+    Scheduler *scheduler = sched_create(params->num_threads);
+
+    fib_arg_t fib = {.scheduler = scheduler, .n = 20};
+    TaskGroup group;
+    task_group_init(&group, scheduler);
+    task_group_spawn(&group, fib_task, &fib);
+    task_group_wait(&group);
+    my_assert(fib.result == 6765);
+
+    sched_destroy(scheduler);
+    printf_green("[PASS].\n");
+}
+
+// ********* Test parallel_for *********
+
+typedef struct
+{
+    uint64_t *data;
+    atomic_ullong sum;
+    atomic_int calls;
+} sum_ctx_t;
+
+void sum_range(size_t begin, size_t end, void *ctx)
+{
+    sum_ctx_t *sum = (sum_ctx_t *)ctx;
+    uint64_t local = 0;
+    for (size_t i = begin; i < end; i++)
+        local += sum->data[i];
+    atomic_fetch_add(&sum->sum, local);
+    atomic_fetch_add(&sum->calls, 1);
+}
+
+void test_parallel_for(TestParams *params)
+{
+    printf_yellow("  Testing parallel_for (workers: %d, elements: %d) ---> ", params->num_threads, params->num_tasks);
+    Scheduler *scheduler = sched_create(params->num_threads);
+
+    uint64_t *data = malloc(params->num_tasks * sizeof(uint64_t));
+    uint64_t expected = 0;
+    for (int i = 0; i < params->num_tasks; i++)
+    {
+        data[i] = rand();
+        expected += data[i];
+    }
+
+    // Explicit grain: the range is split into pieces of at most 64 elements
+    sum_ctx_t ctx = {.data = data};
+    parallel_for(scheduler, 0, params->num_tasks, 64, sum_range, &ctx);
+    my_assert(ctx.sum == expected);
+    my_assert(ctx.calls >= (params->num_tasks + 63) / 64);
+
+    // Automatic grain and an empty range
+    ctx.sum = 0;
+    parallel_for(scheduler, 0, params->num_tasks, 0, sum_range, &ctx);
+    my_assert(ctx.sum == expected);
+    ctx.calls = 0;
+    parallel_for(scheduler, 5, 5, 1, sum_range, &ctx);
+    my_assert(ctx.calls == 0);
+
+    free(data);
+    sched_destroy(scheduler);
+    printf_green("[PASS].\n");
+}
+
+// Allocator operations from the pool spread over the workers
+void alloc_range(size_t begin, size_t end, void *ctx)
+{
+    (void)ctx;
+    for (size_t i = begin; i < end; i++)
+    {
+        char *block = mem_alloc(32);
+        my_assert(block != NULL);
+        memset(block, (int)(i & 0xff), 32);
+        for (int j = 0; j < 32; j++)
+            my_assert(block[j] == (char)(i & 0xff));
+        mem_free(block);
+    }
+}
+
+void test_parallel_for_pool(TestParams *params)
+{
+    printf_yellow("  Testing parallel_for on the memory pool (workers: %d, allocations: %d) ---> ", params->num_threads, params->num_tasks);
+    Scheduler *scheduler = sched_create(params->num_threads);
+    mem_init(1024 * 1024);
+
+    parallel_for(scheduler, 0, params->num_tasks, 16, alloc_range, NULL);
+
+    mem_deinit();
+    sched_destroy(scheduler);
+    printf_green("[PASS].\n");
+}
+
+// ********* Compare against one pthread_create per chunk *********
+
+void *thread_sum_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    data->sum = 0;
+    for (size_t i = data->begin; i < data->end; i++)
+        data->sum += data->data[i];
+    return NULL;
+}
+
+void test_scheduler_performance(TestParams *params)
+{
+    printf_yellow("  Testing parallel_for vs pthread_create per chunk (threads: %d, rounds: %d) ---> ", params->num_threads, params->num_tasks);
+    size_t elements = 1 << 16;
+    uint64_t *data = malloc(elements * sizeof(uint64_t));
+    for (size_t i = 0; i < elements; i++)
+        data[i] = i;
+
+    struct timespec start, end;
+    uint64_t thread_total = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int round = 0; round < params->num_tasks; round++)
+    {
+        pthread_t threads[params->num_threads];
+        thread_data_t thread_data[params->num_threads];
+        for (int i = 0; i < params->num_threads; i++)
+        {
+            thread_data[i] = (thread_data_t){.thread_id = i, .begin = elements * i / params->num_threads, .end = elements * (i + 1) / params->num_threads, .data = data};
+            if (pthread_create(&threads[i], NULL, thread_sum_function, &thread_data[i]))
+            {
+                perror("Failed to create thread");
+            }
+        }
+        for (int i = 0; i < params->num_threads; i++)
+        {
+            pthread_join(threads[i], NULL);
+            thread_total += thread_data[i].sum;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double thread_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    Scheduler *scheduler = sched_create(params->num_threads);
+    sum_ctx_t ctx = {.data = data};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int round = 0; round < params->num_tasks; round++)
+        parallel_for(scheduler, 0, elements, 0, sum_range, &ctx);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double sched_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    my_assert(ctx.sum == thread_total);
+    printf("pthread_create: %f s, parallel_for: %f s ---> ", thread_time, sched_time);
+
+    sched_destroy(scheduler);
+    free(data);
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_task_group - Test spawning and waiting on task groups\n");
+        printf(" 2. test_nested_groups - Test task groups spawned from inside tasks\n");
+        printf(" 3. test_parallel_for - Test parallel_for with explicit and automatic grain\n");
+        printf(" 4. test_parallel_for_pool - Test allocator operations spread by parallel_for\n");
+        printf(" 5. test_scheduler_performance - Compare against one pthread_create per chunk\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 workers
+        {
+            test_task_group(&(TestParams){.num_threads = pow(2, i), .num_tasks = 10000});
+            test_nested_groups(&(TestParams){.num_threads = pow(2, i)});
+            test_parallel_for(&(TestParams){.num_threads = pow(2, i), .num_tasks = 100000});
+            test_parallel_for_pool(&(TestParams){.num_threads = pow(2, i), .num_tasks = 10000});
+        }
+        break;
+    case 1:
+        test_task_group(&(TestParams){.num_threads = base_num_threads, .num_tasks = 10000});
+        break;
+    case 2:
+        test_nested_groups(&(TestParams){.num_threads = base_num_threads});
+        break;
+    case 3:
+        test_parallel_for(&(TestParams){.num_threads = base_num_threads, .num_tasks = 100000});
+        break;
+    case 4:
+        test_parallel_for_pool(&(TestParams){.num_threads = base_num_threads, .num_tasks = 10000});
+        break;
+    case 5:
+        test_scheduler_performance(&(TestParams){.num_threads = base_num_threads, .num_tasks = 100});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
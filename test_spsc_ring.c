@@ -0,0 +1,233 @@
+#include "spsc_ring.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    SpscRing *ring;   // Ring shared by one producer and one consumer
+    int num_items;    // Number of items to pass through the ring
+    int batch_size;   // Number of items per push/pop call
+    int zero_copy;    // Use reserve/commit and peek/release instead of push/pop
+} thread_data_t;
+
+typedef struct
+{
+    int num_pairs; // Number of producer/consumer pairs, each with its own ring
+    int num_items;
+    int batch_size;
+    int zero_copy;
+} TestParams;
+
+// ********* Test basic ring operations *********
+
+void test_spsc_basic()
+{
+    printf_yellow("  Testing spsc push/pop and wrap-around ---> ");
+    mem_init(4096);
+
+    SpscRing *ring = spsc_create(5, sizeof(uint32_t));
+    my_assert(ring != NULL);
+    my_assert(spsc_capacity(ring) == 8);
+    my_assert(((uintptr_t)ring & 63) == 0);
+
+    uint32_t in[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint32_t out[8];
+
+    my_assert(spsc_pop(ring, out, 8) == 0);
+    my_assert(spsc_push(ring, in, 6) == 6);
+    my_assert(spsc_pop(ring, out, 4) == 4);
+    my_assert(out[0] == 1 && out[3] == 4);
+
+    // Only 6 free slots remain, and the copy wraps around the end of the buffer
+    my_assert(spsc_push(ring, in, 8) == 6);
+    my_assert(spsc_size(ring) == 8);
+    my_assert(spsc_push(ring, in, 1) == 0);
+
+    my_assert(spsc_pop(ring, out, 8) == 8);
+    my_assert(out[0] == 5 && out[1] == 6 && out[2] == 1 && out[7] == 6);
+    my_assert(spsc_size(ring) == 0);
+
+    // Reservation stops at the end of the buffer, so the slice is always contiguous
+    size_t granted;
+    uint32_t *slot = spsc_reserve(ring, 8, &granted);
+    my_assert(slot != NULL && granted == 4);
+    slot[0] = 42;
+    spsc_commit(ring, 1);
+
+    size_t available;
+    const uint32_t *view = spsc_peek(ring, 8, &available);
+    my_assert(view != NULL && available == 1 && view[0] == 42);
+    spsc_release(ring, 1);
+    my_assert(spsc_size(ring) == 0);
+
+    spsc_destroy(ring);
+
+    // Capacities whose rounding or byte size would overflow are rejected
+    my_assert(spsc_create(SIZE_MAX, 1) == NULL);
+    my_assert(spsc_create(SIZE_MAX / 2 + 2, 1) == NULL);
+    my_assert(spsc_create(SIZE_MAX / 8, 16) == NULL);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Producer/consumer pipelines *********
+
+void *producer_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    uint32_t batch[data->batch_size];
+    int next = 0;
+
+    while (next < data->num_items)
+    {
+        if (data->zero_copy)
+        {
+            size_t granted;
+            uint32_t *slot = spsc_reserve(data->ring, data->batch_size, &granted);
+            size_t filled = 0;
+            for (; filled < granted && next < data->num_items; filled++)
+                slot[filled] = next++;
+            if (filled)
+                spsc_commit(data->ring, filled);
+            else
+                sched_yield();
+            continue;
+        }
+
+        int count = data->num_items - next < data->batch_size ? data->num_items - next : data->batch_size;
+        for (int i = 0; i < count; i++)
+            batch[i] = next + i;
+        size_t pushed = 0;
+        while (pushed < (size_t)count)
+        {
+            size_t n = spsc_push(data->ring, batch + pushed, count - pushed);
+            if (n == 0)
+                sched_yield();
+            pushed += n;
+        }
+        next += count;
+    }
+    return NULL;
+}
+
+void *consumer_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    uint32_t batch[data->batch_size];
+    int expected = 0;
+
+    while (expected < data->num_items)
+    {
+        if (data->zero_copy)
+        {
+            size_t available;
+            const uint32_t *view = spsc_peek(data->ring, data->batch_size, &available);
+            for (size_t i = 0; i < available; i++)
+                my_assert(view[i] == (uint32_t)expected++);
+            if (available)
+                spsc_release(data->ring, available);
+            else
+                sched_yield();
+            continue;
+        }
+
+        size_t n = spsc_pop(data->ring, batch, data->batch_size);
+        if (n == 0)
+            sched_yield();
+        for (size_t i = 0; i < n; i++)
+            my_assert(batch[i] == (uint32_t)expected++); // Items must arrive in FIFO order
+    }
+    return NULL;
+}
+
+void test_spsc_pipeline(TestParams *params)
+{
+    printf_yellow("  Testing spsc pipeline (pairs: %d, items: %d, batch: %d%s) ---> ", params->num_pairs, params->num_items, params->batch_size, params->zero_copy ? ", zero-copy" : "");
+    mem_init(params->num_pairs * 8192);
+
+    pthread_t producers[params->num_pairs];
+    pthread_t consumers[params->num_pairs];
+    thread_data_t thread_data[params->num_pairs];
+
+    for (int i = 0; i < params->num_pairs; i++)
+    {
+        thread_data[i].ring = spsc_create(1024, sizeof(uint32_t));
+        my_assert(thread_data[i].ring != NULL);
+        thread_data[i].num_items = params->num_items;
+        thread_data[i].batch_size = params->batch_size;
+        thread_data[i].zero_copy = params->zero_copy;
+        if (pthread_create(&consumers[i], NULL, consumer_function, &thread_data[i]) ||
+            pthread_create(&producers[i], NULL, producer_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_pairs; i++)
+    {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+        my_assert(spsc_size(thread_data[i].ring) == 0);
+        spsc_destroy(thread_data[i].ring);
+    }
+
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_spsc_basic - Test push, pop, wrap-around and reservations\n");
+        printf(" 2. test_spsc_pipeline - Test a producer/consumer pair with batched push/pop\n");
+        printf(" 3. test_spsc_pipeline - Test a producer/consumer pair with zero-copy reservations\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        test_spsc_basic();
+        for (int i = 0; i < 6; i++)     // from 2^0 = 1 up to 2^5 = 32 pairs
+            for (int j = 0; j < 7; j += 3) // batches of 1, 8 and 64 items
+            {
+                test_spsc_pipeline(&(TestParams){.num_pairs = pow(2, i), .num_items = 100000, .batch_size = pow(2, j)});
+                test_spsc_pipeline(&(TestParams){.num_pairs = pow(2, i), .num_items = 100000, .batch_size = pow(2, j), .zero_copy = 1});
+            }
+        break;
+    case 1:
+        test_spsc_basic();
+        break;
+    case 2:
+        test_spsc_pipeline(&(TestParams){.num_pairs = 1, .num_items = 1000000, .batch_size = 32});
+        break;
+    case 3:
+        test_spsc_pipeline(&(TestParams){.num_pairs = 1, .num_items = 1000000, .batch_size = 32, .zero_copy = 1});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include "vec.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include "common_defs.h"
+#include "gitdata.h"
+
+typedef struct
+{
+    int thread_id;    // Unique ID for each thread
+    int num_elements; // Number of elements each thread pushes to its own vector
+} thread_data_t;
+
+typedef struct
+{
+    int num_threads;
+    int num_elements;
+    size_t memory_size;
+} TestParams;
+
+// ********* Test basic vector operations *********
+
+void test_vec_basic()
+{
+    printf_yellow("  Testing vec push/pop/at ---> ");
+    mem_init(4096);
+
+    Vec vec;
+    my_assert(vec_init(&vec, sizeof(uint16_t), 0) == 0);
+    my_assert(vec.data == NULL && vec.len == 0);
+
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        my_assert(vec_push(&vec, &i) == 0);
+    }
+    my_assert(vec.len == 100);
+    my_assert(vec.capacity >= 100);
+
+    for (size_t i = 0; i < vec.len; i++)
+    {
+        my_assert(*(uint16_t *)vec_at(&vec, i) == i);
+        my_assert(VEC_AT(&vec, uint16_t, i) == i);
+    }
+    my_assert(vec_at(&vec, 100) == NULL);
+
+    uint16_t out;
+    my_assert(vec_pop(&vec, &out) == 0 && out == 99);
+    my_assert(vec.len == 99);
+
+    // Capacities whose doubling or byte size would overflow are rejected and leave the vector as it was
+    size_t capacity = vec.capacity;
+    my_assert(vec_reserve(&vec, SIZE_MAX) == -1);
+    my_assert(vec_reserve(&vec, SIZE_MAX / 2 + 2) == -1);
+    my_assert(vec.capacity == capacity && vec.len == 99 && VEC_AT(&vec, uint16_t, 98) == 98);
+
+    vec_clear(&vec);
+    my_assert(vec.len == 0);
+    my_assert(vec_pop(&vec, &out) == -1);
+
+    vec_destroy(&vec);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// With nothing allocated after the vector, growth must extend the block in place
+void test_vec_grow_in_place()
+{
+    printf_yellow("  Testing vec growth in place ---> ");
+    mem_init(1024 * 1024);
+
+    Vec vec;
+    my_assert(vec_init(&vec, sizeof(uint32_t), 16) == 0);
+    void *initial = vec.data;
+
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        my_assert(VEC_PUSH(&vec, uint32_t, i) == 0);
+    }
+    my_assert(vec.data == initial);
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        my_assert(VEC_AT(&vec, uint32_t, i) == i);
+    }
+
+    vec_destroy(&vec);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// A block allocated right after the vector forces growth to relocate the data
+void test_vec_grow_relocate()
+{
+    printf_yellow("  Testing vec growth with relocation ---> ");
+    mem_init(1024 * 1024);
+
+    Vec vec;
+    my_assert(vec_init(&vec, sizeof(uint32_t), 16) == 0);
+    void *blocker = mem_alloc(64);
+    my_assert(blocker != NULL);
+    void *initial = vec.data;
+
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        my_assert(VEC_PUSH(&vec, uint32_t, i) == 0);
+    }
+    my_assert(vec.data != initial);
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        my_assert(VEC_AT(&vec, uint32_t, i) == i);
+    }
+
+    mem_free(blocker);
+    vec_destroy(&vec);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void *thread_vec_function(void *arg)
+{
+    thread_data_t *data = (thread_data_t *)arg;
+    Vec vec;
+    my_assert(vec_init(&vec, sizeof(uint32_t), 0) == 0);
+
+    uint32_t base = (uint32_t)data->thread_id << 20;
+    for (int i = 0; i < data->num_elements; i++)
+    {
+        my_assert(VEC_PUSH(&vec, uint32_t, base + i) == 0);
+    }
+    for (int i = 0; i < data->num_elements; i++)
+    {
+        my_assert(VEC_AT(&vec, uint32_t, i) == base + i);
+    }
+
+    vec_destroy(&vec);
+    return NULL;
+}
+
+void test_vec_multithread(TestParams *params)
+{
+    printf_yellow("  Testing vec per-thread vectors (threads: %d, elements: %d) ---> ", params->num_threads, params->num_elements);
+    mem_init(params->memory_size);
+
+    pthread_t threads[params->num_threads];
+    thread_data_t thread_data[params->num_threads];
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        thread_data[i].thread_id = i;
+        thread_data[i].num_elements = params->num_elements / params->num_threads;
+        if (pthread_create(&threads[i], NULL, thread_vec_function, &thread_data[i]))
+        {
+            perror("Failed to create thread");
+        }
+    }
+
+    for (int i = 0; i < params->num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int base_num_threads = 4;
+
+    srand(time(NULL));
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+    if (argc < 2)
+    {
+        printf("Usage: %s <test function>\n", argv[0]);
+        printf("Available test functions:\n");
+        printf(" 1. test_vec_basic - Test push, pop and indexed access\n");
+        printf(" 2. test_vec_grow_in_place - Test growth into a free neighbouring block\n");
+        printf(" 3. test_vec_grow_relocate - Test growth when the block has to move\n");
+        printf(" 4. test_vec_multithread - Test per-thread vectors on a shared pool\n");
+        printf(" 0. Run all tests\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case -1:
+        printf("No tests will be executed.\n");
+        break;
+    case 0:
+        test_vec_basic();
+        test_vec_grow_in_place();
+        test_vec_grow_relocate();
+        for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+            test_vec_multithread(&(TestParams){.num_threads = pow(2, i), .num_elements = 65536, .memory_size = 4 * 1024 * 1024});
+        break;
+    case 1:
+        test_vec_basic();
+        break;
+    case 2:
+        test_vec_grow_in_place();
+        break;
+    case 3:
+        test_vec_grow_relocate();
+        break;
+    case 4:
+        test_vec_multithread(&(TestParams){.num_threads = base_num_threads, .num_elements = 65536, .memory_size = 4 * 1024 * 1024});
+        break;
+    default:
+        printf("Invalid test function\n");
+        break;
+    }
+
+    return 0;
+}
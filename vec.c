@@ -0,0 +1,88 @@
+#include "vec.h"
+#include "memory_manager.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+// Dynamisk array i minnespoolen
+// Elementen ligger sammanhängande, så append-och-sök går över cachevänligt minne istället för Node->next
+// Ingen intern låsning - en Vec ägs av en tråd åt gången
+
+#define VEC_MIN_CAPACITY 8
+
+// Initierar en tom vektor, allokerar bara om capacity > 0
+int vec_init(Vec* vec, size_t elem_size, size_t capacity) {
+    vec->data = NULL;
+    vec->len = 0;
+    vec->capacity = 0;
+    vec->elem_size = elem_size;
+    return capacity ? vec_reserve(vec, capacity) : 0;
+}
+
+// Ser till att minst capacity element ryms
+// Geometrisk tillväxt (dubblering) ger amorterat O(1) per push
+// mem_resize växer blocket på plats om grannblocket är ledigt, annars kopieras innehållet
+int vec_reserve(Vec* vec, size_t capacity) {
+    if (capacity <= vec->capacity) return 0;
+
+    size_t new_capacity = vec->capacity ? vec->capacity : VEC_MIN_CAPACITY;
+    while (new_capacity < capacity) {
+        // Dubbleringen får inte slå runt - nära gränsen tas exakt den begärda kapaciteten
+        if (new_capacity > SIZE_MAX / 2) {
+            new_capacity = capacity;
+            break;
+        }
+        new_capacity *= 2;
+    }
+    if (vec->elem_size && new_capacity > SIZE_MAX / vec->elem_size) {
+        fprintf(stderr, "Error: Vector capacity of %zu elements is too large\n", capacity);
+        return -1;
+    }
+
+    void* data = mem_resize(vec->data, new_capacity * vec->elem_size);
+    if (!data) {
+        fprintf(stderr, "Error: Could not grow vector to %zu elements\n", new_capacity);
+        return -1; // Gamla datat är orört vid fel
+    }
+
+    vec->data = data;
+    vec->capacity = new_capacity;
+    return 0;
+}
+
+// Lägger till ett element sist, returnerar 0 eller -1 om vektorn inte kunde växa
+int vec_push(Vec* vec, const void* elem) {
+    if (vec_reserve(vec, vec->len + 1) != 0) return -1;
+    memcpy((char*)vec->data + vec->len * vec->elem_size, elem, vec->elem_size);
+    vec->len++;
+    return 0;
+}
+
+// Tar bort sista elementet och kopierar det till elem (om inte NULL)
+// Returnerar 0 eller -1 om vektorn är tom
+int vec_pop(Vec* vec, void* elem) {
+    if (vec->len == 0) return -1;
+    vec->len--;
+    if (elem) memcpy(elem, (char*)vec->data + vec->len * vec->elem_size, vec->elem_size);
+    return 0;
+}
+
+// Returnerar pekare till elementet eller NULL om index ligger utanför
+// Pekaren är giltig tills vektorn växer nästa gång
+void* vec_at(Vec* vec, size_t index) {
+    if (index >= vec->len) return NULL;
+    return (char*)vec->data + index * vec->elem_size;
+}
+
+// Tömmer vektorn men behåller kapaciteten
+void vec_clear(Vec* vec) {
+    vec->len = 0;
+}
+
+// Lämnar tillbaka datat till minnespoolen
+void vec_destroy(Vec* vec) {
+    if (vec->data) mem_free(vec->data);
+    vec->data = NULL;
+    vec->len = 0;
+    vec->capacity = 0;
+}
@@ -0,0 +1,32 @@
+#ifndef VEC_H
+#define VEC_H
+
+#include <stddef.h>
+
+typedef struct Vec {
+    void* data;       // Sammanhängande element i minnespoolen
+    size_t len;       // Antal element
+    size_t capacity;  // Antal element som ryms utan att växa
+    size_t elem_size; // Storlek på ett element i bytes
+} Vec;
+
+// Typade åtkomstmakron ovanpå den byte-baserade implementationen
+#define VEC_AT(vec, type, index) (((type*)(vec)->data)[index])
+#define VEC_PUSH(vec, type, value) \
+    (vec_reserve((vec), (vec)->len + 1) == 0 ? (((type*)(vec)->data)[(vec)->len++] = (value), 0) : -1)
+
+int vec_init(Vec* vec, size_t elem_size, size_t capacity);
+
+int vec_reserve(Vec* vec, size_t capacity);
+
+int vec_push(Vec* vec, const void* elem);
+
+int vec_pop(Vec* vec, void* elem);
+
+void* vec_at(Vec* vec, size_t index);
+
+void vec_clear(Vec* vec);
+
+void vec_destroy(Vec* vec);
+
+#endif